@@ -0,0 +1,394 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "core/FilterBank.h"
+#include "core/StateMachine.h"
+#include "data/DataLogger.h"
+#include "hw/impl/MockTemp.h"
+
+// Micro-benchmarks for the hardware-free control core. Every benchmark
+// reports allocs/op next to ns/op: the tick and logging paths are meant to
+// be allocation-free in steady state, and a regression there shows up here
+// before it shows up as jitter on the Pi.
+
+// ---------------------------------------------------------------------------
+// Allocation counter: every operator new in the process is counted
+// ---------------------------------------------------------------------------
+namespace {
+std::atomic<uint64_t> g_allocs{0};
+}
+
+void* operator new(std::size_t n) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Reports heap allocations made while in scope, averaged per iteration
+class AllocCounter {
+public:
+  explicit AllocCounter(benchmark::State& st)
+    : st_(st), start_(g_allocs.load(std::memory_order_relaxed)) {}
+  ~AllocCounter() {
+    const double n = static_cast<double>(g_allocs.load(std::memory_order_relaxed) - start_);
+    st_.counters["allocs/op"] = benchmark::Counter(n, benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State& st_;
+  uint64_t start_;
+};
+
+std::string benchDir() {
+  return (std::filesystem::temp_directory_path() / "oven_bench").string();
+}
+
+// A streaming DataLogger's writer drains its ring every kFlushInterval; a
+// timed loop that logs outruns it within microseconds and from then on
+// only times the ring-full drop. Such benchmarks run half a ring per
+// repetition and fail if a point was dropped.
+constexpr int64_t kRingIterations  = DataLogger::kRingCapacity / 2;
+constexpr int     kRingRepetitions = 20;
+
+void checkDropped(benchmark::State& st, uint64_t dropped) {
+  st.counters["dropped"] = static_cast<double>(dropped);
+  if (dropped != 0) st.SkipWithError("log ring overflowed: timed the drop path");
+}
+
+struct NullRelay : IRelay {
+  bool on{false};
+  void set(bool v) override { on = v; }
+  bool get() const override { return on; }
+};
+
+Params benchParams() {
+  Params P{};
+  P.air_target_c      = 200.0;
+  P.air_hysteresis_c  = 5.0;
+  P.part_target_c     = 180.0;
+  P.part_hysteresis_c = 3.0;
+  P.dwell_seconds     = 20 * 60;
+  P.part_min_valid_c  = 120.0;
+  P.ir_drop_delta_c   = 15.0;
+  return P;
+}
+
+// StateMachine on mock sensors and relays, with its own clock
+struct Rig {
+  MockTemp  air, part;
+  NullRelay f2, f, green, red, amber, buzzer, contactor;
+  StateMachine sm;
+  Clock::time_point now{};
+
+  Rig() : sm(benchParams(), air, part, f2, f, green, red, amber, buzzer, contactor) {}
+
+  void set(double air_c, double part_c) { air.inject(air_c); part.inject(part_c); }
+  void tick(std::chrono::milliseconds dt = std::chrono::milliseconds(50)) {
+    now += dt;
+    sm.tick(now);
+  }
+
+  // Put the machine in `s` with sensor values that keep it there. Returns
+  // false if the state is not reachable in that mode.
+  bool drive(State s, OperatingMode m) {
+    if (m == OperatingMode::Manual) {
+      switch (s) {
+        case State::Idle:     set(25, 25);   sm.command_enterIdle();     break;
+        case State::Warming:  set(25, 25);   sm.command_enterWarming();  break;
+        case State::Ready:    set(200, 150); sm.command_enterReady();    break;
+        case State::Curing:   set(200, 100); sm.command_enterCuring();   break;
+        case State::Shutdown: set(200, 150); sm.command_enterShutdown(); break;
+        case State::Fault:    set(200, 150); sm.command_enterFault();    break;
+        case State::AutoCureComplete: return false;
+      }
+      return sm.state() == s;
+    }
+
+    set(25, 25);
+    sm.command_startAutoMode(200.0);
+    if (s == State::Warming) return sm.state() == s;
+    if (s == State::Shutdown) { sm.command_stop(); return sm.state() == s; }
+    if (s == State::Fault) {
+      set(std::nan(""), 25);   // NaN reading -> Fault; stays until cleared
+      tick();
+      set(200, 150);
+      return sm.state() == s;
+    }
+
+    // Warming -> Ready, then a steady wall reading for the baseline
+    set(205, 150);
+    for (int i = 0; i < 100; ++i) tick();
+    if (s == State::Ready) return sm.state() == s;
+
+    // Cold part in view -> detected (confirmed over a few readings) ->
+    // Curing; part held below the cure profile
+    set(205, 20);
+    for (int i = 0; i < 5; ++i) tick();
+    set(205, 100);
+    if (s == State::Curing) return sm.state() == s;
+
+    // Part at target until cure equivalence is reached -> AutoCureComplete
+    set(205, 200);
+    for (int i = 0; i < 30 * 60 && sm.state() == State::Curing; ++i)
+      tick(std::chrono::seconds(1));
+    if (s == State::AutoCureComplete) return sm.state() == s;
+
+    // Acknowledge -> Idle (mode stays Auto)
+    sm.command_acknowledgeAutoCureComplete();
+    return s == State::Idle && sm.state() == s;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// StateMachine::tick() in every state, both modes
+// ---------------------------------------------------------------------------
+void BM_Tick(benchmark::State& st) {
+  const auto s = static_cast<State>(st.range(0));
+  const auto m = static_cast<OperatingMode>(st.range(1));
+
+  Rig rig;
+  if (!rig.drive(s, m)) {
+    st.SkipWithError("state not reachable in this mode");
+    return;
+  }
+  st.SetLabel(std::string(m == OperatingMode::Auto ? "auto/" : "manual/") + stateName(s));
+
+  {
+    AllocCounter allocs(st);
+    for (auto _ : st) {
+      rig.tick();
+      benchmark::DoNotOptimize(rig.sm.state());
+    }
+  }
+
+  if (rig.sm.state() != s) st.SkipWithError("left the state during the run");
+}
+
+void TickArgs(benchmark::internal::Benchmark* b) {
+  for (int m : {0, 1})
+    for (int s = 0; s <= static_cast<int>(State::AutoCureComplete); ++s)
+      if (m == 1 || static_cast<State>(s) != State::AutoCureComplete)  // auto-only state
+        b->Args({s, m});
+}
+BENCHMARK(BM_Tick)->Apply(TickArgs);
+
+// tick() fed from a SampleBus in auto Curing: a new frame every second tick
+// (10 Hz poll, 20 Hz tick), each one fused over the air zones and logged to
+// a streaming binary session
+void BM_TickWithFrames(benchmark::State& st) {
+  Rig rig;
+  SampleBus bus;
+  SampleFrame frame;
+  frame.count = 6;
+  for (int i = 0; i < 6; ++i) {
+    frame.channel[i] = static_cast<uint8_t>(i + 1);
+    frame.value[i] = 205.0;
+  }
+  frame.value[5] = 150.0;
+  frame.seq = 1;
+  bus.store(frame);
+
+  rig.sm.setSampleSource(&bus, 1, 6);
+  rig.sm.setAirZones({{1, 1.0}, {2, 1.0}, {3, 1.0}, {5, 1.0}});   // as in main()
+  rig.sm.command_startAutoMode(200.0);
+  auto publish = [&](double ir) {
+    frame.value[5] = ir;
+    frame.acquired = rig.now;
+    ++frame.seq;
+    bus.store(frame);
+    rig.tick();
+  };
+  for (int i = 0; i < 100; ++i) publish(150.0);   // Warming -> Ready, wall baseline
+  for (int i = 0; i < 5; ++i) publish(20.0);      // part in view, confirmed
+  publish(100.0);
+  if (rig.sm.state() != State::Curing) {
+    st.SkipWithError("did not reach Curing");
+    return;
+  }
+
+  uint64_t n = 0;
+  {
+    AllocCounter allocs(st);
+    for (auto _ : st) {
+      if ((++n & 1) == 0) {
+        frame.acquired = rig.now;
+        ++frame.seq;
+        bus.store(frame);
+      }
+      rig.tick();
+    }
+  }
+  checkDropped(st, rig.sm.dataLogger().droppedPoints());
+}
+BENCHMARK(BM_TickWithFrames)
+    ->Iterations(kRingIterations)->Repetitions(kRingRepetitions)->ReportAggregatesOnly(true);
+
+// ---------------------------------------------------------------------------
+// update_part_detection(): Ready with a noisy IR reading that never drops far
+// enough. It is private, so it is measured through tick(), which in Ready
+// does little else.
+// ---------------------------------------------------------------------------
+void BM_PartDetection(benchmark::State& st) {
+  const auto m = static_cast<OperatingMode>(st.range(0));
+  Rig rig;
+  if (!rig.drive(State::Ready, m)) {
+    st.SkipWithError("could not reach Ready");
+    return;
+  }
+  st.SetLabel(m == OperatingMode::Auto ? "auto" : "manual");
+
+  // Deterministic ±4 °C wobble around 150 °C
+  double ir[64];
+  for (int i = 0; i < 64; ++i) ir[i] = 150.0 + 4.0 * std::sin(i * 0.7);
+
+  size_t i = 0;
+  {
+    AllocCounter allocs(st);
+    for (auto _ : st) {
+      rig.part.inject(ir[i++ & 63]);
+      rig.tick();
+      benchmark::DoNotOptimize(rig.sm.part_detected());
+    }
+  }
+  if (rig.sm.part_detected()) st.SkipWithError("noise was detected as a part");
+}
+BENCHMARK(BM_PartDetection)->Arg(0)->Arg(1);
+
+// ---------------------------------------------------------------------------
+// FilterBank::process(): every stage on, N channels of noisy readings with
+// an occasional spike; 6 is today's THKA, the rest is headroom
+// ---------------------------------------------------------------------------
+void BM_FilterBank(benchmark::State& st) {
+  const auto n = static_cast<size_t>(st.range(0));
+
+  ChannelFilter cf;
+  cf.offset_c       = 0.5;
+  cf.gain           = 1.01;
+  cf.median         = 3;
+  cf.hampel_k       = 3.5;
+  cf.lowpass_tau_s  = 0.5;
+  cf.rate_limit_c_s = 10.0;
+  FilterBank bank;
+  bank.configure(std::vector<ChannelFilter>(n, cf));
+
+  // 64 precomputed polls, one in 16 readings a 50 °C spike
+  std::vector<double> polls(64 * n);
+  for (size_t k = 0; k < polls.size(); ++k)
+    polls[k] = 150.0 + 0.5 * std::sin(k * 0.7) + ((k % 16 == 5) ? 50.0 : 0.0);
+  std::vector<double>  value(n);
+  std::vector<uint8_t> quality(n);
+
+  Clock::time_point t{};
+  size_t i = 0;
+  {
+    AllocCounter allocs(st);
+    for (auto _ : st) {
+      std::copy_n(polls.data() + (i++ & 63) * n, n, value.data());
+      std::fill(quality.begin(), quality.end(), kSampleOk);
+      t += std::chrono::milliseconds(100);
+      bank.process(value.data(), quality.data(), n, t);
+      benchmark::DoNotOptimize(value.data());
+    }
+  }
+  st.SetItemsProcessed(static_cast<int64_t>(st.iterations()) * static_cast<int64_t>(n));
+}
+BENCHMARK(BM_FilterBank)->Arg(6)->Arg(16)->Arg(64)->Arg(256);
+
+// ---------------------------------------------------------------------------
+// DataLogger::logPoint(): in-memory, and streaming CSV / binary
+// ---------------------------------------------------------------------------
+void BM_LogPoint(benchmark::State& st) {
+  const int mode = static_cast<int>(st.range(0));   // 0 memory, 1 CSV, 2 binary
+  DataLogger log;
+  if (mode > 0 &&
+      !log.enableStreaming(benchDir(), mode == 1 ? LogFormat::Csv : LogFormat::Binary)) {
+    st.SkipWithError("cannot stream to the bench directory");
+    return;
+  }
+  st.SetLabel(mode == 0 ? "memory" : (mode == 1 ? "stream-csv" : "stream-binary"));
+  log.startSession(200.0);
+
+  double t = 20.0;
+  const ZonePoint zone{180.0, 40.0};
+  {
+    AllocCounter allocs(st);
+    for (auto _ : st) {
+      t += 0.01;
+      log.logPoint(t, t + 1, t + 2, t + 3, t - 5, t + 1.5, 3.0, &zone, State::Curing);
+    }
+  }
+  log.stopSession();
+  checkDropped(st, log.droppedPoints());
+}
+BENCHMARK(BM_LogPoint)->Arg(0);
+BENCHMARK(BM_LogPoint)->Arg(1)->Arg(2)
+    ->Iterations(kRingIterations)->Repetitions(kRingRepetitions)->ReportAggregatesOnly(true);
+
+// ---------------------------------------------------------------------------
+// DataLogger::saveToCSV() at realistic session lengths (10 Hz):
+// 2 min, 20 min (one cure), 2 h
+// ---------------------------------------------------------------------------
+void BM_SaveToCSV(benchmark::State& st) {
+  const auto points = static_cast<size_t>(st.range(0));
+  const std::string dir = benchDir();
+  std::filesystem::create_directories(dir);
+
+  DataLogger log;
+  log.startSession(200.0);
+  const ZonePoint zone{180.0, 40.0};
+  for (size_t i = 0; i < points; ++i) {
+    const double t = 20.0 + 0.02 * static_cast<double>(i);
+    log.logPoint(t, t + 1, t + 2, t + 3, t - 5, t + 1.5, 3.0, &zone,
+                 i < points / 2 ? State::Warming : State::Curing);
+  }
+  log.stopSession();
+
+  {
+    AllocCounter allocs(st);
+    for (auto _ : st) {
+      if (!log.saveToCSV(dir)) {
+        st.SkipWithError("saveToCSV failed");
+        break;
+      }
+    }
+  }
+  st.SetItemsProcessed(static_cast<int64_t>(st.iterations() * points));
+
+  std::error_code ec;
+  const auto path = dir + "/" + log.getSessionFilename() + ".csv";
+  st.SetBytesProcessed(static_cast<int64_t>(st.iterations() *
+                                            std::filesystem::file_size(path, ec)));
+  std::filesystem::remove(path, ec);
+}
+BENCHMARK(BM_SaveToCSV)->Arg(1200)->Arg(12000)->Arg(72000)->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+int main(int argc, char** argv) {
+  // StateMachine streams cure logs; keep bench sessions out of ~/cure_logs
+  setenv("OVEN_LOG_DIR", benchDir().c_str(), 1);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  std::error_code ec;
+  std::filesystem::remove_all(benchDir(), ec);
+  return 0;
+}
@@ -0,0 +1,36 @@
+#include <iostream>
+#include <string>
+#include "data/CureLog.h"
+
+// Convert a binary cure log (.ovl) to the CSV layout DataLogger writes, so
+// scripts/generate_graphs.py can plot it.
+//
+//   curelog_to_csv cure_log_20250101_120000.ovl [out.csv]
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <log.ovl> [out.csv]" << std::endl;
+        return 2;
+    }
+
+    const std::string in = argv[1];
+    std::string out;
+    if (argc > 2) {
+        out = argv[2];
+    } else {
+        const auto dot = in.rfind('.');
+        out = (dot == std::string::npos ? in : in.substr(0, dot)) + ".csv";
+    }
+
+    CureLogReader reader;
+    if (!reader.open(in)) {
+        std::cerr << "Not a cure log: " << in << std::endl;
+        return 1;
+    }
+    if (!reader.exportCSV(out)) {
+        std::cerr << "Failed to write " << out << std::endl;
+        return 1;
+    }
+
+    std::cout << out << " (" << reader.rowCount() << " rows)" << std::endl;
+    return 0;
+}
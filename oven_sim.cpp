@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "core/StateMachine.h"
+#include "data/PidGainStore.h"
+#include "data/RecipeStore.h"
+#include "hw/impl/SimOven.h"
+
+// Run a full AUTO cure cycle of StateMachine against SimOven, faster than
+// real time: warm up, wait in Ready, open the door and load a cold part,
+// cure, acknowledge. With --autotune, a relay autotune at the target runs
+// first and the cure uses the gains it found. With --preheat-by MIN, the
+// part is unloaded and a pre-heat is scheduled to be at target MIN minutes
+// after the cure; the learnt warm-up model picks the start time. With
+// --zones, readings go through SampleFrames and CH1, CH2, CH3, CH5 are
+// fused into the controlled air temperature; --fail-ch1 MIN makes the CH1
+// thermocouple read open-circuit from MIN minutes on. With --parts N, a
+// rack of N parts of different mass is loaded, one IR channel (CH6, CH7,
+// ...) and one part zone each. With --recipe KEY, one of the default
+// recipes runs instead of the single --target cure.
+//
+//   oven_sim [--target C] [--part-kg KG] [--load-after S] [--seed N]
+//            [--tick-ms MS] [--noise C] [--bang-bang] [--cascade] [--autotune]
+//            [--preheat-by MIN] [--zones] [--fail-ch1 MIN] [--parts N]
+//            [--recipe KEY] [--trace out.csv]
+//
+// Cure logs go to $OVEN_LOG_DIR (default /tmp/oven_sim_logs), not ~/cure_logs.
+namespace {
+
+struct NullRelay : IRelay {
+  bool on{false};
+  void set(bool v) override { on = v; }
+  bool get() const override { return on; }
+};
+
+struct Options {
+  double      target_c     = 200.0;
+  double      part_kg      = 20.0;
+  double      load_after_s = 60.0;   // in Ready before the door opens
+  double      door_open_s  = 15.0;
+  unsigned    seed         = 1;
+  int         tick_ms      = 50;
+  double      noise_c      = 0.1;    // sensor noise, 1σ
+  double      limit_s      = 4 * 3600.0;
+  bool        bang_bang    = false;  // contactor plain on, no PID
+  bool        cascade      = false;
+  bool        autotune     = false;
+  double      preheat_by_min = 0.0;  // 0 = no scheduled pre-heat
+  bool        zones        = false;  // frames + air zone fusion
+  double      fail_ch1_min = -1.0;   // CH1 open-circuit from then on
+  int         parts        = 1;      // rack positions loaded
+  std::string recipe;                // default recipe key; empty = --target
+  std::string trace;
+};
+
+// Rack masses relative to --part-kg: thin and thick parts in one load
+constexpr double kRackMass[SimOven::kMaxParts] = {1.0, 0.5, 1.5, 0.75};
+
+bool parse(int argc, char* argv[], Options& o) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has = i + 1 < argc;
+    if      (a == "--target"     && has) o.target_c     = std::atof(argv[++i]);
+    else if (a == "--part-kg"    && has) o.part_kg      = std::atof(argv[++i]);
+    else if (a == "--load-after" && has) o.load_after_s = std::atof(argv[++i]);
+    else if (a == "--seed"       && has) o.seed         = static_cast<unsigned>(std::atoi(argv[++i]));
+    else if (a == "--tick-ms"    && has) o.tick_ms      = std::max(1, std::atoi(argv[++i]));
+    else if (a == "--noise"      && has) o.noise_c      = std::atof(argv[++i]);
+    else if (a == "--trace"      && has) o.trace        = argv[++i];
+    else if (a == "--bang-bang")         o.bang_bang    = true;
+    else if (a == "--cascade")           o.cascade      = true;
+    else if (a == "--autotune")          o.autotune     = true;
+    else if (a == "--preheat-by" && has) o.preheat_by_min = std::atof(argv[++i]);
+    else if (a == "--zones")             o.zones        = true;
+    else if (a == "--fail-ch1"   && has) o.fail_ch1_min = std::atof(argv[++i]);
+    else if (a == "--recipe"     && has) o.recipe       = argv[++i];
+    else if (a == "--parts"      && has) o.parts        = std::clamp(std::atoi(argv[++i]), 1,
+                                                                     SimOven::kMaxParts);
+    else return false;
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options opt;
+  if (!parse(argc, argv, opt)) {
+    std::cerr << "usage: " << argv[0]
+              << " [--target C] [--part-kg KG] [--load-after S] [--seed N]"
+                 " [--tick-ms MS] [--noise C] [--bang-bang] [--cascade] [--autotune]"
+                 " [--preheat-by MIN] [--zones] [--fail-ch1 MIN] [--parts N]"
+                 " [--recipe KEY] [--trace out.csv]" << std::endl;
+    return 2;
+  }
+
+  Recipe recipe;
+  if (!opt.recipe.empty()) {
+    bool found = false;
+    for (const auto& r : defaultRecipes()) {
+      if (r.key != opt.recipe) continue;
+      recipe = r;
+      found  = true;
+    }
+    if (!found) {
+      std::cerr << "no default recipe " << opt.recipe << std::endl;
+      return 2;
+    }
+    // Overshoot is measured against the hottest step
+    opt.target_c = recipe.max_c();
+  }
+  setenv("OVEN_LOG_DIR", "/tmp/oven_sim_logs", 0);
+
+  SimOven::Params sp;
+  sp.sensor_noise_c = opt.noise_c;
+  sp.ir_sensors     = opt.parts;
+  SimOven oven(sp, opt.seed);
+  NullRelay greenL, redL, amberL, buzzerL;
+
+  Params P{};
+  P.air_target_c      = opt.target_c;
+  P.air_hysteresis_c  = 5.0;
+  P.part_target_c     = opt.target_c;
+  P.part_hysteresis_c = 3.0;
+  P.dwell_seconds     = 20 * 60;
+  // A cooler load (a degas step) leaves the wall cooler at the part drop
+  P.part_min_valid_c  = std::min(120.0, (recipe.segments.empty() ? opt.target_c
+                                                                 : recipe.load_c) - 40.0);
+  P.ir_drop_delta_c   = 15.0;
+  P.pid_enabled       = !opt.bang_bang;
+  P.pid_cascade       = opt.cascade;
+
+  StateMachine sm(P, oven.air_sensor(), oven.part_sensor(), oven.fan2(), oven.fan(),
+                  greenL, redL, amberL, buzzerL, oven.contactor());
+
+  // What ThkaPoller does: one frame per poll on the bus. A failed CH1
+  // thermocouple reads open-circuit (THKA overrange).
+  SampleBus   bus;
+  SampleFrame frame;
+  double      max_spread = 0.0;   // in Curing
+  bool        ch1_failed = false;
+  const bool  frames = opt.zones || opt.fail_ch1_min >= 0 || opt.parts > 1;
+  if (frames) {
+    sm.setSampleSource(&bus, 1, 6);
+    if (opt.zones) sm.setAirZones({{1, 1.0}, {2, 1.0}, {3, 1.0}, {5, 1.0}});
+    std::vector<int> irs;
+    for (int i = 0; i < opt.parts; ++i) irs.push_back(6 + i);
+    sm.setPartZones(irs);
+  }
+  auto publish = [&] {
+    if (!frames) return;
+    oven.fill_frame(frame);
+    ++frame.seq;
+    if (opt.fail_ch1_min >= 0 && oven.time_s() >= opt.fail_ch1_min * 60.0) {
+      if (!ch1_failed)
+        std::cout << "t=" << oven.time_s() << "s  CH1 thermocouple open-circuit" << std::endl;
+      ch1_failed = true;
+      frame.value[0] = 999.9;
+    }
+    bus.store(frame);
+  };
+
+  std::ofstream trace;
+  if (!opt.trace.empty()) {
+    trace.open(opt.trace);
+    trace << "t_s,air_c,wall_c,part_c,heater_c,contactor,state\n";
+  }
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  const double dt = opt.tick_ms / 1000.0;
+
+  std::cout << std::fixed << std::setprecision(1);
+
+  // Scratch gain store: only gains tuned in this run, never the user's
+  const std::string gains_path = "/tmp/oven_sim_pid_gains";
+  std::remove(gains_path.c_str());
+  sm.setPidGainsPath(gains_path);
+
+  if (opt.autotune) {
+    // What OvenBackend::startAutotune() does
+    oven.set_controller_setpoint(opt.target_c + StateMachine::kAutotuneThkaMarginC);
+    sm.command_startAutotune(opt.target_c, recipe.segments.empty() ? Recipe::keyFor(opt.target_c)
+                                                                   : recipe.key);
+    while (oven.time_s() < opt.limit_s && sm.mode() == OperatingMode::Autotune) {
+      oven.advance(dt);
+      publish();
+      sm.tick(oven.now());
+    }
+
+    const RelayAutotune& at = sm.autotune();
+    if (at.phase() != RelayAutotune::Phase::Done) {
+      std::cout << "Autotune failed after " << oven.time_s() / 60.0 << " simulated min: "
+                << at.failure() << std::endl;
+      return 1;
+    }
+    const RelayAutotune::Result& r = at.result();
+    std::cout << "t=" << oven.time_s() << "s  autotune done: Ku=" << std::setprecision(4)
+              << r.ku << " Tu=" << std::setprecision(1) << r.tu_s << "s a="
+              << r.amplitude_c << "°C -> Kp=" << std::setprecision(4) << r.gains.kp
+              << " Ki=" << r.gains.ki << " Kd=" << r.gains.kd
+              << std::setprecision(1) << std::endl;
+  }
+
+  // What OvenBackend::startAutoMode() / startRecipe() do: THKA setpoints
+  // (the recipe's hottest step), then the SM
+  oven.set_controller_setpoint(opt.target_c);
+  if (recipe.segments.empty()) sm.command_startAutoMode(opt.target_c);
+  else                         sm.command_startRecipe(recipe);
+
+  State  last = sm.state();
+  double ready_at = -1, loaded_at = -1;
+  bool   done = false;
+  double peak_air = -1e9, peak_part = -1e9;   // after the air first reaches target
+  bool   reached = false;
+  double switches = 0;
+  bool   was_on = false;
+  int    eta_checks = 0;                      // part ETA printed at +2, +5, +10 min
+  bool   in_band = false;
+  bool   voted_out_seen = false;
+  bool   zone_done[SimOven::kMaxParts] = {};
+  size_t segment = 0;
+
+  std::cout << "t=" << oven.time_s() << "s  " << stateName(last) << std::endl;
+
+  while (oven.time_s() < opt.limit_s && !done) {
+    oven.advance(dt);
+    const double t = oven.time_s();
+
+    // Operator: load a cold part a while after Ready, door open meanwhile
+    if (ready_at >= 0 && loaded_at < 0 && t >= ready_at + opt.load_after_s) {
+      oven.set_door_open(true);
+      for (int i = 0; i < opt.parts; ++i) {
+        oven.insert_part(opt.part_kg * kRackMass[i], 500.0, std::nan(""), i);
+        std::cout << "t=" << t << "s  door open, " << opt.part_kg * kRackMass[i]
+                  << " kg part loaded in zone " << i + 1 << std::endl;
+      }
+      loaded_at = t;
+    }
+    if (loaded_at >= 0 && oven.door_open() && t >= loaded_at + opt.door_open_s)
+      oven.set_door_open(false);
+
+    publish();
+    sm.tick(oven.now());
+
+    const AirFusion::Result& zones = sm.airZones();
+    if (sm.state() == State::Curing && !std::isnan(zones.spread_c))
+      max_spread = std::max(max_spread, zones.spread_c);
+    if (zones.voted_out && !voted_out_seen) {
+      voted_out_seen = true;
+      std::cout << "t=" << t << "s  air zones: " << zones.zones_used << "/" << zones.zones
+                << " in use, estimate " << zones.air_c << "°C (true " << oven.air_c()
+                << "°C)" << std::endl;
+    }
+
+    reached = reached || oven.air_c() >= opt.target_c;
+    if (reached) {
+      peak_air = std::max(peak_air, oven.air_c());
+      if (oven.part_present()) peak_part = std::max(peak_part, oven.part_c());
+    }
+    // How well the part estimator predicts reaching the cure band
+    constexpr double kEtaAt[] = {120.0, 300.0, 600.0};
+    if (loaded_at >= 0 && eta_checks < 3 && t >= loaded_at + kEtaAt[eta_checks]) {
+      ++eta_checks;
+      const double eta = sm.part_eta_s();
+      if (!std::isnan(eta))
+        std::cout << "t=" << t << "s  part " << sm.part_c() << "°C at "
+                  << sm.part_rate_c_s() * 60.0 << "°C/min, in band in " << eta
+                  << "s (t=" << t + eta << "s)" << std::endl;
+    }
+    if (sm.state() == State::Curing && sm.recipe_segment() != segment) {
+      segment = sm.recipe_segment();
+      const RecipeSegment& s = sm.recipe().segments[segment];
+      std::cout << "t=" << t << "s  segment " << segment + 1 << "/" << sm.recipe().segments.size()
+                << ": " << s.ramp_c_min << "°C/min to " << s.soak_c << "°C, "
+                << basisName(s.basis) << " soak, part=" << oven.part_c() << std::endl;
+    }
+    if (!in_band && sm.auto_part_at_temp()) {
+      in_band = true;
+      std::cout << "t=" << t << "s  part in cure band" << std::endl;
+    }
+    for (int i = 0; opt.parts > 1 && i < opt.parts; ++i) {
+      const PartZoneStatus z = sm.partZone(static_cast<size_t>(i));
+      if (!z.done || zone_done[i]) continue;
+      zone_done[i] = true;
+      std::cout << "t=" << t << "s  zone " << i + 1 << " (" << opt.part_kg * kRackMass[i]
+                << " kg) cured, " << (t - loaded_at) / 60.0 << " min after loading" << std::endl;
+    }
+
+    if (oven.contactor().get() != was_on) {
+      was_on = !was_on;
+      switches += was_on ? 1 : 0;
+    }
+
+    if (sm.state() != last) {
+      last = sm.state();
+      std::cout << "t=" << t << "s  " << stateName(last)
+                << "  air=" << oven.air_c() << " wall=" << oven.wall_c()
+                << " part=" << oven.part_c() << std::endl;
+      if (last == State::Ready && ready_at < 0) ready_at = t;
+      if (last == State::Curing && loaded_at < 0)
+        std::cout << "           false part detection" << std::endl;
+      if (last == State::AutoCureComplete) {
+        sm.command_acknowledgeAutoCureComplete();
+        oven.remove_part();
+        done = true;
+      }
+      if (last == State::Fault) break;
+    }
+
+    if (trace.is_open())
+      trace << t << "," << oven.air_c() << "," << oven.wall_c() << ","
+            << (oven.part_present() ? oven.part_c() : std::nan("")) << ","
+            << oven.heater_c() << "," << oven.contactor().get() << ","
+            << stateName(sm.state()) << "\n";
+  }
+
+  // Scheduled pre-heat from the idle, cooling oven
+  bool preheat_ok = true;
+  if (done && opt.preheat_by_min > 0) {
+    const double by_s = oven.time_s() + opt.preheat_by_min * 60.0;
+    sm.command_schedulePreheat(opt.target_c, oven.now() + std::chrono::seconds(
+                                               static_cast<long>(opt.preheat_by_min * 60.0)));
+    std::cout << "t=" << oven.time_s() << "s  pre-heat to " << opt.target_c
+              << "°C scheduled for t=" << by_s << "s (warm-up model: "
+              << sm.heatupModel().windows() << " windows, approach "
+              << sm.heatupModel().tail_s() << "s)" << std::endl;
+
+    double started = -1, ready = -1;
+    while (oven.time_s() < by_s + 3600.0 && ready < 0) {
+      oven.advance(dt);
+      publish();
+      sm.tick(oven.now());
+      if (started < 0 && sm.state() != State::Idle) {
+        started = oven.time_s();
+        std::cout << "t=" << started << "s  pre-heat started, air=" << oven.air_c()
+                  << " wall=" << oven.wall_c() << ", ETA " << sm.warmup_eta_s() << "s" << std::endl;
+      }
+      if (sm.state() == State::Ready) ready = oven.time_s();
+    }
+    preheat_ok = ready >= 0;
+    if (preheat_ok)
+      std::cout << "t=" << ready << "s  Ready, " << (ready - by_s)
+                << "s against the deadline (negative = early)" << std::endl;
+    else
+      std::cout << "Pre-heat did not reach Ready" << std::endl;
+  }
+
+  const double wall_ms = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - wall_start).count();
+  std::cout << "Air overshoot " << (peak_air - opt.target_c) << " °C";
+  if (peak_part > -1e9) std::cout << ", part overshoot " << (peak_part - opt.target_c) << " °C";
+  std::cout << ", " << static_cast<int>(switches) << " contactor closures" << std::endl;
+  if (opt.zones) std::cout << "Max air zone spread while curing " << max_spread << " °C" << std::endl;
+  std::cout << (done ? "Cure complete" : "Did not complete") << " after "
+            << oven.time_s() / 60.0 << " simulated min, " << oven.energy_kwh() << " kWh, "
+            << std::setprecision(0) << wall_ms << " ms wall time" << std::endl;
+  return (done && preheat_ok) ? 0 : 1;
+}
@@ -328,21 +328,21 @@ ApplicationWindow {
 
             Button {
                 text: "MANUAL MODE"
-                Layout.preferredWidth: parent.width / 2 - 10
+                Layout.preferredWidth: parent.width / 4 - 12
                 Layout.preferredHeight: 60
                 font.pixelSize: 22
                 font.bold: true
                 enabled: !oven.autoModeActive
 
                 background: Rectangle {
-                    color: !stackLayout.currentIndex ? "#4CAF50" : (parent.pressed ? "#ccc" : "#e0e0e0")
+                    color: stackLayout.currentIndex === 0 ? "#4CAF50" : (parent.pressed ? "#ccc" : "#e0e0e0")
                     radius: 8
                 }
 
                 contentItem: Text {
                     text: parent.text
                     font: parent.font
-                    color: !stackLayout.currentIndex ? "white" : "#333"
+                    color: stackLayout.currentIndex === 0 ? "white" : "#333"
                     horizontalAlignment: Text.AlignHCenter
                     verticalAlignment: Text.AlignVCenter
                 }
@@ -352,26 +352,72 @@ ApplicationWindow {
 
             Button {
                 text: "AUTO MODE"
-                Layout.preferredWidth: parent.width / 2 - 10
+                Layout.preferredWidth: parent.width / 4 - 12
                 Layout.preferredHeight: 60
                 font.pixelSize: 22
                 font.bold: true
 
                 background: Rectangle {
-                    color: stackLayout.currentIndex ? "#FF9800" : (parent.pressed ? "#ccc" : "#e0e0e0")
+                    color: stackLayout.currentIndex === 1 ? "#FF9800" : (parent.pressed ? "#ccc" : "#e0e0e0")
                     radius: 8
                 }
 
                 contentItem: Text {
                     text: parent.text
                     font: parent.font
-                    color: stackLayout.currentIndex ? "white" : "#333"
+                    color: stackLayout.currentIndex === 1 ? "white" : "#333"
                     horizontalAlignment: Text.AlignHCenter
                     verticalAlignment: Text.AlignVCenter
                 }
 
                 onClicked: stackLayout.currentIndex = 1
             }
+
+            Button {
+                text: "TRENDS"
+                Layout.preferredWidth: parent.width / 4 - 12
+                Layout.preferredHeight: 60
+                font.pixelSize: 22
+                font.bold: true
+
+                background: Rectangle {
+                    color: stackLayout.currentIndex === 2 ? "#2196F3" : (parent.pressed ? "#ccc" : "#e0e0e0")
+                    radius: 8
+                }
+
+                contentItem: Text {
+                    text: parent.text
+                    font: parent.font
+                    color: stackLayout.currentIndex === 2 ? "white" : "#333"
+                    horizontalAlignment: Text.AlignHCenter
+                    verticalAlignment: Text.AlignVCenter
+                }
+
+                onClicked: stackLayout.currentIndex = 2
+            }
+
+            Button {
+                text: "DIAGNOSTICS"
+                Layout.preferredWidth: parent.width / 4 - 12
+                Layout.preferredHeight: 60
+                font.pixelSize: 22
+                font.bold: true
+
+                background: Rectangle {
+                    color: stackLayout.currentIndex === 3 ? "#607D8B" : (parent.pressed ? "#ccc" : "#e0e0e0")
+                    radius: 8
+                }
+
+                contentItem: Text {
+                    text: parent.text
+                    font: parent.font
+                    color: stackLayout.currentIndex === 3 ? "white" : "#333"
+                    horizontalAlignment: Text.AlignHCenter
+                    verticalAlignment: Text.AlignVCenter
+                }
+
+                onClicked: stackLayout.currentIndex = 3
+            }
         }
 
         // Status bar
@@ -383,7 +429,25 @@ ApplicationWindow {
             Layout.alignment: Qt.AlignHCenter
         }
 
-        // Stack layout for Manual/Auto screens
+        Label {
+            visible: !oven.thkaLinkUp
+            text: "THKA link down: " + oven.thkaLinkStatus
+            font.pixelSize: 20
+            font.bold: true
+            color: "#C62828"
+            Layout.alignment: Qt.AlignHCenter
+        }
+
+        Label {
+            visible: oven.cureLogInMemory
+            text: "Cure log cannot be written to disk - kept in memory, saved when the cure ends"
+            font.pixelSize: 20
+            font.bold: true
+            color: "#C62828"
+            Layout.alignment: Qt.AlignHCenter
+        }
+
+        // Stack layout for Manual/Auto/Trend/Diagnostics screens
         StackLayout {
             id: stackLayout
             Layout.fillWidth: true
@@ -429,6 +493,24 @@ ApplicationWindow {
                                     }
                                 }
                             }
+
+                            // Chamber uniformity across the fused air zones
+                            Label {
+                                text: oven.airSpread >= 0
+                                      ? "Spread: " + oven.airSpread.toFixed(1) + "°C"
+                                      : "Spread: --"
+                                color: oven.airDegraded ? "#E65100" : "#333"
+                                font.pixelSize: 20
+                                font.bold: true
+                            }
+                            Label {
+                                text: oven.airZonesStatus
+                                visible: text !== ""
+                                color: oven.airDegraded ? "#E65100" : "#666"
+                                font.pixelSize: 14
+                                wrapMode: Text.WordWrap
+                                Layout.fillWidth: true
+                            }
                         }
                     }
 
@@ -720,6 +802,40 @@ ApplicationWindow {
                             font.bold: true
                             color: "#E65100"
                         }
+
+                        Label {
+                            anchors.horizontalCenter: parent.horizontalCenter
+                            anchors.bottom: parent.bottom
+                            anchors.bottomMargin: 6
+                            text: oven.airZonesStatus
+                            visible: oven.autoModeActive && text !== ""
+                            font.pixelSize: 16
+                            color: oven.airDegraded ? "#C62828" : "#795548"
+                        }
+                    }
+
+                    // Recipe selection: a custom single temperature or a stored recipe
+                    RowLayout {
+                        Layout.fillWidth: true
+                        spacing: 15
+                        visible: !oven.autoModeActive && oven.recipes.length > 0
+
+                        ComboBox {
+                            id: recipeBox
+                            model: ["Custom temperature"].concat(oven.recipes.map(r => r.name))
+                            font.pixelSize: 22
+                            Layout.preferredWidth: 420
+                            Layout.preferredHeight: 60
+                        }
+
+                        Label {
+                            text: recipeBox.currentIndex > 0
+                                  ? oven.recipes[recipeBox.currentIndex - 1].summary : ""
+                            font.pixelSize: 16
+                            color: "#666"
+                            wrapMode: Text.WordWrap
+                            Layout.fillWidth: true
+                        }
                     }
 
                     // Temperature selection
@@ -730,7 +846,7 @@ ApplicationWindow {
                         border.color: "#FF9800"
                         border.width: 3
                         radius: 10
-                        visible: !oven.autoModeActive
+                        visible: !oven.autoModeActive && recipeBox.currentIndex <= 0
 
                         MouseArea {
                             anchors.fill: parent
@@ -762,15 +878,16 @@ ApplicationWindow {
                         }
                     }
 
-                    // Timer display (only during curing)
+                    // Cure progress and time left (only during curing)
                     Rectangle {
                         Layout.fillWidth: true
-                        Layout.preferredHeight: 120
+                        Layout.preferredHeight: 160
                         color: "#E8F5E9"
                         border.color: "#4CAF50"
                         border.width: 3
                         radius: 10
-                        visible: oven.autoModeActive && oven.autoCureTimeLeft > 0
+                        visible: oven.autoModeActive
+                                 && (oven.autoCureTimeLeft > 0 || oven.autoCureProgress > 0)
 
                         ColumnLayout {
                             anchors.centerIn: parent
@@ -789,17 +906,79 @@ ApplicationWindow {
                             }
 
                             Label {
-                                text: "Time Remaining"
+                                text: oven.autoCureTimeLeft > 0
+                                      ? "Time Remaining - " + oven.autoCureProgress.toFixed(0) + "% cured"
+                                      : oven.autoCureProgress.toFixed(0) + "% cured - part below cure temperature"
                                 font.pixelSize: 20
                                 color: "#4CAF50"
                                 Layout.alignment: Qt.AlignHCenter
                             }
+
+                            ProgressBar {
+                                from: 0
+                                to: 100
+                                value: oven.autoCureProgress
+                                Layout.preferredWidth: 500
+                                Layout.alignment: Qt.AlignHCenter
+                            }
+                        }
+                    }
+
+                    // Per-part progress when the rack has several part zones
+                    Rectangle {
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: zoneColumn.implicitHeight + 20
+                        color: "#F1F8E9"
+                        border.color: "#8BC34A"
+                        border.width: 2
+                        radius: 10
+                        visible: oven.autoModeActive && oven.partZones.length > 1
+                                 && oven.partZones.some(z => z.detected)
+
+                        ColumnLayout {
+                            id: zoneColumn
+                            anchors.fill: parent
+                            anchors.margins: 10
+                            spacing: 4
+
+                            Repeater {
+                                model: oven.partZones
+
+                                RowLayout {
+                                    Layout.fillWidth: true
+                                    spacing: 12
+
+                                    Label {
+                                        text: "Zone " + (index + 1) + " (CH" + modelData.channel + ")"
+                                        font.pixelSize: 18
+                                        Layout.preferredWidth: 140
+                                    }
+                                    ProgressBar {
+                                        from: 0
+                                        to: 100
+                                        value: modelData.progress
+                                        enabled: modelData.detected
+                                        Layout.fillWidth: true
+                                    }
+                                    Label {
+                                        text: !modelData.detected ? "empty"
+                                              : modelData.done ? "✓ cured"
+                                              : modelData.progress.toFixed(0) + "%  "
+                                                + (modelData.temp >= 0 ? modelData.temp.toFixed(1) + "°C" : "--")
+                                        color: modelData.done ? "#2E7D32"
+                                               : modelData.atTemp ? "#4CAF50" : "#795548"
+                                        font.pixelSize: 18
+                                        Layout.preferredWidth: 150
+                                    }
+                                }
+                            }
                         }
                     }
 
                     // Start/Cancel button
                     Button {
                         text: oven.autoModeActive ? "CANCEL AUTO MODE" : "START AUTO CYCLE"
+                        enabled: !oven.autotuneActive
                         Layout.fillWidth: true
                         Layout.preferredHeight: 120
                         font.pixelSize: 32
@@ -823,6 +1002,8 @@ ApplicationWindow {
                         onClicked: {
                             if (oven.autoModeActive) {
                                 oven.cancelAutoMode()
+                            } else if (recipeBox.currentIndex > 0) {
+                                oven.startRecipe(recipeBox.currentIndex - 1)
                             } else {
                                 let targetTemp = parseInt(tempInput.text)
                                 if (targetTemp >= 0 && targetTemp <= 400) {
@@ -831,6 +1012,389 @@ ApplicationWindow {
                             }
                         }
                     }
+
+                    // Scheduled pre-heat: be at the selected temperature by hh:mm
+                    RowLayout {
+                        Layout.fillWidth: true
+                        spacing: 15
+                        visible: !oven.autoModeActive && !oven.autotuneActive
+
+                        Label {
+                            text: oven.preheatStatus !== "" ? oven.preheatStatus : "Pre-heat by"
+                            font.pixelSize: 18
+                            color: "#666"
+                            elide: Text.ElideRight
+                            Layout.fillWidth: true
+                        }
+
+                        TextField {
+                            id: preheatTime
+                            text: "07:00"
+                            inputMask: "99:99"
+                            font.pixelSize: 22
+                            horizontalAlignment: Text.AlignHCenter
+                            Layout.preferredWidth: 110
+                            Layout.preferredHeight: 60
+                            enabled: !oven.preheatPending
+                        }
+
+                        Button {
+                            text: oven.preheatPending ? "CANCEL PRE-HEAT" : "PRE-HEAT"
+                            Layout.preferredWidth: 260
+                            Layout.preferredHeight: 60
+                            font.pixelSize: 20
+                            font.bold: true
+
+                            background: Rectangle {
+                                color: oven.preheatPending
+                                    ? (parent.pressed ? "#C62828" : "#f44336")
+                                    : (parent.pressed ? "#1565C0" : "#2196F3")
+                                radius: 10
+                            }
+
+                            contentItem: Text {
+                                text: parent.text
+                                font: parent.font
+                                color: "white"
+                                horizontalAlignment: Text.AlignHCenter
+                                verticalAlignment: Text.AlignVCenter
+                            }
+
+                            onClicked: {
+                                if (oven.preheatPending) {
+                                    oven.cancelPreheat()
+                                } else if (recipeBox.currentIndex > 0) {
+                                    oven.schedulePreheat(0, preheatTime.text, recipeBox.currentIndex - 1)
+                                } else {
+                                    let targetTemp = parseInt(tempInput.text)
+                                    if (targetTemp > 0 && targetTemp <= 400) {
+                                        oven.schedulePreheat(targetTemp, preheatTime.text)
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    // PID autotune at the selected temperature (empty oven)
+                    RowLayout {
+                        Layout.fillWidth: true
+                        spacing: 15
+                        visible: !oven.autoModeActive
+
+                        Label {
+                            text: "PID tune: " + oven.autotuneStatus
+                            font.pixelSize: 18
+                            color: "#666"
+                            elide: Text.ElideRight
+                            Layout.fillWidth: true
+                        }
+
+                        Button {
+                            text: oven.autotuneActive ? "CANCEL AUTOTUNE" : "AUTOTUNE"
+                            Layout.preferredWidth: 260
+                            Layout.preferredHeight: 60
+                            font.pixelSize: 20
+                            font.bold: true
+
+                            background: Rectangle {
+                                color: oven.autotuneActive
+                                    ? (parent.pressed ? "#C62828" : "#f44336")
+                                    : (parent.pressed ? "#F57C00" : "#FF9800")
+                                radius: 10
+                            }
+
+                            contentItem: Text {
+                                text: parent.text
+                                font: parent.font
+                                color: "white"
+                                horizontalAlignment: Text.AlignHCenter
+                                verticalAlignment: Text.AlignVCenter
+                            }
+
+                            onClicked: {
+                                if (oven.autotuneActive) {
+                                    oven.cancelAutotune()
+                                } else {
+                                    let setpoint = parseInt(tempInput.text)
+                                    if (setpoint > 0 && setpoint <= 400) {
+                                        oven.startAutotune(setpoint)
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            // ========== TREND SCREEN ==========
+            Item {
+                ColumnLayout {
+                    anchors.fill: parent
+                    spacing: 10
+
+                    // Time window selector
+                    RowLayout {
+                        Layout.fillWidth: true
+                        spacing: 10
+
+                        Repeater {
+                            model: [
+                                { label: "10 MIN", secs: 600 },
+                                { label: "1 HOUR", secs: 3600 },
+                                { label: "4 HOURS", secs: 14400 }
+                            ]
+                            delegate: Button {
+                                text: modelData.label
+                                Layout.fillWidth: true
+                                Layout.preferredHeight: 50
+                                font.pixelSize: 18
+                                font.bold: true
+
+                                background: Rectangle {
+                                    color: oven.trend.windowSeconds === modelData.secs
+                                        ? "#2196F3" : (parent.pressed ? "#ccc" : "#e0e0e0")
+                                    radius: 6
+                                }
+
+                                contentItem: Text {
+                                    text: parent.text
+                                    font: parent.font
+                                    color: oven.trend.windowSeconds === modelData.secs ? "white" : "#333"
+                                    horizontalAlignment: Text.AlignHCenter
+                                    verticalAlignment: Text.AlignVCenter
+                                }
+
+                                onClicked: oven.trend.windowSeconds = modelData.secs
+                            }
+                        }
+                    }
+
+                    // Min/max envelope per channel; one bucket per pixel column
+                    Canvas {
+                        id: trendCanvas
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+
+                        property var colors: ["#E74C3C", "#3498DB", "#2ECC71", "#95A5A6", "#9B59B6", "#F39C12"]
+
+                        onWidthChanged: oven.trend.pixelWidth = Math.max(1, Math.floor(width))
+
+                        Connections {
+                            target: oven.trend
+                            function onUpdated() { trendCanvas.requestPaint() }
+                        }
+
+                        onPaint: {
+                            let ctx = getContext("2d")
+                            ctx.reset()
+                            ctx.fillStyle = "white"
+                            ctx.fillRect(0, 0, width, height)
+
+                            let win = oven.trend.windowSeconds
+                            let px = Math.max(1, Math.floor(width))
+                            let series = []
+                            let lo = Infinity, hi = -Infinity
+                            for (let ch = 0; ch < oven.trend.channelCount; ++ch) {
+                                let pts = oven.trend.query(ch, win, px)
+                                series.push(pts)
+                                for (let i = 0; i < pts.length; i += 3) {
+                                    lo = Math.min(lo, pts[i + 1])
+                                    hi = Math.max(hi, pts[i + 2])
+                                }
+                            }
+                            if (lo > hi) return
+
+                            lo = Math.floor(lo / 10) * 10 - 10
+                            hi = Math.ceil(hi / 10) * 10 + 10
+                            let xOf = t => (t + win) / win * width
+                            let yOf = v => height - (v - lo) / (hi - lo) * height
+
+                            // Horizontal grid every 10 / 50 °C
+                            let step = (hi - lo) > 200 ? 50 : 10
+                            ctx.strokeStyle = "#eee"
+                            ctx.fillStyle = "#999"
+                            ctx.font = "14px sans-serif"
+                            for (let g = lo; g <= hi; g += step) {
+                                ctx.beginPath()
+                                ctx.moveTo(0, yOf(g))
+                                ctx.lineTo(width, yOf(g))
+                                ctx.stroke()
+                                ctx.fillText(g + " °C", 4, yOf(g) - 2)
+                            }
+
+                            for (let s = 0; s < series.length; ++s) {
+                                let pts = series[s]
+                                ctx.strokeStyle = colors[s % colors.length]
+                                ctx.lineWidth = 2
+                                ctx.beginPath()
+                                // Continuous trace through each bucket's min and max
+                                for (let i = 0; i < pts.length; i += 3) {
+                                    let x = xOf(pts[i])
+                                    if (i === 0) ctx.moveTo(x, yOf(pts[i + 1]))
+                                    else ctx.lineTo(x, yOf(pts[i + 1]))
+                                    ctx.lineTo(x, yOf(pts[i + 2]))
+                                }
+                                ctx.stroke()
+                            }
+                        }
+                    }
+
+                    // Legend
+                    RowLayout {
+                        Layout.alignment: Qt.AlignHCenter
+                        spacing: 20
+
+                        Repeater {
+                            model: oven.trend.channelCount
+                            delegate: RowLayout {
+                                spacing: 6
+                                Rectangle {
+                                    width: 18
+                                    height: 18
+                                    radius: 3
+                                    color: trendCanvas.colors[index % trendCanvas.colors.length]
+                                }
+                                Label {
+                                    text: "CH" + (index + 1)
+                                    font.pixelSize: 16
+                                    color: "#333"
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            // ========== DIAGNOSTICS SCREEN ==========
+            Item {
+                id: diagPage
+                property var rows: []
+                property var counters: ({})
+                property string dumpStatus: ""
+
+                function refresh() {
+                    rows = oven.diagnosticsRows()
+                    counters = oven.diagnosticsCounters()
+                }
+
+                // Only poll the histograms while the page is shown
+                Timer {
+                    interval: 1000
+                    repeat: true
+                    triggeredOnStart: true
+                    running: stackLayout.currentIndex === 3
+                    onTriggered: diagPage.refresh()
+                }
+
+                ColumnLayout {
+                    anchors.fill: parent
+                    spacing: 10
+
+                    // Header: all times in milliseconds
+                    RowLayout {
+                        Layout.fillWidth: true
+                        spacing: 0
+                        Repeater {
+                            model: ["Path", "Count", "Mean", "p50", "p90", "p99", "p99.9", "Max"]
+                            delegate: Label {
+                                text: modelData
+                                Layout.preferredWidth: index === 0 ? 260 : 100
+                                horizontalAlignment: index === 0 ? Text.AlignLeft : Text.AlignRight
+                                font.pixelSize: 18
+                                font.bold: true
+                                color: "#333"
+                            }
+                        }
+                    }
+
+                    ListView {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        clip: true
+                        model: diagPage.rows
+
+                        delegate: RowLayout {
+                            spacing: 0
+                            property var r: modelData
+                            Repeater {
+                                model: [r.name, r.count, r.mean, r.p50, r.p90, r.p99, r.p999, r.max]
+                                delegate: Label {
+                                    text: index <= 1 ? modelData : Number(modelData).toFixed(2)
+                                    Layout.preferredWidth: index === 0 ? 260 : 100
+                                    horizontalAlignment: index === 0 ? Text.AlignLeft : Text.AlignRight
+                                    font.pixelSize: 16
+                                    font.family: "monospace"
+                                    color: "#333"
+                                }
+                            }
+                        }
+                    }
+
+                    Label {
+                        text: "Setpoint writes: " + (diagPage.counters.writesQueued || 0) + " queued, "
+                              + (diagPage.counters.writesCompleted || 0) + " completed, "
+                              + (diagPage.counters.writesFailed || 0) + " failed, "
+                              + (diagPage.counters.writesPending || 0) + " pending"
+                        font.pixelSize: 18
+                        color: "#333"
+                    }
+
+                    Label {
+                        text: "Filtered outliers: " + (diagPage.counters.samplesRejected || 0)
+                        font.pixelSize: 18
+                        color: "#333"
+                    }
+
+                    Label {
+                        text: "THKA stopped answering: " + (diagPage.counters.breakerTrips || 0) + " times"
+                        font.pixelSize: 18
+                        color: "#333"
+                    }
+
+                    Repeater {
+                        model: diagPage.counters.bus || []
+                        delegate: Label {
+                            text: "Bus " + modelData.name + ": " + modelData.transactions + " transactions, "
+                                  + modelData.failures + " failed, "
+                                  + modelData.missed + " missed deadlines, "
+                                  + Number(modelData.busMs / 1000).toFixed(1) + " s on the bus"
+                            font.pixelSize: 18
+                            color: "#333"
+                        }
+                    }
+
+                    RowLayout {
+                        Layout.fillWidth: true
+                        spacing: 10
+
+                        Button {
+                            text: "DUMP TO FILE"
+                            Layout.preferredHeight: 50
+                            font.pixelSize: 18
+                            onClicked: {
+                                let path = oven.dumpDiagnostics()
+                                diagPage.dumpStatus = path !== "" ? "Saved " + path : "Dump failed"
+                            }
+                        }
+
+                        Button {
+                            text: "RESET"
+                            Layout.preferredHeight: 50
+                            font.pixelSize: 18
+                            onClicked: {
+                                oven.resetDiagnostics()
+                                diagPage.refresh()
+                            }
+                        }
+
+                        Label {
+                            text: diagPage.dumpStatus
+                            font.pixelSize: 16
+                            color: "#666"
+                            Layout.fillWidth: true
+                            elide: Text.ElideMiddle
+                        }
+                    }
                 }
             }
         }
@@ -1,12 +1,13 @@
 #include <iostream>
 #include <cmath>
 #include "hw/impl/ThkaRs485Temp.h"
+#include "hw/impl/ThkaProbe.h"
 
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "Testing Registers 0-5 (Manual says '1-6 channel setting value')\n" << std::endl;
     
     ThkaConfig cfg;
-    cfg.device = "/dev/ttyUSB0";
+    cfg.device = argc > 1 ? argv[1] : "/dev/ttyUSB0";   // or thka_emu's link
     cfg.baud = 9600;
     cfg.parity = 'N';
     cfg.databits = 8;
@@ -15,19 +16,22 @@ int main() {
     
     // First, try to READ registers 0-5 to see what's there
     std::cout << "Step 1: Reading current values in registers 0-5..." << std::endl;
-    for (uint16_t reg = 0; reg <= 5; reg++) {
-        cfg.channels = {{1, reg, 0, 0.1}};
-        try {
-            ThkaRs485Temp sensor(cfg);
-            double value = sensor.read_channel_celsius(1);
-            if (!std::isnan(value)) {
-                std::cout << "  Register " << reg << ": " << value << "°C" << std::endl;
+    try {
+        ThkaRs485Temp sensor(cfg);
+        if (!sensor.connect()) {
+            std::cout << "  Cannot open " << cfg.device << ": " << sensor.last_error() << std::endl;
+            return 1;
+        }
+        for (const auto& k : sensor.probe_registers(0, 6)) {
+            if (k.fn != ThkaReadFn::None) {
+                std::cout << "  Register " << k.reg << ": " << k.value_c << "°C (function 0x0"
+                          << static_cast<int>(k.fn) << ")" << std::endl;
             } else {
-                std::cout << "  Register " << reg << ": Could not read" << std::endl;
+                std::cout << "  Register " << k.reg << ": Could not read" << std::endl;
             }
-        } catch (...) {
-            std::cout << "  Register " << reg << ": Error reading" << std::endl;
         }
+    } catch (const std::exception& e) {
+        std::cout << "  Error reading: " << e.what() << std::endl;
     }
     
     std::cout << "\nStep 2: Testing WRITE to register 0 (should be CH1 setpoint)..." << std::endl;
@@ -39,6 +43,10 @@ int main() {
     cfg.channels = {{1, 768, 0, 0.1}};  // Read from 768, write to 0
     try {
         ThkaRs485Temp sensor(cfg);
+        if (!sensor.connect()) {
+            std::cout << "Cannot open " << cfg.device << ": " << sensor.last_error() << std::endl;
+            return 1;
+        }
         bool success = sensor.write_setpoint_celsius(1, 100);
         
         if (success) {
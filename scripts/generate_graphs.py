@@ -1,9 +1,13 @@
 #!/usr/bin/env python3
 """
 Graph Generator for Oven Cure Cycles
-Reads CSV files and generates temperature vs time graphs
+Reads CSV files and generates temperature vs time graphs.
+Binary cure logs (.ovl) are converted to CSV first with curelog_to_csv.
 """
 
+import os
+import shutil
+import subprocess
 import pandas as pd
 import matplotlib.pyplot as plt
 import matplotlib.dates as mdates
@@ -83,6 +87,9 @@ def generate_graph(csv_path, output_dir=None):
     info_text = f'Cycle Duration: {total_time:.0f}s ({total_time/60:.1f} min)\n'
     info_text += f'Setpoint: {setpoint}°C\n'
     info_text += f'Max Temperature: {max_temp:.1f}°C'
+    # Chamber uniformity (logs written since air zone fusion)
+    if 'Spread(°C)' in df.columns and df['Spread(°C)'].notna().any():
+        info_text += f"\nMax Zone Spread: {df['Spread(°C)'].max():.1f}°C"
     
     plt.text(0.02, 0.98, info_text,
              transform=plt.gca().transAxes,
@@ -113,8 +120,44 @@ def generate_graph(csv_path, output_dir=None):
     plt.close()
     return True
 
+def find_exporter():
+    """Locate the curelog_to_csv tool (env override, PATH, then build dir)"""
+    candidates = [
+        os.environ.get("CURELOG_TO_CSV"),
+        shutil.which("curelog_to_csv"),
+        str(Path(__file__).resolve().parent.parent / "build" / "curelog_to_csv"),
+    ]
+    for c in candidates:
+        if c and Path(c).is_file():
+            return c
+    return None
+
+def convert_binary_log(ovl_path):
+    """
+    Convert a binary cure log to CSV next to it (skipped if the CSV is newer)
+
+    Returns:
+        Path of the CSV, or None if it could not be produced
+    """
+    ovl_path = Path(ovl_path)
+    csv_path = ovl_path.with_suffix(".csv")
+    if csv_path.exists() and csv_path.stat().st_mtime >= ovl_path.stat().st_mtime:
+        return csv_path
+
+    exporter = find_exporter()
+    if exporter is None:
+        print(f"Cannot convert {ovl_path.name}: curelog_to_csv not found "
+              "(build it or set CURELOG_TO_CSV)")
+        return None
+
+    result = subprocess.run([exporter, str(ovl_path), str(csv_path)])
+    return csv_path if result.returncode == 0 else None
+
 def process_directory(directory):
     """Process all CSV files in a directory"""
+    for ovl_file in Path(directory).glob("cure_log_*.ovl"):
+        convert_binary_log(ovl_file)
+
     csv_files = list(Path(directory).glob("cure_log_*.csv"))
     
     if not csv_files:
@@ -136,7 +179,12 @@ if __name__ == "__main__":
     else:
         # Process specific file or directory
         path = sys.argv[1]
-        if Path(path).is_file():
+        if Path(path).is_file() and Path(path).suffix == ".ovl":
+            csv_path = convert_binary_log(path)
+            if csv_path is None:
+                sys.exit(1)
+            generate_graph(str(csv_path))
+        elif Path(path).is_file():
             generate_graph(path)
         elif Path(path).is_dir():
             process_directory(path)
@@ -0,0 +1,100 @@
+#include "AirFusion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kMadSigma = 1.4826;    // MAD -> σ for Gaussian noise
+
+// Median of v[0..n), n > 0; reorders v
+double median(double* v, size_t n) {
+  std::sort(v, v + n);
+  return (n % 2) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+} // namespace
+
+void AirFusion::configure(const std::vector<AirZone>& zones, const Options& opt) {
+  opt_ = opt;
+  n_   = std::min(zones.size(), kMaxZones);
+  std::copy_n(zones.begin(), n_, zones_.begin());
+  reset();
+}
+
+void AirFusion::reset() {
+  strikes_.fill(0);
+  out_.fill(false);
+  res_ = Result{};
+  res_.zones = static_cast<int>(n_);
+}
+
+const AirFusion::Result& AirFusion::update(const SampleFrame& f) {
+  // Per zone: reading, whether there is one, whether it is from this poll
+  std::array<double, kMaxZones> value{};
+  std::array<bool, kMaxZones>   have{}, fresh{}, disagree{};
+  std::array<bool, kMaxZones>   out_now{};
+  std::array<double, kMaxZones> scratch{};
+  size_t n_fresh = 0;
+
+  for (size_t z = 0; z < n_; ++z) {
+    const int slot = f.slot(zones_[z].channel);
+    if (slot < 0 || (f.quality[slot] & kSampleMissing) || std::isnan(f.value[slot])) continue;
+    value[z] = f.value[slot];
+    have[z]  = true;
+    fresh[z] = !(f.quality[slot] & (kSampleStale | kSampleHeld));
+    if (fresh[z]) scratch[n_fresh++] = value[z];
+  }
+
+  // Vote on the fresh zones
+  if (n_fresh >= 3) {
+    const double med = median(scratch.data(), n_fresh);
+    size_t k = 0;
+    for (size_t z = 0; z < n_; ++z)
+      if (fresh[z]) scratch[k++] = std::fabs(value[z] - med);
+    const double band = std::max(opt_.vote_k * kMadSigma * median(scratch.data(), k),
+                                 opt_.vote_min_c);
+
+    for (size_t z = 0; z < n_; ++z) {
+      if (!fresh[z]) continue;
+      disagree[z] = std::fabs(value[z] - med) > band;
+      if (disagree[z]) strikes_[z] = std::min(strikes_[z] + 1, opt_.vote_frames);
+      else             strikes_[z] = std::max(strikes_[z] - 1, 0);
+      if (strikes_[z] >= opt_.vote_frames) out_[z] = true;
+      else if (strikes_[z] == 0)           out_[z] = false;
+    }
+  }
+
+  // A zone that disagrees now stays out of this frame's estimate even
+  // before it is voted out, so a glitch never reaches the controller
+  for (size_t z = 0; z < n_; ++z) out_now[z] = out_[z] || disagree[z];
+
+  // Fresh zones if there are any left after the vote, held values otherwise
+  bool use_stale = true;
+  for (size_t z = 0; z < n_; ++z)
+    if (fresh[z] && !out_now[z]) use_stale = false;
+
+  Result r;
+  r.zones = static_cast<int>(n_);
+  r.stale = use_stale;
+  double sum = 0.0, wsum = 0.0;
+  for (size_t z = 0; z < n_; ++z) {
+    if (out_[z]) r.voted_out |= 1u << z;
+    if (!have[z] || (!use_stale && !fresh[z])) continue;
+
+    // Uniformity counts the zones the vote leaves out: a cold corner is
+    // exactly what it is there to show
+    const double v = value[z];
+    if (!(v <= r.hottest_c)) { r.hottest_c = v; r.hottest_ch = zones_[z].channel; }
+    if (!(v >= r.coldest_c)) { r.coldest_c = v; r.coldest_ch = zones_[z].channel; }
+    if (out_now[z]) continue;
+
+    sum  += zones_[z].weight * v;
+    wsum += zones_[z].weight;
+    ++r.zones_used;
+  }
+  if (wsum > 0) r.air_c = sum / wsum;
+  if (!std::isnan(r.hottest_c)) r.spread_c = r.hottest_c - r.coldest_c;
+
+  res_ = r;
+  return res_;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "SampleFrame.h"
+
+// One chamber thermocouple taking part in the air estimate
+struct AirZone {
+  int    channel{1};     // THKA channel id
+  double weight{1.0};    // in the weighted mean
+};
+
+/**
+ * Robust chamber air temperature from several zone thermocouples.
+ *
+ * Per frame: the median of the fresh zones sets the reference. A zone
+ * further than max(vote_k·1.4826·MAD, vote_min_c) from it collects a
+ * strike and is left out of that frame's estimate. After vote_frames
+ * strikes it is voted out, and it is readmitted only after the same number
+ * of agreeing frames. Voting needs three fresh zones, because with two
+ * there is no majority; exclusions are held meanwhile.
+ *
+ * The estimate is the weighted mean of the fresh zones that are neither
+ * voted out nor disagreeing. If none is left, held (stale) values are used
+ * instead, and NaN only when no zone has a reading at all. A failed or
+ * drifting thermocouple therefore costs one zone, not the oven.
+ *
+ * Uniformity (spread, hottest and coldest zone) covers every zone the
+ * estimate could draw on (fresh, or held when it falls back to those),
+ * voted out or not, so a zone the vote ignores still shows as
+ * non-uniformity.
+ *
+ * No allocation after configure(). Not thread-safe; StateMachine owns it.
+ */
+class AirFusion {
+public:
+  static constexpr size_t kMaxZones = SampleFrame::kMaxChannels;
+
+  struct Options {
+    double vote_k{4.0};          // MADs (σ-scaled) from the median
+    double vote_min_c{15.0};     // ... but never closer than this: zones differ
+    int    vote_frames{10};      // strikes to vote a zone out / back in
+  };
+
+  struct Result {
+    double   air_c{std::numeric_limits<double>::quiet_NaN()};
+    double   spread_c{std::numeric_limits<double>::quiet_NaN()};   // hottest - coldest
+    int      hottest_ch{0};
+    double   hottest_c{std::numeric_limits<double>::quiet_NaN()};
+    int      coldest_ch{0};
+    double   coldest_c{std::numeric_limits<double>::quiet_NaN()};
+    int      zones{0};           // configured
+    int      zones_used{0};      // in the estimate
+    uint32_t voted_out{0};       // bit i: zone i (configure() order)
+    bool     stale{false};       // estimate from held values only
+
+    bool degraded() const { return zones_used < zones; }
+  };
+
+  void configure(const std::vector<AirZone>& zones, const Options& opt);
+  void configure(const std::vector<AirZone>& zones) { configure(zones, Options{}); }
+
+  // Forget the votes (e.g. after a thermocouple is replaced)
+  void reset();
+
+  // One frame; call once per new frame
+  const Result& update(const SampleFrame& f);
+
+  const Result& result() const { return res_; }
+  size_t zones() const { return n_; }
+  int    channel(size_t zone) const { return zone < n_ ? zones_[zone].channel : 0; }
+
+private:
+  Options                          opt_{};
+  std::array<AirZone, kMaxZones>   zones_{};
+  std::array<int, kMaxZones>       strikes_{};
+  std::array<bool, kMaxZones>      out_{};
+  size_t                           n_{0};
+  Result                           res_{};
+};
@@ -0,0 +1,126 @@
+#include "BusScheduler.h"
+#include "Diagnostics.h"
+
+namespace {
+
+// A read may go this fraction of its period early, so timer jitter does
+// not push it a whole cycle late
+constexpr double kEarly = 0.1;
+
+double seconds(BusScheduler::Clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+} // namespace
+
+void BusScheduler::configure(const std::vector<Read>& reads, const Options& opt) {
+  opt_ = opt;
+  reads_.clear();
+  for (const auto& r : reads) {
+    Slot s;
+    s.cfg    = r;
+    s.cost_s = opt.initial_rtt_s;
+    reads_.push_back(s);
+  }
+  write_cost_s_ = opt.initial_rtt_s;
+  stats_ = {};
+}
+
+const char* BusScheduler::className(Class c) {
+  switch (c) {
+    case Class::Critical:   return "critical";
+    case Class::Write:      return "write";
+    case Class::Background: return "background";
+  }
+  return "?";
+}
+
+void BusScheduler::begin_cycle(Clock::time_point now, bool verify, bool send,
+                               Clock::time_point oldest_write) {
+  used_s_        = 0.0;
+  verify_        = verify;
+  send_          = send;
+  write_overdue_ = (verify || send) && oldest_write != Clock::time_point{} &&
+                   seconds(now - oldest_write) >= opt_.write_max_wait_s;
+  for (auto& s : reads_) s.tried = false;
+}
+
+bool BusScheduler::due(const Slot& s, Clock::time_point now) const {
+  if (s.tried) return false;
+  if (s.last_try == Clock::time_point{}) return true;
+  return seconds(now - s.last_try) >= s.cfg.period_s * (1.0 - kEarly);
+}
+
+BusScheduler::Action BusScheduler::next(Clock::time_point now) {
+  // Critical reads whenever due, the nearest deadline first (never read
+  // counts as nearest)
+  int pick = -1;
+  for (size_t i = 0; i < reads_.size(); ++i) {
+    const Slot& s = reads_[i];
+    if (s.cfg.cls != Class::Critical || !due(s, now)) continue;
+    if (pick < 0 || s.last_ok < reads_[pick].last_ok) pick = static_cast<int>(i);
+  }
+  if (pick >= 0) return {Action::Kind::Read, static_cast<size_t>(pick)};
+
+  // Setpoints: read-back of the last batch, then the new one
+  if (verify_ && (write_overdue_ || fits(write_cost_s_))) {
+    verify_ = false;
+    return {Action::Kind::Verify, 0};
+  }
+  if (send_ && (write_overdue_ || fits(write_cost_s_))) {
+    send_ = false;
+    return {Action::Kind::Send, 0};
+  }
+
+  // Background reads in what is left, the most overdue (in periods) first
+  double worst = -1.0;
+  for (size_t i = 0; i < reads_.size(); ++i) {
+    const Slot& s = reads_[i];
+    if (s.cfg.cls == Class::Critical || !due(s, now) || !fits(s.cost_s)) continue;
+    const double late = s.last_try == Clock::time_point{}
+                          ? 1e9 : seconds(now - s.last_try) / s.cfg.period_s;
+    if (late > worst) {
+      worst = late;
+      pick  = static_cast<int>(i);
+    }
+  }
+  if (pick >= 0) return {Action::Kind::Read, static_cast<size_t>(pick)};
+  return {};
+}
+
+void BusScheduler::done(const Action& a, Clock::time_point start, Clock::time_point end, bool ok) {
+  const double bus_s = seconds(end - start);
+  used_s_ += bus_s;
+
+  if (a.kind == Action::Kind::Verify || a.kind == Action::Kind::Send) {
+    write_cost_s_ += opt_.rtt_alpha * (bus_s - write_cost_s_);
+    count(Class::Write, bus_s, ok, false);
+    return;
+  }
+  if (a.kind != Action::Kind::Read || a.read >= reads_.size()) return;
+
+  Slot& s = reads_[a.read];
+  s.tried    = true;
+  s.last_try = start;
+  s.cost_s  += opt_.rtt_alpha * (bus_s - s.cost_s);
+
+  const bool missed = s.cfg.cls == Class::Critical && s.last_ok != Clock::time_point{} &&
+                      seconds(end - s.last_ok) > s.cfg.deadline_s;
+  if (ok) s.last_ok = end;
+  count(s.cfg.cls, bus_s, ok, missed);
+}
+
+void BusScheduler::count(Class c, double bus_s, bool ok, bool missed) {
+  Stats& st = stats_[static_cast<size_t>(c)];
+  ++st.transactions;
+  st.failures         += !ok;
+  st.missed_deadlines += missed;
+  st.bus_s            += bus_s;
+
+  if (!diag_) return;
+  Diagnostics::BusCounters& d = diag_->bus[static_cast<size_t>(c)];
+  ++d.transactions;
+  d.failures         += !ok;
+  d.missed_deadlines += missed;
+  d.bus_us           += static_cast<uint64_t>(bus_s * 1e6);
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Diagnostics;
+
+/**
+ * Picks the next Modbus transaction on the THKA link, one poll cycle at a
+ * time.
+ *
+ * Three classes share the bus. Critical reads (the spans carrying the
+ * channels control depends on) run first whenever they are due, budget or
+ * not, and are held to a deadline: a read that lands, or fails, more than
+ * deadline_s after the last good one counts as missed. Setpoint writes
+ * come next: one read-back and one send of the coalesced batch per cycle,
+ * within the cycle's bus budget, or regardless once the oldest has waited
+ * write_max_wait_s. Background reads fill what is left, most overdue
+ * first.
+ *
+ * Transaction costs are a moving average of measured bus time per read,
+ * and one for writes, so the budget follows the real link.
+ *
+ * Not thread-safe: the poller owns it.
+ */
+class BusScheduler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Class : uint8_t { Critical, Write, Background };
+  static constexpr size_t kClasses = 3;
+
+  struct Options {
+    double budget_s{0.08};          // bus time per cycle for writes and background
+    double write_max_wait_s{1.0};   // a write older than this goes out over budget
+    double rtt_alpha{0.2};          // EWMA weight of the latest transaction
+    double initial_rtt_s{0.03};     // cost estimate before the first measurement
+  };
+
+  // One periodic read (a register span)
+  struct Read {
+    Class  cls{Class::Background};
+    double period_s{0.1};
+    double deadline_s{0.3};        // Critical only
+  };
+
+  struct Action {
+    enum class Kind : uint8_t { None, Read, Verify, Send } kind{Kind::None};
+    size_t read{0};                // Kind::Read: index into configure()'s reads
+  };
+
+  struct Stats {
+    uint64_t transactions{0};
+    uint64_t failures{0};
+    uint64_t missed_deadlines{0};
+    double   bus_s{0.0};
+  };
+
+  void configure(const std::vector<Read>& reads, const Options& opt);
+  void configure(const std::vector<Read>& reads) { configure(reads, Options{}); }
+
+  // Records into diag's bus counters too (not owned, may be null)
+  void set_diagnostics(Diagnostics* diag) { diag_ = diag; }
+
+  size_t reads() const { return reads_.size(); }
+  const Read& read(size_t i) const { return reads_[i].cfg; }
+
+  // Change a read's period (0 = every cycle) and deadline, or the
+  // per-cycle budget, between cycles; measured costs carry on
+  void set_period(size_t i, double period_s, double deadline_s) {
+    reads_[i].cfg.period_s   = period_s;
+    reads_[i].cfg.deadline_s = deadline_s;
+  }
+  void set_budget(double budget_s) { opt_.budget_s = budget_s; }
+
+  // Start a cycle. verify: writes sent in an earlier cycle await read-back;
+  // send: writes are queued; oldest_write: when the oldest of them was queued
+  void begin_cycle(Clock::time_point now, bool verify, bool send,
+                   Clock::time_point oldest_write = {});
+
+  // Next transaction of this cycle; Kind::None when the cycle is done
+  Action next(Clock::time_point now);
+
+  // How the transaction returned by next() went
+  void done(const Action& a, Clock::time_point start, Clock::time_point end, bool ok);
+
+  const Stats& stats(Class c) const { return stats_[static_cast<size_t>(c)]; }
+  static const char* className(Class c);
+
+private:
+  struct Slot {
+    Read              cfg{};
+    Clock::time_point last_try{};     // last attempt, good or not
+    Clock::time_point last_ok{};
+    double            cost_s{0.0};    // EWMA bus time
+    bool              tried{false};   // this cycle
+  };
+
+  bool due(const Slot& s, Clock::time_point now) const;
+  bool fits(double cost_s) const { return used_s_ + cost_s <= opt_.budget_s; }
+  void count(Class c, double bus_s, bool ok, bool missed);
+
+  Options                        opt_{};
+  std::vector<Slot>              reads_;
+  double                         write_cost_s_{0.0};
+  std::array<Stats, kClasses>    stats_{};
+  Diagnostics*                   diag_{nullptr};
+
+  // This cycle
+  double                         used_s_{0.0};
+  bool                           verify_{false};
+  bool                           send_{false};
+  bool                           write_overdue_{false};
+};
@@ -0,0 +1,112 @@
+#include "ControlExecutor.h"
+#include "Diagnostics.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+namespace {
+
+constexpr long kNsPerSec = 1000000000L;
+
+void add_ns(timespec& t, long ns) {
+  t.tv_nsec += ns;
+  while (t.tv_nsec >= kNsPerSec) {
+    t.tv_nsec -= kNsPerSec;
+    ++t.tv_sec;
+  }
+}
+
+bool before(const timespec& a, const timespec& b) {
+  return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
+} // namespace
+
+ControlExecutor::ControlExecutor(StateMachine& sm, Options opt)
+  : sm_(sm), opt_(opt)
+{
+  status_.store(sm_.status());
+}
+
+ControlExecutor::~ControlExecutor() {
+  stop();
+}
+
+void ControlExecutor::start() {
+  if (running()) return;
+  run_.store(true, std::memory_order_release);
+  thread_ = std::thread(&ControlExecutor::run, this);
+
+  // From here rather than the thread, so realtime() is settled on return
+  if (opt_.rt_priority > 0) {
+    sched_param sp{};
+    sp.sched_priority = opt_.rt_priority;
+    const int rc = pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &sp);
+    if (rc == 0) {
+      realtime_.store(true, std::memory_order_release);
+    } else {
+      std::cerr << "[Control] SCHED_FIFO priority " << opt_.rt_priority
+                << " refused (" << std::strerror(rc) << "), running with normal scheduling"
+                << std::endl;
+    }
+  }
+}
+
+void ControlExecutor::stop() {
+  run_.store(false, std::memory_order_release);
+  if (thread_.joinable()) thread_.join();
+}
+
+void ControlExecutor::post(Command cmd) {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  queue_.push_back(std::move(cmd));
+}
+
+void ControlExecutor::drainCommands() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    draining_.swap(queue_);
+  }
+  for (auto& cmd : draining_) cmd(sm_);
+  draining_.clear();
+}
+
+void ControlExecutor::run() {
+  const long period_ns =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(opt_.period).count();
+
+  timespec next{};
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while (run_.load(std::memory_order_acquire)) {
+    drainCommands();
+    sm_.tick(std::chrono::steady_clock::now());
+    status_.store(sm_.status());
+
+    add_ns(next, period_ns);
+
+    // Overran by more than a period: skip the missed ticks instead of
+    // firing them back to back.
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (before(next, now)) {
+      next = now;
+      add_ns(next, period_ns);
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr) == EINTR) {}
+
+    if (opt_.diag) {
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      const long late_ns = (now.tv_sec - next.tv_sec) * kNsPerSec + (now.tv_nsec - next.tv_nsec);
+      opt_.diag->tick_jitter.record(std::chrono::nanoseconds(late_ns));
+    }
+  }
+
+  // Commands posted while stopping still run, e.g. a final cancel
+  drainCommands();
+  status_.store(sm_.status());
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "StateMachine.h"
+#include "SeqLock.h"
+
+class Diagnostics;
+
+/**
+ * Runs StateMachine::tick() on a dedicated thread.
+ *
+ * The loop sleeps with clock_nanosleep() to absolute CLOCK_MONOTONIC
+ * deadlines, so the tick period does not drift with tick duration, and can
+ * run under SCHED_FIFO. Once started, the StateMachine belongs to this
+ * thread: other threads talk to it only through post() and read it only
+ * through status().
+ */
+class ControlExecutor {
+public:
+  using Command = std::function<void(StateMachine&)>;
+
+  struct Options {
+    std::chrono::milliseconds period{50};
+    int rt_priority{0};    // 1..99 = SCHED_FIFO priority, 0 = normal scheduling
+    Diagnostics* diag{nullptr};  // records wake-up lateness as tick jitter
+  };
+
+  ControlExecutor(StateMachine& sm, Options opt);
+  ~ControlExecutor();
+
+  ControlExecutor(const ControlExecutor&) = delete;
+  ControlExecutor& operator=(const ControlExecutor&) = delete;
+
+  void start();
+  void stop();
+  bool running() const { return run_.load(std::memory_order_acquire); }
+
+  // Queue a command; it runs on the control thread before the next tick.
+  void post(Command cmd);
+
+  // Snapshot published after every tick
+  ControlStatus status() const { return status_.load(); }
+
+  // True if SCHED_FIFO was requested and granted (known once start() returns)
+  bool realtime() const { return realtime_.load(std::memory_order_acquire); }
+  int rt_priority() const { return realtime() ? opt_.rt_priority : 0; }
+
+private:
+  void run();
+  void drainCommands();
+
+  StateMachine& sm_;
+  Options       opt_;
+
+  std::thread       thread_;
+  std::atomic<bool> run_{false};
+  std::atomic<bool> realtime_{false};
+
+  std::mutex           queue_mutex_;
+  std::vector<Command> queue_;
+  std::vector<Command> draining_;   // swapped with queue_, used by the control thread only
+
+  SeqLock<ControlStatus> status_;
+};
@@ -0,0 +1,70 @@
+#include "CureIntegrator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kGasConstant = 8.314462618;   // J/(mol·K)
+constexpr double kZeroC       = 273.15;
+
+} // namespace
+
+// ---- CureProfile ----
+
+CureProfile CureProfile::arrhenius(double ref_c, double ref_s, double band_c, double ea_j_mol) {
+  CureProfile p;
+  p.ref_c    = ref_c;
+  p.ref_s    = ref_s;
+  p.ea_j_mol = ea_j_mol;
+  p.min_c    = ref_c - band_c;
+  p.max_c    = ref_c + band_c;
+  return p;
+}
+
+double CureProfile::rate_per_s(double temp_c) const {
+  if (std::isnan(temp_c)) return 0.0;
+
+  if (!table.empty()) {
+    if (temp_c < table.front().temp_c) return 0.0;
+    if (temp_c >= table.back().temp_c) return 1.0 / table.back().cure_s;
+
+    const auto hi = std::upper_bound(table.begin(), table.end(), temp_c,
+                                     [](double t, const Point& p) { return t < p.temp_c; });
+    const auto lo = hi - 1;
+    const double f = (temp_c - lo->temp_c) / (hi->temp_c - lo->temp_c);
+    const double log_s = std::log(lo->cure_s) + f * (std::log(hi->cure_s) - std::log(lo->cure_s));
+    return 1.0 / std::exp(log_s);
+  }
+
+  if (temp_c < min_c || ref_s <= 0) return 0.0;
+  const double t_k   = std::min(temp_c, max_c) + kZeroC;
+  const double ref_k = ref_c + kZeroC;
+  return std::exp(-ea_j_mol / kGasConstant * (1.0 / t_k - 1.0 / ref_k)) / ref_s;
+}
+
+// ---- CureIntegrator ----
+
+void CureIntegrator::start(const CureProfile& profile) {
+  profile_  = profile;
+  running_  = true;
+  progress_ = 0.0;
+  rate_     = 0.0;
+  last_     = {};
+}
+
+void CureIntegrator::add(double part_c, Clock::time_point t) {
+  if (!running_ || std::isnan(part_c)) return;
+
+  const double rate = profile_.rate_per_s(part_c);
+  if (last_ != Clock::time_point{}) {
+    const double dt = std::chrono::duration<double>(t - last_).count();
+    if (dt > 0 && dt <= kMaxGapS) progress_ += 0.5 * (rate_ + rate) * dt;
+  }
+  rate_ = rate;
+  last_ = t;
+}
+
+double CureIntegrator::remaining_s() const {
+  if (!running_ || rate_ <= 0) return std::numeric_limits<double>::quiet_NaN();
+  return std::max(0.0, 1.0 - progress_) / rate_;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <limits>
+#include <vector>
+
+/**
+ * How fast a powder cures at a given part temperature.
+ *
+ * Either Arrhenius scaling around one datasheet point (ref_s at ref_c,
+ * activation energy ea_j_mol), or a datasheet schedule table of
+ * {temperature, seconds to full cure}, interpolated log-linearly. No cure
+ * is counted below min_c; above max_c (or the hottest table row) the rate
+ * is held there, so an overshooting part is never credited beyond what the
+ * datasheet covers.
+ */
+struct CureProfile {
+  struct Point {
+    double temp_c;
+    double cure_s;
+  };
+
+  double ref_c{200.0};
+  double ref_s{12 * 60.0};
+  double ea_j_mol{62000.0};    // ~2x time per 20 °C lower, typical for polyester/epoxy powders
+  double min_c{185.0};
+  double max_c{215.0};
+  std::vector<Point> table;    // ascending temp_c; used instead of Arrhenius when not empty
+
+  // Fraction of a full cure per second at temp_c
+  double rate_per_s(double temp_c) const;
+
+  // Arrhenius profile for one datasheet point, counted within ±band_c
+  static CureProfile arrhenius(double ref_c, double ref_s, double band_c,
+                               double ea_j_mol = 62000.0);
+};
+
+/**
+ * Cure equivalence: ∫ rate(T(t)) dt, complete at 1.0.
+ *
+ * Fed one part temperature per new sample. Trapezoidal between samples;
+ * a gap longer than max_gap_s (lost readings) adds nothing, so missing
+ * data never counts as cure. Progress is never reset by a cold reading,
+ * it only stops growing.
+ */
+class CureIntegrator {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr double kMaxGapS = 5.0;
+
+  void start(const CureProfile& profile);
+  void stop() { running_ = false; }
+
+  void add(double part_c, Clock::time_point t);
+
+  bool   running()  const { return running_; }
+  bool   done()     const { return progress_ >= 1.0; }
+  double progress() const { return progress_; }       // 0..1 (may pass 1 on the last sample)
+  double rate_per_s() const { return rate_; }         // at the latest sample
+
+  // Seconds to completion at the latest rate; NaN if not curing
+  double remaining_s() const;
+
+  const CureProfile& profile() const { return profile_; }
+
+private:
+  CureProfile       profile_{};
+  bool              running_{false};
+  double            progress_{0.0};
+  double            rate_{0.0};
+  Clock::time_point last_{};
+};
@@ -0,0 +1,95 @@
+#include "Diagnostics.h"
+#include "BusScheduler.h"
+#include <fstream>
+#include <iomanip>
+
+LatencyHistogram* Diagnostics::rtt(const char* kind, uint16_t reg) {
+  const std::string name = std::string("modbus ") + kind + " " + std::to_string(reg);
+
+  std::lock_guard<std::mutex> lock(rtt_mutex_);
+  for (auto& r : rtt_)
+    if (r.name == name) return &r.hist;
+  rtt_.emplace_back();
+  rtt_.back().name = name;
+  return &rtt_.back().hist;
+}
+
+std::vector<Diagnostics::Row> Diagnostics::rows() const {
+  std::vector<Row> out;
+  out.push_back({"poll duration", poll_duration.snapshot()});
+  out.push_back({"tick jitter",   tick_jitter.snapshot()});
+  out.push_back({"sample age",    sample_age.snapshot()});
+  out.push_back({"write latency", write_latency.snapshot()});
+
+  std::lock_guard<std::mutex> lock(rtt_mutex_);
+  for (const auto& r : rtt_)
+    out.push_back({r.name, r.hist.snapshot()});
+  return out;
+}
+
+void Diagnostics::write(std::ostream& os) const {
+  auto ms = [](uint64_t us) { return us / 1000.0; };
+
+  os << std::left << std::setw(24) << "# path" << std::right
+     << std::setw(10) << "count"
+     << std::setw(10) << "mean_ms"
+     << std::setw(10) << "p50_ms"
+     << std::setw(10) << "p90_ms"
+     << std::setw(10) << "p99_ms"
+     << std::setw(10) << "p99.9_ms"
+     << std::setw(10) << "max_ms" << "\n";
+
+  os << std::fixed << std::setprecision(2);
+  for (const auto& r : rows()) {
+    const auto& s = r.snap;
+    os << std::left << std::setw(24) << r.name << std::right
+       << std::setw(10) << s.total
+       << std::setw(10) << s.mean_us() / 1000.0
+       << std::setw(10) << ms(s.percentile_us(0.50))
+       << std::setw(10) << ms(s.percentile_us(0.90))
+       << std::setw(10) << ms(s.percentile_us(0.99))
+       << std::setw(10) << ms(s.percentile_us(0.999))
+       << std::setw(10) << ms(s.max_us) << "\n";
+  }
+
+  os << "# writes queued "  << writes_queued.load()
+     << " completed "       << writes_completed.load()
+     << " failed "          << writes_failed.load() << "\n";
+  os << "# samples rejected " << samples_rejected.load() << "\n";
+  os << "# breaker trips " << breaker_trips.load() << "\n";
+
+  for (size_t c = 0; c < kBusClasses; ++c) {
+    os << "# bus " << BusScheduler::className(static_cast<BusScheduler::Class>(c)) << " " << bus[c].transactions.load()
+       << " transactions, " << bus[c].failures.load() << " failed, "
+       << bus[c].missed_deadlines.load() << " missed deadlines, "
+       << bus[c].bus_us.load() / 1000.0 << " ms\n";
+  }
+}
+
+bool Diagnostics::dump(const std::string& path) const {
+  std::ofstream f(path);
+  if (!f) return false;
+  write(f);
+  return static_cast<bool>(f);
+}
+
+void Diagnostics::reset() {
+  poll_duration.reset();
+  tick_jitter.reset();
+  sample_age.reset();
+  write_latency.reset();
+  writes_queued = 0;
+  writes_completed = 0;
+  writes_failed = 0;
+  samples_rejected = 0;
+  breaker_trips    = 0;
+  for (auto& b : bus) {
+    b.transactions     = 0;
+    b.failures         = 0;
+    b.missed_deadlines = 0;
+    b.bus_us           = 0;
+  }
+
+  std::lock_guard<std::mutex> lock(rtt_mutex_);
+  for (auto& r : rtt_) r.hist.reset();
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "LatencyHistogram.h"
+
+/**
+ * Latency instrumentation for the bus and control paths.
+ *
+ * One instance lives in main() and is handed to the components that record
+ * into it (ThkaRs485Temp, ThkaPoller, StateMachine, the tick driver). All
+ * recording is lock-free; rows() and write() are for the diagnostics page
+ * and dumps.
+ */
+class Diagnostics {
+public:
+  LatencyHistogram poll_duration;   // ThkaPoller: one full read_frame()
+  LatencyHistogram tick_jitter;     // control tick lateness against its period
+  LatencyHistogram sample_age;      // frame age when StateMachine::tick() uses it
+  LatencyHistogram write_latency;   // setpoint write: queued -> completed
+
+  std::atomic<uint64_t> writes_queued{0};
+  std::atomic<uint64_t> writes_completed{0};
+  std::atomic<uint64_t> writes_failed{0};
+  std::atomic<uint64_t> samples_rejected{0};   // FilterBank outliers, all channels
+  std::atomic<uint64_t> breaker_trips{0};      // THKA stopped answering (circuit breaker opened)
+
+  // THKA bus use per BusScheduler class: critical reads, setpoint writes,
+  // background reads
+  struct BusCounters {
+    std::atomic<uint64_t> transactions{0};
+    std::atomic<uint64_t> failures{0};
+    std::atomic<uint64_t> missed_deadlines{0};
+    std::atomic<uint64_t> bus_us{0};
+  };
+  static constexpr size_t kBusClasses = 3;   // BusScheduler::kClasses
+  std::array<BusCounters, kBusClasses> bus;
+
+  // Round-trip histogram for one Modbus transaction type, e.g. ("read", 768)
+  // for the span starting at register 768. Created on first use and kept
+  // for the process lifetime, so callers may cache the pointer.
+  LatencyHistogram* rtt(const char* kind, uint16_t reg);
+
+  struct Row {
+    std::string name;
+    LatencyHistogram::Snapshot snap;
+  };
+  std::vector<Row> rows() const;
+
+  // Human-readable table: one line per histogram plus the write counters
+  void write(std::ostream& os) const;
+  bool dump(const std::string& path) const;
+
+  void reset();
+
+private:
+  struct Rtt {
+    std::string      name;
+    LatencyHistogram hist;
+  };
+
+  mutable std::mutex rtt_mutex_;   // guards the list, not the histograms
+  std::deque<Rtt>    rtt_;         // deque: element addresses stay valid
+};
@@ -1,9 +1,26 @@
 #pragma once
 #include <chrono>
+#include <cstddef>
 
 enum class State { Idle, Warming, Ready, Curing, Shutdown, Fault, AutoCureComplete };
 
-enum class OperatingMode { Manual, Auto };
+enum class OperatingMode { Manual, Auto, Autotune };
+
+inline const char* stateName(State s) {
+  switch (s) {
+    case State::Idle:             return "Idle";
+    case State::Warming:          return "Warming";
+    case State::Ready:            return "Ready";
+    case State::Curing:           return "Curing";
+    case State::Shutdown:         return "Shutdown";
+    case State::Fault:            return "Fault";
+    case State::AutoCureComplete: return "AutoCureComplete";
+  }
+  return "Unknown";
+}
+
+// Part zones: rack positions, each watched by its own IR channel
+constexpr size_t kMaxPartZones = 4;
 
 struct Params {
   double air_target_c      = 200.0;
@@ -19,8 +36,53 @@ struct Params {
 
   // Oven must be hot enough (IR baseline) before we trust a drop as a "part insert".
   double part_min_valid_c  = 100.0;  // wall is hot → drop is meaningful
+
+  // ...and the drop must be beyond what the IR noise explains, on
+  // part_confirm_samples readings in a row (see PartEstimator)
+  double part_ir_noise_c            = 0.5;   // 1σ, floor for the measured noise
+  double part_false_alarms_per_hour = 0.01;
+  int    part_confirm_samples       = 3;
+
+  // Part zones (setPartZones): once the first part of a load is detected,
+  // the other zones keep looking for theirs this long; a zone still empty
+  // after that is left out of the load
+  double part_zone_load_window_s    = 120.0;
+  
+  // Air zones (AirFusion): a zone further than this from the zone median,
+  // for this many frames in a row, is voted out of the air estimate
+  double air_zone_vote_c      = 15.0;
+  int    air_zone_vote_frames = 10;
   
   // Auto mode parameters
   double auto_target_temp_tolerance_c = 15.0;  // ±10°C tolerance for auto mode
   int    auto_cure_duration_seconds   = 12 * 60; // 5 minutes cure time
+
+  // Auto cure ends on cure equivalence, not a timer: the default profile
+  // is auto_cure_duration_seconds at the target, Arrhenius-scaled with
+  // this activation energy within the tolerance band (see CureProfile)
+  double cure_ea_j_mol = 62000.0;
+
+  // Scheduled pre-heat (command_schedulePreheat): start this long before
+  // the learnt warm-up ETA says it must, or preheat_fallback_s before the
+  // deadline while the heat-up model is still learning
+  double preheat_margin_s   = 300.0;
+  double preheat_fallback_s = 3600.0;
+
+  // Heat control: PID on the air channel, time-proportioned onto the
+  // contactor in Warming / Ready / Curing. false = contactor simply on.
+  bool   pid_enabled      = true;
+  double pid_kp           = 0.06;    // duty per °C of error
+  double pid_ki           = 0.002;   // duty per °C·s
+  double pid_kd           = 0.5;     // duty per °C/s
+  double pid_d_filter_s   = 8.0;     // derivative low-pass time constant
+  double pid_window_s     = 10.0;    // time-proportioning window
+  double pid_min_switch_s = 0.5;     // shortest contactor pulse / gap
+
+  // Optional cascade: once a part is detected in Curing, a slow outer loop
+  // on the part temperature raises the air setpoint above part_target_c
+  // by up to cascade_max_boost_c to bring the part up faster.
+  bool   pid_cascade         = false;
+  double cascade_kp          = 1.0;    // °C of air per °C of part error
+  double cascade_ki          = 0.002;  // per second
+  double cascade_max_boost_c = 25.0;
 };
\ No newline at end of file
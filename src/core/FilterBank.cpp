@@ -0,0 +1,181 @@
+#include "FilterBank.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr size_t kLanes    = 4;         // widest double vector we expect (AVX2)
+constexpr double kMadSigma = 1.4826;    // MAD -> σ for Gaussian noise
+constexpr double kMinAgeS  = 1e-3;      // two readings with the same timestamp
+constexpr double kInf      = std::numeric_limits<double>::infinity();
+
+// Written as selects, not std::min/max, so they vectorise to min/max
+// instructions without -ffast-math
+inline double vmin(double a, double b) { return a < b ? a : b; }
+inline double vmax(double a, double b) { return a > b ? a : b; }
+
+inline double med3(double a, double b, double c) {
+  return vmax(vmin(a, b), vmin(vmax(a, b), c));
+}
+
+inline double med5(double a, double b, double c, double d, double e) {
+  return med3(e, vmax(vmin(a, b), vmin(c, d)), vmin(vmax(a, b), vmax(c, d)));
+}
+
+// The kernels below take every array as a __restrict parameter: with more
+// than a handful of pointers GCC gives up on runtime alias checks and
+// leaves the loop scalar. Masks are 0.0 / 1.0, every load is unconditional
+// and every select picks between values already computed, so each loop
+// if-converts (GCC will not speculate a guarded load or division).
+
+// Calibrate; only fresh, finite readings advance a channel
+void calibrate(const double* __restrict value, const uint8_t* __restrict quality,
+               const double* __restrict gain, const double* __restrict offset,
+               double* __restrict x, double* __restrict ok, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    const double v = value[i] * gain[i] + offset[i];
+    x[i]  = v;
+    ok[i] = (quality[i] == kSampleOk) & (v == v) ? 1.0 : 0.0;
+  }
+}
+
+// Push accepted readings into the history; the first reading of a
+// channel (ok > primed) fills all of it and the output
+void push(double* __restrict hist, size_t stride, int taps,
+          const double* __restrict x, const double* __restrict ok,
+          double* __restrict y, double* __restrict primed, double* __restrict age,
+          double dt, size_t n) {
+  for (int k = taps - 1; k > 0; --k) {
+    double* __restrict dst       = hist + k * stride;
+    const double* __restrict src = hist + (k - 1) * stride;
+    for (size_t i = 0; i < n; ++i) {
+      const double d = dst[i], s = src[i], v = x[i], o = ok[i], p = primed[i];
+      const double shifted = o != 0.0 ? s : d;
+      dst[i] = o > p ? v : shifted;
+    }
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const double d = hist[i], v = x[i], o = ok[i], p = primed[i], yi = y[i];
+    hist[i]   = o != 0.0 ? v : d;
+    y[i]      = o > p ? v : yi;
+    primed[i] = vmax(p, o);
+    age[i]   += dt;
+  }
+}
+
+// Hampel, median, low-pass and slew limit
+void filter(const double* __restrict hist, size_t stride,
+            const double* __restrict hampel_k, const double* __restrict hampel_min,
+            const double* __restrict med3_on, const double* __restrict med5_on,
+            const double* __restrict tau, const double* __restrict rate,
+            const double* __restrict x, const double* __restrict ok,
+            double* __restrict y, double* __restrict age, double* __restrict reject,
+            size_t n) {
+  const double* __restrict h0 = hist;
+  const double* __restrict h1 = hist + stride;
+  const double* __restrict h2 = hist + 2 * stride;
+  const double* __restrict h3 = hist + 3 * stride;
+  const double* __restrict h4 = hist + 4 * stride;
+  for (size_t i = 0; i < n; ++i) {
+    const double a0 = h0[i], a1 = h1[i], a2 = h2[i], a3 = h3[i], a4 = h4[i];
+    const double v = x[i], o = ok[i], yi = y[i], ai = age[i];
+    const double k = hampel_k[i], kmin = hampel_min[i], u3 = med3_on[i], u5 = med5_on[i];
+    const double ti = tau[i], ri = rate[i];
+
+    const double m5  = med5(a0, a1, a2, a3, a4);
+    const double m3  = med3(a0, a1, a2);
+    const double mad = med5(std::fabs(a0 - m5), std::fabs(a1 - m5), std::fabs(a2 - m5),
+                            std::fabs(a3 - m5), std::fabs(a4 - m5));
+    const double band = vmax(k * mad, kmin);
+    const double thr  = o != 0.0 ? band : kInf;
+    const bool   out  = std::fabs(v - m5) > thr;
+    reject[i] = out ? 1.0 : 0.0;
+
+    const double xh = out ? m5 : v;
+    const double xs = u3 != 0.0 ? m3 : xh;
+    const double xm = u5 != 0.0 ? m5 : xs;
+    const double xe = o != 0.0 ? xm : yi;    // no reading: no step
+
+    const double a     = vmax(ai, kMinAgeS);
+    const double alpha = a / (ti + a);
+    const double lim   = ri * a;
+    y[i]   = yi + vmax(-lim, vmin(lim, alpha * (xe - yi)));
+    age[i] = o != 0.0 ? 0.0 : ai;
+  }
+}
+
+// Primed channels report the filter output, stale ones included; the
+// rejected flag is ours, so one left over from an earlier poll is cleared
+void publish(double* __restrict value, uint8_t* __restrict quality,
+             const double* __restrict y, const double* __restrict primed,
+             const double* __restrict reject, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    const double v = value[i], yi = y[i], r = reject[i];
+    const uint8_t q = static_cast<uint8_t>(quality[i] & ~kSampleRejected);
+    value[i]   = primed[i] != 0.0 ? yi : v;
+    quality[i] = r != 0.0 ? static_cast<uint8_t>(q | kSampleRejected) : q;
+  }
+}
+
+} // namespace
+
+void FilterBank::configure(const std::vector<ChannelFilter>& channels) {
+  n_      = channels.size();
+  stride_ = (n_ + kLanes - 1) / kLanes * kLanes;
+
+  // Padding lanes pass through and are never read back
+  cfg_.assign(kRows * stride_, 0.0);
+  auto row = [&](Row r) { return cfg_.begin() + static_cast<std::ptrdiff_t>(r * stride_); };
+  std::fill_n(row(kGain),      stride_, 1.0);
+  std::fill_n(row(kHampelK),   stride_, kInf);
+  std::fill_n(row(kHampelMin), stride_, kInf);
+  std::fill_n(row(kRate),      stride_, kInf);
+
+  for (size_t i = 0; i < n_; ++i) {
+    const ChannelFilter& c = channels[i];
+    row(kGain)[i]   = c.gain;
+    row(kOffset)[i] = c.offset_c;
+    if (c.hampel_k > 0) {
+      row(kHampelK)[i]   = c.hampel_k * kMadSigma;
+      row(kHampelMin)[i] = c.hampel_min_c;
+    }
+    row(kTau)[i]  = std::max(0.0, c.lowpass_tau_s);
+    row(kRate)[i] = c.rate_limit_c_s > 0 ? c.rate_limit_c_s : kInf;
+    row(kMed3)[i] = c.median == 3 ? 1.0 : 0.0;
+    row(kMed5)[i] = c.median >= 5 ? 1.0 : 0.0;
+  }
+
+  hist_.assign(kTaps * stride_, 0.0);
+  for (auto* v : {&y_, &age_s_, &primed_, &x_, &ok_, &reject_})
+    v->assign(stride_, 0.0);
+  reset();
+}
+
+void FilterBank::reset() {
+  std::fill(hist_.begin(), hist_.end(), 0.0);
+  std::fill(y_.begin(), y_.end(), 0.0);
+  std::fill(age_s_.begin(), age_s_.end(), 0.0);
+  std::fill(primed_.begin(), primed_.end(), 0.0);
+  last_ = {};
+}
+
+void FilterBank::process(double* value, uint8_t* quality, size_t n, Clock::time_point t) {
+  n = std::min(n, n_);
+  if (n == 0) return;
+
+  const double dt = (last_ == Clock::time_point{})
+                      ? 0.0 : std::max(0.0, std::chrono::duration<double>(t - last_).count());
+  last_ = t;
+
+  const double* cfg = cfg_.data();
+  auto row = [&](Row r) { return cfg + r * stride_; };
+
+  calibrate(value, quality, row(kGain), row(kOffset), x_.data(), ok_.data(), n);
+  push(hist_.data(), stride_, kTaps, x_.data(), ok_.data(),
+       y_.data(), primed_.data(), age_s_.data(), dt, n);
+  filter(hist_.data(), stride_, row(kHampelK), row(kHampelMin), row(kMed3), row(kMed5),
+         row(kTau), row(kRate), x_.data(), ok_.data(), y_.data(), age_s_.data(),
+         reject_.data(), n);
+  publish(value, quality, y_.data(), primed_.data(), reject_.data(), n);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SampleFrame.h"
+
+// Per-channel filter settings; the defaults pass readings through unchanged
+struct ChannelFilter {
+  double offset_c{0.0};        // calibration: value * gain + offset_c
+  double gain{1.0};
+  int    median{1};            // median of the last 1, 3 or 5 readings
+  double hampel_k{0.0};        // reject beyond k·MAD (σ-scaled) of the last 5; 0 = off
+  double hampel_min_c{0.5};    // ... but never for a deviation below this
+  double lowpass_tau_s{0.0};   // first-order low-pass time constant; 0 = off
+  double rate_limit_c_s{0.0};  // maximum output slew; 0 = off
+};
+
+/**
+ * Filter stage between the THKA poll and its consumers, for every channel
+ * of a frame at once.
+ *
+ * Per channel, in order: calibration, Hampel outlier rejection (a reading
+ * further than k·1.4826·MAD from the median of the last five is replaced
+ * by that median and flagged kSampleRejected), median of the last N,
+ * first-order low-pass, slew-rate limit.
+ *
+ * State is kept structure-of-arrays, one contiguous array per quantity and
+ * history tap, and every stage is a branch-free loop across channels, so
+ * the compiler vectorises all channels together. Settings that are off
+ * reduce to identities in the same loops rather than branches.
+ *
+ * Only kSampleOk readings advance a channel. A stale or missing reading
+ * leaves its filter state alone and is reported as the last filtered value
+ * (still flagged), so a held value is never filtered twice.
+ *
+ * configure() allocates; process() does not. Not thread-safe: the poller
+ * owns it.
+ */
+class FilterBank {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // One entry per channel, in frame slot order
+  void configure(const std::vector<ChannelFilter>& channels);
+
+  // Forget the history (channels re-prime from their next reading)
+  void reset();
+
+  size_t channels() const { return n_; }
+
+  // Filter n values in place (n <= channels(); extra slots are untouched)
+  void process(double* value, uint8_t* quality, size_t n, Clock::time_point t);
+  void process(SampleFrame& f) { process(f.value.data(), f.quality.data(), f.count, f.acquired); }
+
+private:
+  static constexpr int kTaps = 5;
+
+  // Rows of cfg_, each stride_ long
+  enum Row { kGain, kOffset, kHampelK, kHampelMin, kTau, kRate, kMed3, kMed5, kRows };
+
+  size_t n_{0};
+  size_t stride_{0};            // n_ rounded up to a whole vector
+
+  std::vector<double> cfg_;     // kRows rows: settings
+  std::vector<double> hist_;    // kTaps rows: accepted readings, newest first
+  std::vector<double> y_;       // filter output
+  std::vector<double> age_s_;   // since the channel's last accepted reading
+  std::vector<double> primed_;  // 1.0 once a reading has been seen
+
+  // Scratch for one call
+  std::vector<double> x_, ok_, reject_;
+
+  Clock::time_point last_{};
+};
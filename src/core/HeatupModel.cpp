@@ -0,0 +1,199 @@
+#include "HeatupModel.h"
+#include "Events.h"
+#include "CureLog.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+// Temperatures enter the regressors in units of 100 °C, so the RLS
+// covariance stays well conditioned next to the constant term
+constexpr double kScale = 100.0;
+constexpr double kP0    = 1e3;
+constexpr double kStepS = 1.0;    // eta_s() integration step
+
+} // namespace
+
+// ---- Rls ----
+
+void HeatupModel::Rls::reset(double p0) {
+  for (int i = 0; i < 3; ++i) {
+    theta[i] = 0.0;
+    for (int j = 0; j < 3; ++j) p[i][j] = (i == j) ? p0 : 0.0;
+  }
+}
+
+void HeatupModel::Rls::update(const double phi[3], double y, double lambda) {
+  double pphi[3];
+  for (int i = 0; i < 3; ++i)
+    pphi[i] = p[i][0] * phi[0] + p[i][1] * phi[1] + p[i][2] * phi[2];
+  const double denom = lambda + phi[0] * pphi[0] + phi[1] * pphi[1] + phi[2] * pphi[2];
+
+  const double err = y - (theta[0] * phi[0] + theta[1] * phi[1] + theta[2] * phi[2]);
+  for (int i = 0; i < 3; ++i) theta[i] += pphi[i] / denom * err;
+
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      p[i][j] = (p[i][j] - pphi[i] * pphi[j] / denom) / lambda;
+}
+
+// ---- HeatupModel ----
+
+HeatupModel::HeatupModel() : HeatupModel(Options{}) {}
+
+HeatupModel::HeatupModel(const Options& opt) : opt_(opt) {
+  air_.reset(kP0);
+  wall_.reset(kP0);
+}
+
+void HeatupModel::begin(double target_c, Clock::time_point t) {
+  warming_       = true;
+  target_c_      = target_c;
+  epoch_         = t;
+  approach_at_s_ = -1.0;
+  below_         = false;
+  win_.clear();
+}
+
+void HeatupModel::end(Clock::time_point t) {
+  if (!warming_) return;
+  warming_ = false;
+  win_.clear();
+
+  // Tail only from warm-ups that started at full power
+  if (!below_ || approach_at_s_ < 0) return;
+  const double tail = std::chrono::duration<double>(t - epoch_).count() - approach_at_s_;
+  if (tail < 0) return;
+  tail_s_ = std::isnan(tail_s_) ? tail : (1.0 - opt_.tail_alpha) * tail_s_ + opt_.tail_alpha * tail;
+}
+
+void HeatupModel::add(double air_c, double wall_c, Clock::time_point t) {
+  if (!warming_) return;
+  add_s(air_c, wall_c, std::chrono::duration<double>(t - epoch_).count());
+}
+
+void HeatupModel::add_s(double air_c, double wall_c, double t_s) {
+  if (std::isnan(air_c) || std::isnan(wall_c)) return;
+
+  if (air_c >= target_c_ - opt_.approach_margin_c) {
+    if (below_ && approach_at_s_ < 0) approach_at_s_ = t_s;
+    win_.clear();
+    return;
+  }
+  below_ = true;
+
+  if (win_.n == 0) win_.t0 = t_s;
+  const double tau = t_s - win_.t0;
+  const double a = air_c / kScale;
+  const double w = wall_c / kScale;
+  ++win_.n;
+  win_.st  += tau;
+  win_.stt += tau * tau;
+  win_.sa  += a;
+  win_.sta += tau * a;
+  win_.sw  += w;
+  win_.stw += tau * w;
+
+  if (tau >= opt_.window_s && win_.n >= 3) close_window();
+}
+
+void HeatupModel::close_window() {
+  const double n   = win_.n;
+  const double den = n * win_.stt - win_.st * win_.st;
+  if (den > 0) {
+    const double slope_a = (n * win_.sta - win_.st * win_.sa) / den;   // per second, scaled
+    const double slope_w = (n * win_.stw - win_.st * win_.sw) / den;
+    const double a = win_.sa / n;
+    const double w = win_.sw / n;
+
+    const double phi_air[3]  = {1.0, a, w - a};
+    const double phi_wall[3] = {1.0, w, a - w};
+    air_.update(phi_air, slope_a, opt_.forgetting);
+    wall_.update(phi_wall, slope_w, opt_.forgetting);
+    ++windows_;
+  }
+  win_.clear();
+}
+
+double HeatupModel::eta_s(double air_c, double wall_c, double target_c) const {
+  if (!trained() || std::isnan(tail_s_) || std::isnan(air_c) || std::isnan(wall_c)) return kNaN;
+  if (air_c >= target_c) return 0.0;
+
+  const double approach = target_c - opt_.approach_margin_c;
+  if (air_c >= approach)
+    return tail_s_ * (target_c - air_c) / opt_.approach_margin_c;
+
+  double a = air_c / kScale;
+  double w = wall_c / kScale;
+  const double goal = approach / kScale;
+  for (double t = 0.0; t < opt_.horizon_s; t += kStepS) {
+    const double da = air_.theta[0] + air_.theta[1] * a + air_.theta[2] * (w - a);
+    const double dw = wall_.theta[0] + wall_.theta[1] * w + wall_.theta[2] * (a - w);
+    if (!(da > 0) || !std::isfinite(da) || !std::isfinite(dw)) return kNaN;   // stalls
+    a += kStepS * da;
+    w += kStepS * dw;
+    if (a >= goal) return t + kStepS + tail_s_;
+  }
+  return kNaN;
+}
+
+int HeatupModel::learn(const CureLogReader& log) {
+  const auto& cols = log.header().columns;
+  // The fused air column is what the controller saw; older logs only have CH1
+  int air_col = -1, ch1_col = -1, ir_col = -1;
+  for (size_t c = 0; c < cols.size(); ++c) {
+    if (cols[c].channel == 0 && cols[c].name == "Air(°C)") air_col = static_cast<int>(c);
+    if (cols[c].channel == 1) ch1_col = static_cast<int>(c);
+    if (cols[c].channel == 6) ir_col  = static_cast<int>(c);
+  }
+  if (air_col < 0) air_col = ch1_col;
+  if (air_col < 0 || ir_col < 0) return 0;
+
+  const int before = windows_;
+  const auto warming = static_cast<uint8_t>(State::Warming);
+  const Clock::time_point epoch{};
+  warming_ = false;
+
+  for (const auto& b : log.blocks()) {
+    const float* air = b.column(static_cast<size_t>(air_col));
+    const float* ir  = b.column(static_cast<size_t>(ir_col));
+    uint64_t ms = b.base_ms;
+    for (uint32_t r = 0; r < b.rows; ++r) {
+      ms += b.dt_ms[r];
+      const auto t = epoch + std::chrono::milliseconds(ms);
+      if (b.state[r] == warming) {
+        if (!warming_) begin(log.header().setpoint_c, t);
+        add(air[r], ir[r], t);
+      } else if (warming_) {
+        // Warming -> Ready is the target reached; anything else aborts
+        if (b.state[r] == static_cast<uint8_t>(State::Ready)) end(t);
+        else                                                   abort();
+      }
+    }
+  }
+  warming_ = false;
+  return windows_ - before;
+}
+
+int HeatupModel::learn_from_logs(const std::string& directory, size_t max_files) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  std::vector<fs::path> files;
+  for (const auto& entry : fs::directory_iterator(directory, ec)) {
+    if (entry.is_regular_file(ec) && entry.path().extension() == ".ovl")
+      files.push_back(entry.path());
+  }
+  // cure_log_YYYYmmdd_HHMMSS: name order is time order
+  std::sort(files.begin(), files.end());
+  if (files.size() > max_files)
+    files.erase(files.begin(), files.end() - static_cast<std::ptrdiff_t>(max_files));
+
+  int learnt = 0;
+  for (const auto& f : files) {
+    CureLogReader reader;
+    if (reader.open(f.string())) learnt += learn(reader);
+  }
+  return learnt;
+}
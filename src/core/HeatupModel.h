@@ -0,0 +1,107 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <string>
+
+class CureLogReader;
+
+/**
+ * Learned warm-up model: how long the oven takes to reach a target from
+ * its current air and wall temperatures.
+ *
+ * Two coupled first-order nodes, fitted by recursive least squares with
+ * slow forgetting on full-power warm-up data:
+ *
+ *     dT/dt = a0 + a1·T + a2·(W - T)      air (fused zones, see AirFusion)
+ *     dW/dt = b0 + b1·W + b2·(T - W)      wall (IR channel, no part in view)
+ *
+ * Slopes come from a least-squares line over each window_s of samples, so
+ * sensor noise is not differentiated. Only samples more than
+ * approach_margin_c below the target count as full power; the PID-limited
+ * approach from there to the target is learnt separately as a tail time.
+ *
+ * eta_s() integrates the model forward from the current state. Residual
+ * heat in the walls is what the wall node captures.
+ *
+ * Not thread-safe; StateMachine owns it.
+ */
+class HeatupModel {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Options {
+    double window_s{10.0};
+    double forgetting{0.9995};        // per window
+    double approach_margin_c{20.0};   // below target: heater at full power
+    double tail_alpha{0.3};           // EWMA weight of each new approach tail
+    double horizon_s{6 * 3600.0};     // give up predicting past this
+    int    min_windows{12};           // before eta_s() answers
+  };
+
+  HeatupModel();
+  explicit HeatupModel(const Options& opt);
+
+  // A warm-up towards target_c starts / ends (reached target_c) / is
+  // abandoned (nothing learnt about the approach)
+  void begin(double target_c, Clock::time_point t);
+  void end(Clock::time_point t);
+  void abort() { warming_ = false; win_.clear(); }
+  bool warming() const { return warming_; }
+
+  // One reading during a warm-up (between begin() and end())
+  void add(double air_c, double wall_c, Clock::time_point t);
+
+  // Seconds from (air_c, wall_c) to target_c; NaN until trained or if the
+  // model never gets there within horizon_s
+  double eta_s(double air_c, double wall_c, double target_c) const;
+
+  bool   trained()  const { return windows_ >= opt_.min_windows; }
+  int    windows()  const { return windows_; }
+  double tail_s()   const { return tail_s_; }
+
+  // Fit from the Warming rows of a binary cure log (.ovl); returns the
+  // number of windows learnt
+  int learn(const CureLogReader& log);
+
+  // learn() over the newest max_files .ovl logs in directory, oldest first
+  int learn_from_logs(const std::string& directory, size_t max_files = 20);
+
+private:
+  static constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+  // 3-parameter RLS: y ≈ θ·φ
+  struct Rls {
+    double theta[3]{0.0, 0.0, 0.0};
+    double p[3][3]{};
+
+    void reset(double p0);
+    void update(const double phi[3], double y, double lambda);
+  };
+
+  // Least-squares slope accumulator for one window
+  struct Window {
+    int    n{0};
+    double t0{0.0};
+    double st{0.0}, stt{0.0};
+    double sa{0.0}, sta{0.0};
+    double sw{0.0}, stw{0.0};
+
+    void clear() { *this = Window{}; }
+  };
+
+  void add_s(double air_c, double wall_c, double t_s);
+  void close_window();
+
+  Options opt_{};
+  Rls     air_, wall_;
+  Window  win_;
+  int     windows_{0};
+  double  tail_s_{kNaN};
+
+  bool              warming_{false};
+  double            target_c_{0.0};
+  Clock::time_point epoch_{};
+  double            approach_at_s_{-1.0};   // when the air crossed target - margin
+  bool              below_{false};          // saw full-power samples this warm-up
+};
@@ -0,0 +1,75 @@
+#include "LatencyHistogram.h"
+#include <bit>
+
+namespace {
+
+constexpr uint64_t kSub  = uint64_t{1} << LatencyHistogram::kSubBits;  // exact range
+constexpr uint64_t kHalf = kSub >> 1;                                   // buckets per octave
+
+} // namespace
+
+size_t LatencyHistogram::bucket_of(uint64_t us) {
+  if (us > kMaxUs) us = kMaxUs;
+  if (us < kSub) return static_cast<size_t>(us);
+
+  // msb >= kSubBits; keep the top kSubBits bits of the value
+  const int      msb      = 63 - std::countl_zero(us);
+  const int      shift    = msb - (kSubBits - 1);
+  const uint64_t mantissa = us >> shift;                 // kHalf .. kSub-1
+  return static_cast<size_t>(kSub + (shift - 1) * kHalf + (mantissa - kHalf));
+}
+
+uint64_t LatencyHistogram::bucket_high(size_t index) {
+  if (index < kSub) return index;
+  const uint64_t k        = index - kSub;
+  const int      shift    = static_cast<int>(k / kHalf) + 1;
+  const uint64_t mantissa = kHalf + k % kHalf;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record_us(uint64_t us) {
+  counts_[bucket_of(us)].fetch_add(1, std::memory_order_relaxed);
+  sum_us_.fetch_add(us, std::memory_order_relaxed);
+
+  uint64_t prev = max_us_.load(std::memory_order_relaxed);
+  while (us > prev && !max_us_.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+  // Counters are read one by one, so a snapshot taken during record() may
+  // be off by the in-flight sample; total is the sum of the buckets.
+  Snapshot s;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    s.counts[i] = counts_[i].load(std::memory_order_relaxed);
+    s.total += s.counts[i];
+  }
+  s.sum_us = sum_us_.load(std::memory_order_relaxed);
+  s.max_us = max_us_.load(std::memory_order_relaxed);
+  return s;
+}
+
+void LatencyHistogram::reset() {
+  for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+  sum_us_.store(0, std::memory_order_relaxed);
+  max_us_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile_us(double q) const {
+  if (total == 0) return 0;
+  if (q < 0) q = 0;
+  if (q > 1) q = 1;
+
+  // Rank of the wanted sample, 1-based
+  uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total) + 0.5);
+  if (rank < 1) rank = 1;
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      const uint64_t high = bucket_high(i);
+      return high < max_us ? high : max_us;
+    }
+  }
+  return max_us;
+}
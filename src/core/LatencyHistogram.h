@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Fixed-size latency histogram with HDR-style log-linear buckets.
+ *
+ * Values are microseconds. Below 2^kSubBits every value has its own bucket;
+ * above, each power of two is split into 2^(kSubBits-1) buckets, so any
+ * recorded value is reported within ~6% of its true value. record() is a
+ * handful of relaxed atomic adds: wait-free, allocation-free and safe from
+ * any thread (RT control loop included). Readers take a Snapshot.
+ */
+class LatencyHistogram {
+public:
+  static constexpr int      kSubBits  = 5;
+  static constexpr uint64_t kMaxUs    = (uint64_t{1} << 32) - 1;   // ~71 min
+  static constexpr size_t   kBuckets  =
+    (size_t{1} << kSubBits) + (32 - kSubBits) * (size_t{1} << (kSubBits - 1));
+
+  // Plain copy of the counters, with the statistics the UI needs
+  struct Snapshot {
+    std::array<uint64_t, kBuckets> counts{};
+    uint64_t total{0};
+    uint64_t sum_us{0};
+    uint64_t max_us{0};
+
+    double   mean_us() const { return total ? static_cast<double>(sum_us) / total : 0.0; }
+    uint64_t percentile_us(double q) const;   // q in [0, 1]; 0 when empty
+  };
+
+  void record_us(uint64_t us);
+
+  template <class Rep, class Period>
+  void record(std::chrono::duration<Rep, Period> d) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    record_us(us < 0 ? 0 : static_cast<uint64_t>(us));
+  }
+
+  Snapshot snapshot() const;
+  void     reset();
+
+  // Bucket mapping, exposed for Snapshot::percentile_us()
+  static size_t   bucket_of(uint64_t us);
+  static uint64_t bucket_high(size_t index);   // largest value in the bucket
+
+private:
+  std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+  std::atomic<uint64_t> sum_us_{0};
+  std::atomic<uint64_t> max_us_{0};
+};
@@ -0,0 +1,50 @@
+#include "LinkHealth.h"
+
+#include <algorithm>
+#include <cmath>
+
+void RttEstimator::sample(double rtt_s) {
+  backoff_ = 1.0;
+  if (srtt_s_ < 0.0) {
+    srtt_s_   = rtt_s;
+    rttvar_s_ = rtt_s / 2.0;
+    return;
+  }
+  rttvar_s_ += opt_.beta * (std::fabs(srtt_s_ - rtt_s) - rttvar_s_);
+  srtt_s_   += opt_.alpha * (rtt_s - srtt_s_);
+}
+
+void RttEstimator::timed_out() {
+  if (measured()) backoff_ = std::min(backoff_ * 2.0, opt_.max_s / opt_.min_s);
+}
+
+double RttEstimator::timeout_s() const {
+  if (!measured()) return opt_.max_s;
+  const double t = (srtt_s_ + opt_.k * rttvar_s_) * backoff_;
+  return std::clamp(t, opt_.min_s, opt_.max_s);
+}
+
+bool CircuitBreaker::allow(Clock::time_point now) {
+  if (state_ == State::Open && now >= until_) state_ = State::HalfOpen;
+  return state_ != State::Open;
+}
+
+void CircuitBreaker::success() {
+  state_    = State::Closed;
+  failures_ = 0;
+  open_s_   = opt_.open_s;
+}
+
+bool CircuitBreaker::failure(Clock::time_point now) {
+  if (state_ == State::HalfOpen) {
+    open_s_ = std::min(open_s_ * 2.0, opt_.max_open_s);
+  } else if (state_ == State::Open || ++failures_ < opt_.trip_failures) {
+    return false;
+  }
+  const bool tripped = state_ == State::Closed;
+  state_    = State::Open;
+  failures_ = 0;
+  until_    = now + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(open_s_));
+  return tripped;
+}
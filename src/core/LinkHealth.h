@@ -0,0 +1,85 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Round-trip time estimate for one kind of request on a serial bus, and
+ * the timeout to wait for its answer.
+ *
+ * Smoothed RTT and mean deviation as in TCP (RFC 6298): the timeout is
+ * srtt + k·rttvar, never below min_s (what the frames take on the wire)
+ * nor above max_s. Before the first answer it is max_s. A request that
+ * times out doubles the timeout until the next answer, so a device that
+ * went slow is not given up on at the first miss.
+ */
+class RttEstimator {
+public:
+  struct Options {
+    double min_s{0.05};
+    double max_s{1.0};
+    double alpha{0.125};   // weight of the latest sample in srtt
+    double beta{0.25};     // ... and in rttvar
+    double k{4.0};
+  };
+
+  RttEstimator() = default;
+  explicit RttEstimator(const Options& opt) : opt_(opt) {}
+
+  void sample(double rtt_s);   // an answered request
+  void timed_out();
+
+  double timeout_s() const;
+  bool   measured() const { return srtt_s_ >= 0.0; }
+  double srtt_s() const { return srtt_s_; }       // -1 before the first answer
+  double rttvar_s() const { return rttvar_s_; }
+
+private:
+  Options opt_{};
+  double  srtt_s_{-1.0};
+  double  rttvar_s_{0.0};
+  double  backoff_{1.0};
+};
+
+/**
+ * Circuit breaker over one device.
+ *
+ * Closed: requests go out. trip_failures failures in a row open it: no
+ * requests for open_s, callers fail at once. Then it half-opens and lets
+ * one request through as a probe; an answer closes it, a failure opens it
+ * again for twice as long, up to max_open_s.
+ */
+class CircuitBreaker {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class State : uint8_t { Closed, Open, HalfOpen };
+
+  struct Options {
+    int    trip_failures{5};
+    double open_s{1.0};
+    double max_open_s{30.0};
+  };
+
+  CircuitBreaker() = default;
+  explicit CircuitBreaker(const Options& opt) : opt_(opt), open_s_(opt.open_s) {}
+
+  // May a request go out now? Half-opens an open breaker whose time is up.
+  bool allow(Clock::time_point now);
+  void success();
+  // True if this failure opened the breaker
+  bool failure(Clock::time_point now);
+  // Probe at the next request instead of waiting out the open time (a
+  // reconnected port, say)
+  void probe() { if (state_ == State::Open) state_ = State::HalfOpen; }
+
+  State  state() const { return state_; }
+  bool   open() const { return state_ == State::Open; }
+  double open_s() const { return open_s_; }   // current wait between probes
+
+private:
+  Options           opt_{};
+  State             state_{State::Closed};
+  int               failures_{0};
+  double            open_s_{opt_.open_s};
+  Clock::time_point until_{};
+};
@@ -0,0 +1,160 @@
+#include "PartEstimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Upper-tail standard normal quantile: z with P(Z > z) = alpha
+double upper_quantile(double alpha) {
+  double lo = 0.0, hi = 12.0;
+  for (int i = 0; i < 60; ++i) {
+    const double mid = 0.5 * (lo + hi);
+    if (0.5 * std::erfc(mid / std::sqrt(2.0)) > alpha) lo = mid;
+    else                                                hi = mid;
+  }
+  return 0.5 * (lo + hi);
+}
+
+constexpr double kNoiseAlpha  = 0.01;   // innovation variance EWMA
+constexpr double kPeriodAlpha = 0.05;   // sample period EWMA
+constexpr double kPartRateVar = 0.25;   // initial part rate variance, (°C/s)²
+constexpr double kWallRateVar = 0.01;
+
+} // namespace
+
+// ---- Track ----
+
+void PartEstimator::Track::init(double y, double var_x, double var_v) {
+  x = y;
+  v = 0.0;
+  p00 = var_x;
+  p01 = 0.0;
+  p11 = var_v;
+}
+
+void PartEstimator::Track::predict(double dt, double q) {
+  if (dt <= 0) return;
+  const double dt2 = dt * dt;
+  x   += dt * v;
+  p00 += 2.0 * dt * p01 + dt2 * p11 + q * dt2 * dt2 / 4.0;
+  p01 += dt * p11 + q * dt2 * dt / 2.0;
+  p11 += q * dt2;
+}
+
+void PartEstimator::Track::correct(double y, double r) {
+  const double s  = p00 + r;
+  const double k0 = p00 / s;
+  const double k1 = p01 / s;
+  const double nu = y - x;
+  x += k0 * nu;
+  v += k1 * nu;
+  p11 -= k1 * p01;
+  p00 *= (1.0 - k0);
+  p01 *= (1.0 - k0);
+}
+
+// ---- PartEstimator ----
+
+void PartEstimator::reset() {
+  phase_     = Phase::Wall;
+  armed_     = false;
+  wall_      = {};
+  part_      = {};
+  r_         = opt_.ir_noise_c * opt_.ir_noise_c;
+  resid_var_ = 0.0;
+  hits_      = 0;
+  last_      = {};
+  z_period_s_ = 0.0;
+}
+
+void PartEstimator::arm() {
+  armed_   = true;
+  hits_    = 0;
+  if (phase_ != Phase::Wall) {
+    // The IR has been looking at a part; relearn the wall from scratch
+    phase_ = Phase::Wall;
+    wall_  = {};
+  }
+}
+
+double PartEstimator::noise_c() const { return std::sqrt(r_); }
+
+void PartEstimator::update_threshold() {
+  // The quantile search is costly next to a tick; redo it only when the
+  // sample period has drifted
+  if (period_s_ <= 0 || std::abs(period_s_ - z_period_s_) < 0.02 * z_period_s_) return;
+  z_period_s_ = period_s_;
+
+  const int    n     = std::max(opt_.confirm_samples, 1);
+  const double per_n = opt_.false_alarms_per_hour * period_s_ / 3600.0;
+  const double alpha = std::clamp(std::pow(per_n, 1.0 / n), 1e-15, 0.5);
+  z_ = upper_quantile(alpha);
+}
+
+bool PartEstimator::update(double ir_c, Clock::time_point t) {
+  if (std::isnan(ir_c)) return false;
+
+  const double dt = (last_ == Clock::time_point{})
+                      ? 0.0
+                      : std::chrono::duration<double>(t - last_).count();
+  last_ = t;
+  if (dt > 0)
+    period_s_ = (period_s_ > 0) ? (1.0 - kPeriodAlpha) * period_s_ + kPeriodAlpha * dt : dt;
+
+  const double q_part = opt_.part_accel_c_s2 * opt_.part_accel_c_s2;
+  const double q_wall = opt_.wall_accel_c_s2 * opt_.wall_accel_c_s2;
+
+  if (phase_ == Phase::Part) {
+    part_.predict(dt, q_part);
+    part_.correct(ir_c, r_);
+    return false;
+  }
+
+  if (std::isnan(wall_.x)) {
+    wall_.init(ir_c, r_, kWallRateVar);
+    return false;
+  }
+
+  wall_.predict(dt, q_wall);
+  const double s  = wall_.innovation_var(r_);
+  const double nu = ir_c - wall_.x;
+
+  if (armed_ && wall_.x >= opt_.min_wall_c) {
+    if (hits_ == 0) update_threshold();
+    const double drop = -nu;
+    if (drop > z_ * std::sqrt(s) && drop >= opt_.min_drop_c) {
+      ++hits_;
+      phase_ = Phase::Confirming;
+      if (hits_ < std::max(opt_.confirm_samples, 1)) return false;
+
+      // Confirmed: the part track starts at the latest reading
+      phase_ = Phase::Part;
+      part_.init(ir_c, r_, kPartRateVar);
+      return true;
+    }
+  }
+
+  // Wall reading (or a rejected candidate): back to tracking the wall
+  phase_   = Phase::Wall;
+  hits_    = 0;
+
+  resid_var_ = (1.0 - kNoiseAlpha) * resid_var_ + kNoiseAlpha * (nu * nu - (s - r_));
+  r_ = std::max(opt_.ir_noise_c * opt_.ir_noise_c, resid_var_);
+  wall_.correct(ir_c, r_);
+  return false;
+}
+
+double PartEstimator::time_to_target_s(double target_c, double air_c) const {
+  if (!part_found()) return kNaN;
+  const double p = part_.x;
+  const double v = part_.v;
+  if (p >= target_c) return 0.0;
+  if (v <= 1e-4) return kNaN;
+
+  // First order towards the air: rate = (air - p) / tau
+  if (!std::isnan(air_c) && air_c > target_c + 0.5 && air_c > p) {
+    const double tau = (air_c - p) / v;
+    return tau * std::log((air_c - p) / (air_c - target_c));
+  }
+  return (target_c - p) / v;
+}
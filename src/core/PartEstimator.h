@@ -0,0 +1,94 @@
+#pragma once
+#include <chrono>
+#include <limits>
+
+/**
+ * Kalman estimator on the IR channel: wall baseline before a part goes in,
+ * part temperature and heating rate after.
+ *
+ * Both tracks are constant-velocity filters (value and rate, white
+ * acceleration noise). While no part is seen the IR reading updates the
+ * wall track. Once armed, each reading is also tested against the wall
+ * prediction: a drop beyond z·√S (S = innovation variance) on
+ * confirm_samples consecutive readings detects a part. The per-reading z
+ * is set from the false-alarm rate and the measured sample period, so
+ * false_alarms_per_hour holds for Gaussian noise. Samples under test are
+ * kept out of the wall track; the part track starts from them.
+ *
+ * The measurement noise is the larger of ir_noise_c and the innovation
+ * variance seen on the wall, so a noisier sensor raises the threshold
+ * rather than the false-alarm rate.
+ *
+ * Feed one update() per new THKA sample, never a repeated one.
+ */
+class PartEstimator {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Phase { Wall, Confirming, Part };
+
+  struct Options {
+    double ir_noise_c{0.5};              // 1σ IR reading noise (floor)
+    double wall_accel_c_s2{2e-4};        // wall track process noise, 1σ
+    double part_accel_c_s2{2e-3};        // part track process noise, 1σ
+    double false_alarms_per_hour{0.01};
+    int    confirm_samples{3};
+    double min_drop_c{15.0};             // and at least this far below the wall
+    double min_wall_c{100.0};            // wall hot enough for a drop to mean a part
+  };
+
+  // Also resets
+  void configure(const Options& opt) { opt_ = opt; reset(); }
+
+  // Forget everything (oven idle, part out)
+  void reset();
+
+  // Look for a part from the next reading on. Keeps the wall track if no
+  // part is being tracked.
+  void arm();
+  void disarm() { armed_ = false; }
+
+  // One IR reading. Returns true on the reading that detects a part.
+  bool update(double ir_c, Clock::time_point t);
+
+  Phase  phase()         const { return phase_; }
+  bool   part_found()    const { return phase_ == Phase::Part; }
+  double wall_c()        const { return wall_.x; }
+  double part_c()        const { return part_found() ? part_.x : kNaN; }
+  double part_rate_c_s() const { return part_found() ? part_.v : kNaN; }
+  double noise_c()       const;
+  double z_threshold()   const { return z_; }
+
+  // Seconds until the part reaches target_c, heating first-order towards
+  // air_c at the current rate (linear if air is not above target). NaN
+  // while no part is tracked or it is not heating.
+  double time_to_target_s(double target_c, double air_c) const;
+
+private:
+  static constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+  struct Track {
+    double x{kNaN};     // °C
+    double v{0.0};      // °C/s
+    double p00{0.0}, p01{0.0}, p11{0.0};
+
+    void   init(double y, double var_x, double var_v);
+    void   predict(double dt, double q);
+    double innovation_var(double r) const { return p00 + r; }
+    void   correct(double y, double r);
+  };
+
+  void update_threshold();
+
+  Options opt_{};
+  Phase   phase_{Phase::Wall};
+  bool    armed_{false};
+  Track   wall_, part_;
+  double  r_{0.25};                   // measurement variance in use
+  double  resid_var_{0.0};            // EWMA of wall innovations² minus prediction variance
+  double  period_s_{0.0};             // EWMA of the sample period
+  double  z_{std::numeric_limits<double>::infinity()};
+  double  z_period_s_{0.0};           // period z_ was computed for
+  int     hits_{0};
+  Clock::time_point last_{};
+};
@@ -0,0 +1,61 @@
+#include "Pid.h"
+#include <algorithm>
+#include <cmath>
+
+double Pid::update(double setpoint, double measured, double dt_s) {
+  if (std::isnan(setpoint) || std::isnan(measured)) return out_;
+
+  const double e = setpoint - measured;
+  if (!(dt_s > 0)) dt_s = 0.0;   // first call: P (+ held I) only
+
+  // Derivative on measurement, first-order low-pass
+  if (!std::isnan(prev_pv_) && dt_s > 0) {
+    const double raw   = -(measured - prev_pv_) / dt_s;
+    const double alpha = g_.d_filter_s > 0 ? dt_s / (g_.d_filter_s + dt_s) : 1.0;
+    d_ += alpha * (raw - d_);
+  }
+  prev_pv_ = measured;
+
+  const double p = g_.kp * e;
+  const double d = g_.kd * d_;
+
+  // Integrate only if that does not push further into saturation
+  const double i_next = std::clamp(i_ + g_.ki * e * dt_s, g_.out_min, g_.out_max);
+  const double u_next = p + i_next + d;
+  const bool   winding = (u_next > g_.out_max && e > 0) || (u_next < g_.out_min && e < 0);
+  if (!winding) i_ = i_next;
+
+  out_ = std::clamp(p + i_ + d, g_.out_min, g_.out_max);
+  return out_;
+}
+
+void Pid::reset(double output) {
+  i_       = std::clamp(output, g_.out_min, g_.out_max);
+  d_       = 0.0;
+  prev_pv_ = std::numeric_limits<double>::quiet_NaN();
+  out_     = i_;
+}
+
+bool TimeProportioner::update(double duty, Clock::time_point now) {
+  const auto window = std::chrono::duration<double>(window_s_);
+  if (!started_ || now - window_start_ >= window) {
+    // Keep windows back to back unless we fell more than one behind
+    if (started_ && now - window_start_ < 2 * window)
+      window_start_ += std::chrono::duration_cast<Clock::duration>(window);
+    else
+      window_start_ = now;
+    started_     = true;
+    off_latched_ = false;
+  }
+  if (off_latched_) return false;
+
+  double on_s = std::clamp(duty, 0.0, 1.0) * window_s_;
+  if (on_s < min_switch_s_)                  on_s = 0.0;
+  else if (window_s_ - on_s < min_switch_s_) on_s = window_s_;
+
+  const double elapsed = std::chrono::duration<double>(now - window_start_).count();
+  if (elapsed < on_s) return true;
+
+  off_latched_ = on_s < window_s_;
+  return false;
+}
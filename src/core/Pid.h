@@ -0,0 +1,81 @@
+#pragma once
+#include <chrono>
+#include <limits>
+
+/**
+ * PID controller with derivative filtering and anti-windup.
+ *
+ * The derivative acts on the measurement (no kick on setpoint changes) and
+ * is low-passed with time constant d_filter_s. The integrator stops
+ * accumulating while the output is saturated in the direction of the error
+ * (conditional integration) and is itself clamped to the output range, so
+ * a long warm-up at 100% does not wind up into overshoot.
+ */
+class Pid {
+public:
+  struct Gains {
+    double kp{0.0};
+    double ki{0.0};          // per second
+    double kd{0.0};          // seconds
+    double d_filter_s{0.0};  // 0 = unfiltered
+    double out_min{0.0};
+    double out_max{1.0};
+  };
+
+  Pid() = default;
+  explicit Pid(const Gains& g) : g_(g) {}
+
+  void set_gains(const Gains& g) { g_ = g; }
+  const Gains& gains() const { return g_; }
+
+  // One control step. With dt_s <= 0 (first call) nothing is integrated or
+  // differentiated; the output is P plus the held integrator.
+  double update(double setpoint, double measured, double dt_s);
+
+  // Bumpless restart: the next output starts from `output`
+  void reset(double output = 0.0);
+
+  double output()   const { return out_; }
+  double integral() const { return i_; }
+
+private:
+  Gains  g_{};
+  double i_{0.0};
+  double d_{0.0};                                        // filtered -d(pv)/dt
+  double prev_pv_{std::numeric_limits<double>::quiet_NaN()};
+  double out_{0.0};
+};
+
+/**
+ * Slow PWM for a contactor: a duty cycle in [0, 1] becomes one on-pulse
+ * at the start of every window. Pulses shorter than min_switch_s are
+ * dropped (or stretched to the full window), and once the output has
+ * switched off it stays off until the next window, so duty changes
+ * mid-window never add switching cycles.
+ */
+class TimeProportioner {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  TimeProportioner() = default;
+  TimeProportioner(double window_s, double min_switch_s)
+    : window_s_(window_s), min_switch_s_(min_switch_s) {}
+
+  void configure(double window_s, double min_switch_s) {
+    window_s_ = window_s;
+    min_switch_s_ = min_switch_s;
+  }
+
+  // Start a new window at `now` on the next update()
+  void restart() { started_ = false; }
+
+  // Relay state for `duty` at `now`
+  bool update(double duty, Clock::time_point now);
+
+private:
+  double window_s_{10.0};
+  double min_switch_s_{0.5};
+  bool   started_{false};
+  bool   off_latched_{false};
+  Clock::time_point window_start_{};
+};
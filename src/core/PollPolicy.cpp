@@ -0,0 +1,31 @@
+#include "PollPolicy.h"
+
+#include <algorithm>
+
+double PollPolicy::period_s(State s, OperatingMode m, int channel) const {
+  double period = kFullRate_s;
+  for (const auto& r : rules_) {
+    if (r.state && *r.state != s) continue;
+    if (r.mode && *r.mode != m) continue;
+    if (!r.channels.empty() &&
+        std::find(r.channels.begin(), r.channels.end(), channel) == r.channels.end())
+      continue;
+    period = r.period_s;
+  }
+  return period;
+}
+
+PollPolicy PollPolicy::defaults(const std::vector<int>& air, const std::vector<int>& parts) {
+  constexpr double kSlow_s = 1.0;
+
+  PollPolicy p;
+  p.add({State::Idle, {}, {}, kSlow_s});
+  p.add({State::AutoCureComplete, {}, {}, kSlow_s});
+
+  p.add({State::Ready, {}, {}, kSlow_s});
+  p.add({State::Ready, {}, air, kFullRate_s});
+  p.add({State::Ready, {}, parts, kEveryCycle});
+
+  p.add({{}, OperatingMode::Autotune, air, kFullRate_s});
+  return p;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <optional>
+#include <vector>
+
+#include "Events.h"
+
+/**
+ * How often each THKA channel is read, by controller state and mode.
+ *
+ * Rules are checked in the order they were added and the last one that
+ * matches a channel wins, so a policy reads as general rules followed by
+ * exceptions. A channel no rule matches is read at kFullRate_s. A period
+ * of kEveryCycle reads it every poll cycle, as fast as the poller runs.
+ *
+ * The poller reads a register span at the fastest period of its channels.
+ */
+class PollPolicy {
+public:
+  static constexpr double kEveryCycle = 0.0;
+  static constexpr double kFullRate_s = 0.1;
+
+  struct Rule {
+    std::optional<State>         state;     // any state when unset
+    std::optional<OperatingMode> mode;      // any mode when unset
+    std::vector<int>             channels;  // every channel when empty
+    double                       period_s{kFullRate_s};
+  };
+
+  void add(const Rule& r) { rules_.push_back(r); }
+
+  double period_s(State s, OperatingMode m, int channel) const;
+
+  // This oven: everything at full rate while curing (logged) and warming;
+  // the part channels every cycle while Ready, where detection latency
+  // matters, with the air kept at full rate for the controller and the
+  // rest at 1 Hz; 1 Hz in Idle and when the cure is complete. Autotune
+  // always reads the air at full rate.
+  static PollPolicy defaults(const std::vector<int>& air, const std::vector<int>& parts);
+
+private:
+  std::vector<Rule> rules_;
+};
@@ -0,0 +1,67 @@
+#include "Recipe.h"
+#include <algorithm>
+#include <cmath>
+
+double Recipe::max_c() const {
+  double hottest = load_c;
+  for (const auto& s : segments) hottest = std::max(hottest, s.soak_c);
+  return hottest;
+}
+
+std::string Recipe::check() const {
+  if (key.empty() || key.find_first_of(" \t") != std::string::npos) return "bad key";
+  if (segments.empty()) return "no segments";
+  if (!(load_c > 0)) return "bad load temperature";
+  for (size_t i = 0; i < segments.size(); ++i) {
+    const RecipeSegment& s = segments[i];
+    const std::string at = "segment " + std::to_string(i + 1) + ": ";
+    if (!(s.soak_c > 0))         return at + "bad soak temperature";
+    if (!(s.ramp_c_min >= 0))    return at + "bad ramp rate";
+    if (!(s.soak_s >= 0))        return at + "bad soak time";
+    if (!(s.tolerance_c > 0))    return at + "bad tolerance";
+    if (s.basis == RecipeSegment::Basis::Cure && s.cure.table.empty() && !(s.cure.ref_s > 0))
+      return at + "cure segment without a cure time";
+  }
+  return {};
+}
+
+Recipe Recipe::single(double target_c, const CureProfile& cure, double band_c) {
+  RecipeSegment s;
+  s.soak_c      = target_c;
+  s.soak_s      = cure.ref_s;
+  s.basis       = RecipeSegment::Basis::Cure;
+  s.tolerance_c = band_c;
+  s.cure        = cure;
+
+  Recipe r;
+  r.key    = keyFor(target_c);
+  r.name   = std::to_string(static_cast<long>(std::lround(target_c))) + " °C";
+  r.load_c = target_c;
+  r.segments.push_back(s);
+  return r;
+}
+
+std::string Recipe::keyFor(double target_c) {
+  std::string key = "T";
+  key += std::to_string(static_cast<long>(std::lround(target_c)));
+  return key;
+}
+
+const char* basisName(RecipeSegment::Basis b) {
+  switch (b) {
+    case RecipeSegment::Basis::Air:  return "air";
+    case RecipeSegment::Basis::Part: return "part";
+    case RecipeSegment::Basis::Cure: return "cure";
+  }
+  return "air";
+}
+
+bool parseBasis(const std::string& s, RecipeSegment::Basis& out) {
+  for (auto b : {RecipeSegment::Basis::Air, RecipeSegment::Basis::Part, RecipeSegment::Basis::Cure}) {
+    if (s == basisName(b)) {
+      out = b;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "CureIntegrator.h"
+
+// One ramp/soak step of a recipe
+struct RecipeSegment {
+  // What the soak waits for
+  enum class Basis {
+    Air,    // soak_s counted while the air is within tolerance_c of soak_c
+    Part,   // soak_s counted, per part, while the part is within tolerance_c
+    Cure,   // cure equivalence per part (cure; by default soak_s at soak_c,
+            // Arrhenius-scaled within ±tolerance_c)
+  };
+
+  double      ramp_c_min{0.0};    // air setpoint slew to soak_c; 0 = step
+  double      soak_c{200.0};
+  double      soak_s{0.0};
+  Basis       basis{Basis::Air};
+  double      tolerance_c{5.0};
+  CureProfile cure{};             // Basis::Cure only
+};
+
+/**
+ * Multi-step cure recipe, as a powder datasheet gives it.
+ *
+ * The oven warms to load_c and waits in Ready as before. From the part
+ * detection on, the segments run in order: the air setpoint ramps from
+ * where it is to the segment's soak_c at ramp_c_min, then the segment
+ * soaks until its basis is met for every part in the load. The cure is
+ * complete when the last segment is. A part detected late in the load
+ * window joins the segment that is running.
+ */
+struct Recipe {
+  std::string                key;        // no whitespace; also keys the PID gains
+  std::string                name;
+  double                     load_c{200.0};
+  std::vector<RecipeSegment> segments;
+
+  // Hottest setpoint the recipe asks for (the THKA limit)
+  double max_c() const;
+
+  // Empty string if the recipe can run, else what is wrong with it
+  std::string check() const;
+
+  // Plain auto mode: load at target_c, one cure segment there
+  static Recipe single(double target_c, const CureProfile& cure, double band_c);
+
+  // Key of single(target_c); gains tuned at a temperature are kept under it
+  static std::string keyFor(double target_c);
+};
+
+const char* basisName(RecipeSegment::Basis b);
+bool        parseBasis(const std::string& s, RecipeSegment::Basis& out);
@@ -0,0 +1,110 @@
+#include "RelayAutotune.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double mean_of(const std::vector<double>& v, size_t from) {
+  if (v.size() <= from) return 0.0;
+  return std::accumulate(v.begin() + from, v.end(), 0.0) / static_cast<double>(v.size() - from);
+}
+
+} // namespace
+
+void RelayAutotune::start(const Options& opt, const Pid::Gains& base, double t_s) {
+  opt_      = opt;
+  base_     = base;
+  phase_    = Phase::Running;
+  relay_on_ = true;          // start by heating towards the setpoint
+  start_s_  = t_s;
+  last_on_s_ = -1.0;
+  periods_.clear();
+  amplitudes_.clear();
+  periods_.reserve(cycles_needed());
+  amplitudes_.reserve(cycles_needed());
+  result_  = {};
+  failure_ = "";
+}
+
+void RelayAutotune::cancel() {
+  if (phase_ == Phase::Running) fail("cancelled");
+}
+
+void RelayAutotune::fail(const char* why) {
+  phase_    = Phase::Failed;
+  relay_on_ = false;
+  failure_  = why;
+}
+
+bool RelayAutotune::update(double pv, double t_s) {
+  if (phase_ != Phase::Running) return false;
+
+  if (std::isnan(pv))                              { fail("sensor reading invalid"); return false; }
+  if (t_s - start_s_ > opt_.max_s)                 { fail("no stable oscillation before timeout"); return false; }
+  if (pv > opt_.setpoint_c + opt_.max_excursion_c) { fail("temperature excursion too large"); return false; }
+
+  if (last_on_s_ >= 0) {
+    cycle_max_ = std::max(cycle_max_, pv);
+    cycle_min_ = std::min(cycle_min_, pv);
+  }
+
+  if (relay_on_ && pv > opt_.setpoint_c + opt_.hysteresis_c) {
+    relay_on_ = false;
+  } else if (!relay_on_ && pv < opt_.setpoint_c - opt_.hysteresis_c) {
+    relay_on_ = true;
+
+    // One full cycle ends at each off->on switch
+    if (last_on_s_ >= 0) {
+      periods_.push_back(t_s - last_on_s_);
+      amplitudes_.push_back((cycle_max_ - cycle_min_) / 2.0);
+      if (cycles_done() >= cycles_needed()) {
+        finish();
+        relay_on_ = false;
+        return false;
+      }
+    }
+    last_on_s_ = t_s;
+    cycle_max_ = cycle_min_ = pv;
+  }
+  return relay_on_;
+}
+
+void RelayAutotune::finish() {
+  const size_t from = static_cast<size_t>(std::max(opt_.discard, 0));
+  const double tu = mean_of(periods_, from);
+  const double a  = mean_of(amplitudes_, from);
+  const double eps = opt_.hysteresis_c;
+
+  if (!(tu > 0) || a <= eps) {
+    fail("oscillation too small to identify");
+    return;
+  }
+
+  // Relay swings duty between 0 and 1: d = 0.5
+  const double d  = 0.5;
+  const double ku = 4.0 * d / (kPi * std::sqrt(a * a - eps * eps));
+
+  result_.ku          = ku;
+  result_.tu_s        = tu;
+  result_.amplitude_c = a;
+  result_.gains       = gains_for(opt_.rule, ku, tu, base_);
+  phase_ = Phase::Done;
+}
+
+Pid::Gains RelayAutotune::gains_for(Rule rule, double ku, double tu_s, const Pid::Gains& base) {
+  double kp = 0, ti = 0, td = 0;
+  switch (rule) {
+    case Rule::ZieglerNichols: kp = 0.60 * ku; ti = tu_s / 2.0; td = tu_s / 8.0; break;
+    case Rule::SomeOvershoot:  kp = 0.33 * ku; ti = tu_s / 2.0; td = tu_s / 3.0; break;
+    case Rule::NoOvershoot:    kp = 0.20 * ku; ti = tu_s / 2.0; td = tu_s / 3.0; break;
+  }
+
+  Pid::Gains g = base;
+  g.kp = kp;
+  g.ki = ti > 0 ? kp / ti : 0.0;
+  g.kd = kp * td;
+  return g;
+}
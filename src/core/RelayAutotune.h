@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include "Pid.h"
+
+/**
+ * Åström–Hägglund relay-feedback experiment.
+ *
+ * The heater is switched fully on below setpoint - hysteresis and fully off
+ * above setpoint + hysteresis. The loop settles into a limit cycle whose
+ * period is the ultimate period Tu, and whose amplitude a gives the
+ * ultimate gain Ku = 4d / (π·√(a² - ε²)), with d the relay half-swing and ε
+ * the hysteresis. PID gains follow from Ku and Tu by a Ziegler–Nichols
+ * style rule.
+ *
+ * Driven by samples: call update() with each new reading and its time, and
+ * apply the returned relay state. Pure computation, so it runs the same
+ * against SimOven and the real oven.
+ */
+class RelayAutotune {
+public:
+  enum class Phase { Idle, Running, Done, Failed };
+
+  enum class Rule {
+    ZieglerNichols,   // Kp 0.6 Ku, Ti Tu/2, Td Tu/8  (fast, ~25% overshoot)
+    SomeOvershoot,    // Kp 0.33 Ku, Ti Tu/2, Td Tu/3
+    NoOvershoot,      // Kp 0.2 Ku, Ti Tu/2, Td Tu/3
+  };
+
+  struct Options {
+    double setpoint_c{200.0};
+    double hysteresis_c{1.0};     // relay band, above the sensor noise
+    int    cycles{4};             // full cycles averaged for the result
+    int    discard{1};            // initial cycles ignored (approach from cold)
+    double max_s{3 * 3600.0};     // give up after this long
+    double max_excursion_c{30.0}; // abort if the reading rises this far above setpoint
+    Rule   rule{Rule::NoOvershoot};
+  };
+
+  struct Result {
+    double ku{0.0};           // duty per °C
+    double tu_s{0.0};
+    double amplitude_c{0.0};
+    Pid::Gains gains{};       // kp/ki/kd filled in; the rest copied from start()
+  };
+
+  // base: the gains being replaced (filter and output range are kept)
+  void start(const Options& opt, const Pid::Gains& base, double t_s);
+  void cancel();
+
+  // Feed one reading; returns the relay (contactor) state to apply
+  bool update(double pv, double t_s);
+
+  Phase         phase()       const { return phase_; }
+  bool          running()     const { return phase_ == Phase::Running; }
+  int           cycles_done() const { return static_cast<int>(periods_.size()); }
+  int           cycles_needed() const { return opt_.discard + opt_.cycles; }
+  const Result& result()      const { return result_; }
+  const char*   failure()     const { return failure_; }
+
+  static Pid::Gains gains_for(Rule rule, double ku, double tu_s, const Pid::Gains& base);
+
+private:
+  void fail(const char* why);
+  void finish();
+
+  Options opt_{};
+  Pid::Gains base_{};
+  Phase   phase_{Phase::Idle};
+  bool    relay_on_{false};
+  double  start_s_{0.0};
+  double  last_on_s_{-1.0};     // last off->on switch, -1 = none yet
+  double  cycle_max_{0.0};
+  double  cycle_min_{0.0};
+
+  std::vector<double> periods_;
+  std::vector<double> amplitudes_;
+  Result      result_{};
+  const char* failure_{""};
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "SeqLock.h"
+
+// Per-channel quality flags
+enum SampleQuality : uint8_t {
+  kSampleOk       = 0,
+  kSampleStale    = 1 << 0,  // read failed; value held from an earlier poll
+  kSampleMissing  = 1 << 1,  // no reading available at all (value is NaN)
+  kSampleRejected = 1 << 2,  // outlier; value replaced by the FilterBank median
+  kSampleHeld     = 1 << 3,  // not read this poll (lower rate or no bus time); value from its last read
+};
+
+/**
+ * One THKA poll: every channel acquired in the same bus cycle.
+ *
+ * Fixed size and trivially copyable so it can be published through a
+ * SeqLock and read by the control loop without allocation.
+ */
+struct SampleFrame {
+  static constexpr size_t kMaxChannels = 16;
+
+  uint64_t                              seq{0};       // 1, 2, 3, ... per published poll
+  std::chrono::steady_clock::time_point acquired{};   // when the bus read completed
+  uint8_t                               count{0};     // channels in use
+  std::array<uint8_t, kMaxChannels>     channel{};    // THKA channel id per slot
+  std::array<uint8_t, kMaxChannels>     quality{};    // SampleQuality flags per slot
+  std::array<double,  kMaxChannels>     value{};      // °C per slot
+
+  // Slot of THKA channel id ch, or -1
+  int slot(int ch) const {
+    for (size_t i = 0; i < count; ++i)
+      if (channel[i] == ch) return static_cast<int>(i);
+    return -1;
+  }
+
+  // Value of THKA channel id ch; NaN if absent or missing
+  double value_of(int ch) const {
+    const int i = slot(ch);
+    if (i < 0 || (quality[i] & kSampleMissing)) return std::nan("");
+    return value[i];
+  }
+};
+
+// Latest frame, published by ThkaPoller and read by the control loop / GUI
+using SampleBus = SeqLock<SampleFrame>;
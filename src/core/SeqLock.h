@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Single-writer sequence lock for a trivially copyable value.
+ *
+ * store() never blocks; load() never blocks the writer and retries until it
+ * has copied a snapshot that was not being written at the same time. The
+ * payload lives in relaxed atomic words, so concurrent access is well
+ * defined and nothing is allocated.
+ */
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>, "SeqLock payload must be trivially copyable");
+
+public:
+  // Writer side (one thread only)
+  void store(const T& v) {
+    uint64_t words[kWords] = {};
+    std::memcpy(words, &v, sizeof(T));
+
+    const uint64_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);        // odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; ++i)
+      data_[i].store(words[i], std::memory_order_relaxed);
+    seq_.store(s + 2, std::memory_order_release);        // even: stable
+  }
+
+  // Reader side (any thread)
+  T load() const {
+    uint64_t words[kWords];
+    for (;;) {
+      const uint64_t s0 = seq_.load(std::memory_order_acquire);
+      if (s0 & 1) continue;
+      for (size_t i = 0; i < kWords; ++i)
+        words[i] = data_[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == s0) break;
+    }
+    T v;
+    std::memcpy(&v, words, sizeof(T));
+    return v;
+  }
+
+  // Number of completed stores
+  uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+private:
+  static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  std::atomic<uint64_t> seq_{0};
+  std::atomic<uint64_t> data_[kWords]{};
+};
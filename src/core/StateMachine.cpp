@@ -1,9 +1,25 @@
 #include "StateMachine.h"
+#include "Diagnostics.h"
+#include "PidGainStore.h"
 #include <cmath>
 #include <algorithm>
 #include <string>
 #include <cstdlib>   
 
+namespace {
+
+// How often the warm-up ETA is re-integrated
+constexpr auto kWarmupEtaRefresh = std::chrono::seconds(5);
+
+// $OVEN_LOG_DIR if set (oven_sim uses it to keep runs out of the real
+// logs), else ~/cure_logs
+std::string cureLogDirectory() {
+  if (const char* dir = std::getenv("OVEN_LOG_DIR"); dir && *dir) return dir;
+  const char* home = std::getenv("HOME");
+  return (home ? std::string(home) : std::string("/home/pi")) + "/cure_logs";
+}
+
+} // namespace
 
 StateMachine::StateMachine(Params p, ITempSensor& air_sensor, ITempSensor& part_sensor,
                            IRelay& f2, IRelay& f, IRelay& greenL, IRelay& redL, IRelay& amberL,
@@ -11,21 +27,52 @@ StateMachine::StateMachine(Params p, ITempSensor& air_sensor, ITempSensor& part_
   : P_(p), air_(air_sensor), part_(part_sensor), fan2_(f2), fan_(f),
     greenL_(greenL), redL_(redL), amberL_(amberL), buzzerL_(buzzerL), contactor_(contactor)
 {
+  // Stream cure logs to disk as they are recorded (binary .ovl, see
+  // CureLog.h); falls back to the in-memory buffer + saveToCSV() if the
+  // directory cannot be created.
+  data_logger_.enableStreaming(cureLogDirectory(), LogFormat::Binary);
+
+  air_pid_.set_gains({P_.pid_kp, P_.pid_ki, P_.pid_kd, P_.pid_d_filter_s, 0.0, 1.0});
+  part_pid_.set_gains({P_.cascade_kp, P_.cascade_ki, 0.0, 0.0, 0.0, P_.cascade_max_boost_c});
+  heat_window_.configure(P_.pid_window_s, P_.pid_min_switch_s);
+
+  PartEstimator::Options est;
+  est.ir_noise_c            = P_.part_ir_noise_c;
+  est.false_alarms_per_hour = P_.part_false_alarms_per_hour;
+  est.confirm_samples       = P_.part_confirm_samples;
+  est.min_drop_c            = P_.ir_drop_delta_c;
+  est.min_wall_c            = P_.part_min_valid_c;
+  for (auto& z : parts_) z.est.configure(est);
+  gains_path_ = pidGainsPath();
+
   enter(State::Idle);
 }
 
+void StateMachine::PartZone::clear(){
+  cure.stop();
+  detected      = false;
+  at_temp       = false;
+  done          = false;
+  timer_running = false;
+  soak_s        = 0.0;
+  step_done     = false;
+}
+
 void StateMachine::enter(State s){
   st_ = s;
   switch(s){
     case State::Idle:
-      cure_timer_running_ = false;
-      part_detected_ = false;
+      loading_ = false;
+      for (auto& z : parts_) {
+        z.clear();
+        z.est.reset();
+      }
 
       greenL_.set(false);
       redL_.set(false);
       amberL_.set(false);
       buzzerL_.set(false);
-      contactor_.set(false);
+      enable_heat(false);
 
       // Reset auto mode state when entering idle
       if (mode_ == OperatingMode::Auto) {
@@ -37,7 +84,7 @@ void StateMachine::enter(State s){
     case State::Warming:
       fan_.set(true);
       fan2_.set(true);
-      contactor_.set(true);
+      enable_heat(true);
       amberL_.set(true);
       greenL_.set(false);
       redL_.set(false);
@@ -45,11 +92,14 @@ void StateMachine::enter(State s){
       break;
 
     case State::Ready:
-      contactor_.set(true);
+      enable_heat(true);
       fan_.set(true);
       fan2_.set(true);
-      part_detected_ = false;
-      part_baseline_c_ = last_part_c_;
+      loading_ = false;
+      for (auto& z : parts_) {
+        z.clear();
+        z.est.arm();
+      }
 
       amberL_.set(true);
       greenL_.set(false);
@@ -58,7 +108,10 @@ void StateMachine::enter(State s){
       break;
 
     case State::Curing:
-      contactor_.set(true);
+      // Zones still loading keep looking (update_load() ends that)
+      for (auto& z : parts_)
+        if (!loading_ || z.detected) z.est.disarm();
+      enable_heat(true);
       fan2_.set(true);
       fan_.set(true);
 
@@ -69,10 +122,10 @@ void StateMachine::enter(State s){
       break;
 
     case State::Shutdown:
-      contactor_.set(false);
+      enable_heat(false);
       fan2_.set(false);
       fan_.set(false);
-      cure_timer_running_ = false;
+      for (auto& z : parts_) z.timer_running = false;
 
       amberL_.set(true);
       greenL_.set(true);
@@ -81,10 +134,10 @@ void StateMachine::enter(State s){
       break;
 
     case State::Fault:
-      contactor_.set(false);
+      enable_heat(false);
       fan2_.set(true);
       fan_.set(true);
-      cure_timer_running_ = false;
+      for (auto& z : parts_) z.timer_running = false;
 
       redL_.set(true);
       amberL_.set(false);
@@ -94,10 +147,10 @@ void StateMachine::enter(State s){
 
     case State::AutoCureComplete:
       // Turn everything off except fans (for cooling)
-      contactor_.set(false);
+      enable_heat(false);
       fan2_.set(true);
       fan_.set(true);
-      cure_timer_running_ = false;
+      for (auto& z : parts_) z.timer_running = false;
 
       // Only green light on - stack light will flash automatically
       greenL_.set(true);
@@ -108,13 +161,10 @@ void StateMachine::enter(State s){
       // Mark cure as complete for UI
       auto_cure_complete_ = true;
 
-      // Stop & save log
       // Stop & save log
       if (data_logger_.isLogging()) {
         data_logger_.stopSession();
-        const char* home = std::getenv("HOME");
-        std::string outdir = (home ? std::string(home) : std::string("/home/pi")) + "/cure_logs";
-        data_logger_.saveToCSV(outdir);
+        data_logger_.saveToCSV(cureLogDirectory());
       }
 
       break;
@@ -143,19 +193,48 @@ void StateMachine::command_enterFault()    { mode_ = OperatingMode::Manual; ente
 
 // Auto mode commands
 void StateMachine::command_startAutoMode(double target_temp) {
+  command_startAutoMode(target_temp,
+                        CureProfile::arrhenius(target_temp, P_.auto_cure_duration_seconds,
+                                               P_.auto_target_temp_tolerance_c, P_.cure_ea_j_mol));
+}
+
+void StateMachine::command_startAutoMode(double target_temp, const CureProfile& cure) {
+  command_startRecipe(Recipe::single(target_temp, cure, P_.auto_target_temp_tolerance_c));
+}
+
+void StateMachine::command_startRecipe(const Recipe& recipe) {
+  if (!recipe.check().empty()) return;
+
   mode_ = OperatingMode::Auto;
-  auto_target_temp_ = target_temp;
+  auto_target_temp_ = recipe.load_c;
   auto_part_at_temp_ = false;
   auto_cure_complete_ = false;
-  part_detected_ = false;
-
-  // Set targets
-  P_.air_target_c  = target_temp;
-  P_.part_target_c = target_temp;
+  recipe_  = recipe;
+  seg_     = 0;
+  ramping_ = false;
+  for (auto& z : parts_) z.clear();
+  preheat_pending_ = false;      // started now, by schedule or by hand
+  warmup_eta_at_ = {};
+
+  // Warm to the load temperature; the segments take over from the part
+  // detection
+  P_.air_target_c  = recipe.load_c;
+  P_.part_target_c = recipe.load_c;
+
+  // Gains tuned for this recipe if autotune has been run for it (or at its
+  // hottest step), else the Params defaults
+  PidGains saved{P_.pid_kp, P_.pid_ki, P_.pid_kd};
+  if (!loadPidGains(gains_path_, recipe.key, saved))
+    loadPidGains(gains_path_, Recipe::keyFor(recipe.max_c()), saved);
+  Pid::Gains g = air_pid_.gains();
+  g.kp = saved.kp;
+  g.ki = saved.ki;
+  g.kd = saved.kd;
+  setPidGains(g);
 
   // Start logging
   if (!data_logger_.isLogging()) {
-    data_logger_.startSession(target_temp);
+    data_logger_.startSession(recipe.load_c, n_parts_);
   }
 
   // Start warming
@@ -168,12 +247,10 @@ void StateMachine::command_cancelAutoMode() {
   auto_cure_complete_ = false;
 
   // Stop & save log
-if (data_logger_.isLogging()) {
-  data_logger_.stopSession();
-  const char* home = std::getenv("HOME");
-  std::string outdir = (home ? std::string(home) : std::string("/home/pi")) + "/cure_logs";
-  data_logger_.saveToCSV(outdir);
-}
+  if (data_logger_.isLogging()) {
+    data_logger_.stopSession();
+    data_logger_.saveToCSV(cureLogDirectory());
+  }
 
   enter(State::Idle);
 }
@@ -186,23 +263,304 @@ void StateMachine::command_acknowledgeAutoCureComplete() {
   }
 }
 
+void StateMachine::command_schedulePreheat(double target_c,
+                                           std::chrono::steady_clock::time_point by) {
+  command_schedulePreheat(
+      Recipe::single(target_c,
+                     CureProfile::arrhenius(target_c, P_.auto_cure_duration_seconds,
+                                            P_.auto_target_temp_tolerance_c, P_.cure_ea_j_mol),
+                     P_.auto_target_temp_tolerance_c),
+      by);
+}
+
+void StateMachine::command_schedulePreheat(const Recipe& recipe,
+                                           std::chrono::steady_clock::time_point by) {
+  preheat_pending_  = true;
+  preheat_target_c_ = recipe.load_c;
+  preheat_recipe_   = recipe;
+  preheat_by_       = by;
+  warmup_eta_at_    = {};
+}
+
+void StateMachine::command_cancelPreheat() {
+  preheat_pending_ = false;
+}
+
+int StateMachine::learnHeatupFromLogs(size_t max_files) {
+  return heatup_.learn_from_logs(cureLogDirectory(), max_files);
+}
+
+void StateMachine::command_startAutotune(double setpoint_c, const std::string& recipe_key) {
+  if (data_logger_.isLogging()) data_logger_.stopSession();
+
+  mode_ = OperatingMode::Autotune;
+  auto_part_at_temp_ = false;
+  auto_cure_complete_ = false;
+
+  autotune_opt_ = RelayAutotune::Options{};
+  autotune_opt_.setpoint_c = setpoint_c;
+  autotune_key_ = recipe_key;
+  autotune_pending_ = true;
+  ++autotune_starts_;
+
+  // Fans and lamps as in Warming; the relay owns the contactor from here
+  enter(State::Warming);
+}
+
+void StateMachine::command_cancelAutotune() {
+  if (mode_ != OperatingMode::Autotune) return;
+  autotune_pending_ = false;
+  autotune_.cancel();
+  mode_ = OperatingMode::Manual;
+  enter(State::Idle);
+}
+
+void StateMachine::setAirZones(const std::vector<AirZone>& zones) {
+  AirFusion::Options opt;
+  opt.vote_min_c  = P_.air_zone_vote_c;
+  opt.vote_frames = P_.air_zone_vote_frames;
+  air_fusion_.configure(zones, opt);
+}
+
+void StateMachine::setPartZones(const std::vector<int>& ir_channels) {
+  n_parts_ = std::clamp<size_t>(ir_channels.size(), 1, kMaxPartZones);
+  for (size_t i = 0; i < kMaxPartZones; ++i) {
+    PartZone& z = parts_[i];
+    if (i < ir_channels.size()) z.channel = ir_channels[i];
+    z.clear();
+    z.est.reset();
+    z.ir_c = std::numeric_limits<double>::quiet_NaN();
+  }
+  loading_ = false;
+}
+
+PartZoneStatus StateMachine::partZone(size_t zone) const {
+  PartZoneStatus s;
+  if (zone >= n_parts_) return s;
+  const PartZone& z = parts_[zone];
+  s.channel       = z.channel;
+  s.detected      = z.detected;
+  s.at_temp       = z.at_temp;
+  s.done          = z.done;
+  if (!z.detected) return s;
+  s.part_c        = z.part_c();
+  s.cure_progress = zone_progress(z);
+  const double left = zone_remaining_s(z);
+  s.seconds_left = std::isnan(left) ? 0 : static_cast<int>(std::ceil(left));
+  return s;
+}
+
+void StateMachine::setPidGains(const Pid::Gains& g) {
+  air_pid_.set_gains(g);
+}
+
+ControlStatus StateMachine::status() const {
+  ControlStatus s;
+  s.state                  = st_;
+  s.mode                   = mode_;
+  s.air_c                  = last_air_c_;
+  s.ir_c                   = last_part_c_;
+  s.air                    = air_fusion_.result();
+  s.part_detected          = part_detected();
+  s.part_c                 = part_c();
+  s.seconds_left           = seconds_left();
+  s.auto_target_temp       = auto_target_temp_;
+  s.auto_part_at_temp      = auto_part_at_temp_;
+  s.auto_cure_complete     = auto_cure_complete_;
+  s.heat_duty              = heat_duty_;
+  s.air_setpoint_c         = air_setpoint_c_;
+  s.part_rate_c_min        = part_rate_c_s() * 60.0;
+  s.part_eta_s             = part_eta_s();
+  s.cure_progress          = cure_progress();
+  s.recipe_segment         = static_cast<int>(seg_);
+  s.recipe_segments        = static_cast<int>(recipe_.segments.size());
+  s.recipe_ramping         = ramping_;
+  s.segment_soak_c         = recipe_.segments.empty() ? 0.0 : segment().soak_c;
+  s.part_zones             = static_cast<int>(n_parts_);
+  for (size_t i = 0; i < n_parts_; ++i) s.parts[i] = partZone(i);
+  s.warmup_eta_s           = warmup_eta_s_;
+  s.preheat_pending        = preheat_pending_;
+  s.preheat_target_c       = preheat_target_c_;
+  s.preheat_start_in_s     = preheat_start_in_s_;
+  s.pid_gains              = air_pid_.gains();
+  s.autotune_phase         = autotune_.phase();
+  s.autotune_cycles        = autotune_.cycles_done();
+  s.autotune_cycles_needed = autotune_.cycles_needed();
+  s.autotune_failure       = autotune_.failure();
+  s.autotune_starts        = autotune_starts_;
+  s.log_in_memory          = data_logger_.isLogging() && !data_logger_.streamError().empty();
+  return s;
+}
+
 int StateMachine::seconds_left() const {
-  if(!cure_timer_running_) return 0;
-  auto now  = std::chrono::steady_clock::now();
-  auto left = std::chrono::duration_cast<std::chrono::seconds>(cure_ends_ - now).count();
-  return left > 0 ? static_cast<int>(left) : 0;
+  // The last part to finish: auto, the rest of the recipe at each part's
+  // current temperature; manual, the dwell timers
+  const auto now = std::chrono::steady_clock::now();
+  int longest = 0;
+  for (size_t i = 0; i < n_parts_; ++i) {
+    const PartZone& z = parts_[i];
+    if (mode_ == OperatingMode::Auto) {
+      const double left = zone_remaining_s(z);
+      if (!std::isnan(left)) longest = std::max(longest, static_cast<int>(std::ceil(left)));
+    } else if (z.timer_running) {
+      const auto left = std::chrono::duration_cast<std::chrono::seconds>(z.cure_ends - now).count();
+      longest = std::max(longest, static_cast<int>(left));
+    }
+  }
+  return longest;
+}
+
+bool StateMachine::part_detected() const {
+  for (size_t i = 0; i < n_parts_; ++i)
+    if (parts_[i].detected) return true;
+  return false;
+}
+
+double StateMachine::part_c() const {
+  const int lag = lagging_zone();
+  return lag < 0 ? std::numeric_limits<double>::quiet_NaN() : parts_[lag].part_c();
+}
+
+double StateMachine::part_rate_c_s() const {
+  const int lag = lagging_zone();
+  return lag < 0 ? std::numeric_limits<double>::quiet_NaN() : parts_[lag].est.part_rate_c_s();
+}
+
+double StateMachine::cure_progress() const {
+  double least = 1.0;
+  bool any = false;
+  for (size_t i = 0; i < n_parts_; ++i) {
+    if (!parts_[i].detected) continue;
+    least = std::min(least, zone_progress(parts_[i]));
+    any = true;
+  }
+  return any ? least : 0.0;
+}
+
+// Share of the running segment a zone has done, 0..1
+double StateMachine::segment_progress(const PartZone& z) const {
+  if (recipe_.segments.empty() || !z.detected) return 0.0;
+  if (z.step_done || z.done) return 1.0;
+  const RecipeSegment& s = segment();
+  switch (s.basis) {
+    case RecipeSegment::Basis::Air:  return s.soak_s > 0 ? std::min(air_soak_s_ / s.soak_s, 1.0) : 0.0;
+    case RecipeSegment::Basis::Part: return s.soak_s > 0 ? std::min(z.soak_s / s.soak_s, 1.0) : 0.0;
+    case RecipeSegment::Basis::Cure: return std::min(z.cure.progress(), 1.0);
+  }
+  return 0.0;
+}
+
+// Share of the whole recipe a zone has done: segments behind it plus the
+// running one's share. Auto only.
+double StateMachine::zone_progress(const PartZone& z) const {
+  if (mode_ != OperatingMode::Auto || recipe_.segments.empty()) return 0.0;
+  return (static_cast<double>(seg_) + segment_progress(z)) / recipe_.segments.size();
+}
+
+// Seconds until a zone finishes the recipe: what is left of the running
+// segment (cure at the part's current rate where that is known, else ramp
+// plus nominal soak), then the later segments' ramps and soaks
+double StateMachine::zone_remaining_s(const PartZone& z) const {
+  if (mode_ != OperatingMode::Auto || recipe_.segments.empty() || !z.detected || z.done) return 0.0;
+
+  const RecipeSegment& s = segment();
+  double left = 0.0;
+  if (!z.step_done) {
+    const double ramp_s = ramping_ && s.ramp_c_min > 0
+                            ? std::fabs(s.soak_c - ramp_sp_c_) / s.ramp_c_min * 60.0
+                            : 0.0;
+    left = (s.basis == RecipeSegment::Basis::Cure) ? z.cure.remaining_s()
+                                                   : std::numeric_limits<double>::quiet_NaN();
+    if (std::isnan(left)) left = ramp_s + s.soak_s * (1.0 - segment_progress(z));
+  }
+
+  double from_c = s.soak_c;
+  for (size_t i = seg_ + 1; i < recipe_.segments.size(); ++i) {
+    const RecipeSegment& next = recipe_.segments[i];
+    if (next.ramp_c_min > 0) left += std::fabs(next.soak_c - from_c) / next.ramp_c_min * 60.0;
+    left += next.soak_s;
+    from_c = next.soak_c;
+  }
+  return left;
+}
+
+// The detected zone furthest from done decides the load: not done before
+// done, then least far through the segment, then coldest. -1 if no zone has a part.
+int StateMachine::lagging_zone() const {
+  int lag = -1;
+  for (size_t i = 0; i < n_parts_; ++i) {
+    const PartZone& z = parts_[i];
+    if (!z.detected) continue;
+    if (lag < 0) { lag = static_cast<int>(i); continue; }
+    const PartZone& l = parts_[lag];
+    bool behind;
+    if (z.done != l.done)                                behind = l.done;
+    else if (segment_progress(z) != segment_progress(l)) behind = segment_progress(z) < segment_progress(l);
+    else                                                 behind = z.part_c() < l.part_c();
+    if (behind) lag = static_cast<int>(i);
+  }
+  return lag;
+}
+
+// Every zone with a part is done, and no other zone can still get one
+bool StateMachine::load_complete() const {
+  if (loading_ || !part_detected()) return false;
+  for (size_t i = 0; i < n_parts_; ++i)
+    if (parts_[i].detected && !parts_[i].done) return false;
+  return true;
 }
 
 void StateMachine::tick(std::chrono::steady_clock::time_point now){
-  last_air_c_  = air_.read_celsius();
-  last_part_c_ = part_.read_celsius();
+  // Per zone: the IR reading and whether it is new; when it was taken
+  std::chrono::steady_clock::time_point part_t = now;
+
+  if (samples_) {
+    const SampleFrame f = samples_->load();
+    if (diag_ && f.seq != 0) diag_->sample_age.record(now - f.acquired);
+
+    for (size_t i = 0; i < n_parts_; ++i) {
+      PartZone& z = parts_[i];
+      const int slot = f.slot(z.channel);
+      z.ir_c  = f.value_of(z.channel);
+      z.fresh = f.seq != sample_seq_ && slot >= 0 && f.quality[slot] == kSampleOk;
+    }
+    part_t = f.acquired;
+
+    if (f.seq != sample_seq_) {
+      sample_seq_ = f.seq;
+      air_fusion_.update(f);
+      logCurrentState(f);
+    }
+    last_air_c_ = air_fusion_.result().air_c;
+  } else {
+    last_air_c_     = air_.read_celsius();
+    parts_[0].ir_c  = part_.read_celsius();
+    parts_[0].fresh = true;
+  }
+  last_part_c_ = parts_[0].ir_c;
 
   if(std::isnan(last_air_c_) || std::isnan(last_part_c_) || fault_){
+    if (mode_ == OperatingMode::Autotune) {
+      autotune_pending_ = false;
+      autotune_.cancel();
+      mode_ = OperatingMode::Manual;
+    }
     enter(State::Fault);
     return;
   }
 
-  update_part_detection();
+  update_preheat(now);
+
+  // The relay experiment owns the contactor; no state logic meanwhile
+  if (mode_ == OperatingMode::Autotune) {
+    update_autotune(now);
+    return;
+  }
+
+  update_part_detection(part_t);
+  update_cure(part_t);
+  if (parts_[0].fresh) update_heatup(part_t);
+  update_load(now);
 
   // Route to auto or manual state handlers
   if (mode_ == OperatingMode::Auto) {
@@ -226,6 +584,78 @@ void StateMachine::tick(std::chrono::steady_clock::time_point now){
       case State::AutoCureComplete: /* shouldn't happen in manual */ break;
     }
   }
+
+  update_heat(now);
+}
+
+// ===== Heat control =====
+void StateMachine::enable_heat(bool on){
+  if(!on || !P_.pid_enabled){
+    heat_enabled_ = false;
+    heat_duty_    = on ? 1.0 : 0.0;
+    contactor_.set(on);
+    return;
+  }
+
+  // Warming -> Ready -> Curing keeps the loop running (bumpless);
+  // only a start from cold resets it
+  if(!heat_enabled_){
+    air_pid_.reset(0.0);
+    part_pid_.reset(0.0);
+    heat_window_.restart();
+    last_heat_ = {};
+  }
+  heat_enabled_ = true;
+}
+
+double StateMachine::air_setpoint(double dt_s){
+  // Cascade: the error of the part that decides the load raises the air
+  // setpoint
+  const int lag = lagging_zone();
+  // while it soaks; during a recipe ramp the ramp alone sets the air
+  if(P_.pid_cascade && st_ == State::Curing && !ramping_ && lag >= 0 &&
+     !std::isnan(parts_[lag].ir_c)){
+    const double boost = part_pid_.update(P_.part_target_c, parts_[lag].ir_c, dt_s);
+    return std::max(P_.air_target_c, P_.part_target_c + boost);
+  }
+  return P_.air_target_c;
+}
+
+void StateMachine::update_autotune(std::chrono::steady_clock::time_point now){
+  if (autotune_pending_) {
+    autotune_pending_ = false;
+    autotune_epoch_ = now;
+    autotune_.start(autotune_opt_, air_pid_.gains(), 0.0);
+  }
+
+  const double t = std::chrono::duration<double>(now - autotune_epoch_).count();
+  const bool on = autotune_.update(last_air_c_, t);
+  contactor_.set(on);
+  heat_duty_ = on ? 1.0 : 0.0;
+  air_setpoint_c_ = autotune_opt_.setpoint_c;
+
+  if (autotune_.running()) return;
+
+  if (autotune_.phase() == RelayAutotune::Phase::Done) {
+    const Pid::Gains& g = autotune_.result().gains;
+    setPidGains(g);
+    savePidGains(gains_path_, autotune_key_, PidGains{g.kp, g.ki, g.kd});
+  }
+  mode_ = OperatingMode::Manual;
+  enter(State::Idle);
+}
+
+void StateMachine::update_heat(std::chrono::steady_clock::time_point now){
+  if(!heat_enabled_) return;
+
+  const double dt = (last_heat_ == std::chrono::steady_clock::time_point{})
+                      ? 0.0
+                      : std::chrono::duration<double>(now - last_heat_).count();
+  last_heat_ = now;
+
+  air_setpoint_c_ = air_setpoint(dt);
+  heat_duty_      = air_pid_.update(air_setpoint_c_, last_air_c_, dt);
+  contactor_.set(heat_window_.update(heat_duty_, now));
 }
 
 // Manual mode updates
@@ -253,21 +683,27 @@ void StateMachine::update_warming(){
 }
 
 void StateMachine::update_ready(std::chrono::steady_clock::time_point /*now*/){
-  if(part_detected_ ){
+  if(part_detected()){
     enter(State::Curing);
   }
 }
 
 void StateMachine::update_curing(std::chrono::steady_clock::time_point now){
-  double pc = part_c();
-  bool part_hot = !std::isnan(pc) && pc >= P_.part_target_c;
-
-  if(part_hot){
-    cure_timer_running_ = true;
-    cure_ends_ = now + std::chrono::seconds(P_.dwell_seconds);
+  // Each part dwells from when it is at temperature
+  for (size_t i = 0; i < n_parts_; ++i) {
+    PartZone& z = parts_[i];
+    if (!z.detected || z.done) continue;
+
+    const double pc = z.part_c();
+    z.at_temp = !std::isnan(pc) && pc >= P_.part_target_c;
+    if(z.at_temp){
+      z.timer_running = true;
+      z.cure_ends = now + std::chrono::seconds(P_.dwell_seconds);
+    }
+    z.done = z.timer_running && now >= z.cure_ends;
   }
 
-  if(cure_timer_running_ && now >= cure_ends_){
+  if(load_complete()){
     enter(State::Idle);
   }
 }
@@ -287,41 +723,105 @@ void StateMachine::update_auto_warming(){
 
 void StateMachine::update_auto_ready(std::chrono::steady_clock::time_point /*now*/){
   // Wait for part detection (IR drop) — update_part_detection() is called in tick()
-  if(part_detected_){
-    // Part inserted, go to curing
+  if(part_detected()){
+    // Part inserted, go to curing; the recipe runs from here
     enter(State::Curing);
-    cure_timer_running_ = false; // Don't start timer yet
     auto_part_at_temp_ = false;
+    ramp_sp_c_ = P_.air_target_c;
+    recipe_t_  = {};
+    begin_segment(0);
   }
 }
 
 void StateMachine::update_auto_curing(std::chrono::steady_clock::time_point now){
-  // Control temperature based on part sensor
+  update_recipe(now);
 
-  // Check if part is within tolerance (±10°C)
-  bool part_in_range = std::abs(last_part_c_ - P_.part_target_c) <= P_.auto_target_temp_tolerance_c;
+  if(load_complete()){
+    // Instead of Shutdown, go to AutoCureComplete
+    enter(State::AutoCureComplete);
+  }
+}
 
-  if(part_in_range){
-    // Start timer if not already started
-    if(!cure_timer_running_){
-      cure_timer_running_ = true;
-      cure_ends_ = now + std::chrono::seconds(P_.auto_cure_duration_seconds);
-      auto_part_at_temp_ = true;
-    }
+void StateMachine::begin_segment(size_t seg){
+  seg_ = seg;
+  const RecipeSegment& s = segment();
+  ramping_ = s.ramp_c_min > 0 && ramp_sp_c_ != s.soak_c;
+  if (!ramping_) ramp_sp_c_ = s.soak_c;
+  air_soak_s_ = 0.0;
+
+  P_.air_target_c   = ramp_sp_c_;
+  P_.part_target_c  = s.soak_c;
+  auto_target_temp_ = s.soak_c;
+
+  for (size_t i = 0; i < n_parts_; ++i) {
+    PartZone& z = parts_[i];
+    z.soak_s    = 0.0;
+    z.step_done = false;
+    z.at_temp   = false;
+    if (z.detected && s.basis == RecipeSegment::Basis::Cure) z.cure.start(s.cure);
+    else                                                     z.cure.stop();
+  }
+}
+
+// Ramps the air setpoint, counts the soak and moves to the next segment
+// once every part in the load has met this one. Cure equivalence accrues
+// in update_cure() on every part reading: a hotter part cures faster, and
+// a reading below the profile only pauses it. At temperature = the soak is
+// currently counting, for every part still in it.
+void StateMachine::update_recipe(std::chrono::steady_clock::time_point now){
+  const double dt = recipe_t_ == std::chrono::steady_clock::time_point{}
+                      ? 0.0
+                      : std::chrono::duration<double>(now - recipe_t_).count();
+  recipe_t_ = now;
+  const RecipeSegment& s = segment();
+
+  if (ramping_) {
+    const double step = s.ramp_c_min / 60.0 * dt;
+    ramp_sp_c_ = ramp_sp_c_ < s.soak_c ? std::min(ramp_sp_c_ + step, s.soak_c)
+                                       : std::max(ramp_sp_c_ - step, s.soak_c);
+    ramping_ = ramp_sp_c_ != s.soak_c;
+    P_.air_target_c = ramp_sp_c_;
+  }
 
-    // Check if cure time is complete
-    if(now >= cure_ends_){
-      cure_timer_running_ = false;
-      // Instead of Shutdown, go to AutoCureComplete
-      enter(State::AutoCureComplete);
+  const bool air_in = !ramping_ && std::fabs(last_air_c_ - s.soak_c) <= s.tolerance_c;
+  if (s.basis == RecipeSegment::Basis::Air && air_in) air_soak_s_ += dt;
+
+  const bool last = seg_ + 1 == recipe_.segments.size();
+  bool all_done = true;
+  bool all_at_temp = true;
+  for (size_t i = 0; i < n_parts_; ++i) {
+    PartZone& z = parts_[i];
+    if (!z.detected || z.step_done) continue;
+    switch (s.basis) {
+      case RecipeSegment::Basis::Air:
+        z.at_temp   = air_in;
+        z.step_done = air_soak_s_ >= s.soak_s;
+        break;
+      case RecipeSegment::Basis::Part:
+        z.at_temp = !ramping_ && std::fabs(z.part_c() - s.soak_c) <= s.tolerance_c;
+        if (z.at_temp) z.soak_s += dt;
+        z.step_done = !ramping_ && z.soak_s >= s.soak_s;
+        break;
+      case RecipeSegment::Basis::Cure:
+        z.at_temp = z.cure.rate_per_s() > 0;
+        if (z.cure.done()) {
+          z.cure.stop();
+          z.step_done = true;
+        }
+        break;
     }
-  } else {
-    // Part fell out of range, reset timer
-    if(cure_timer_running_){
-      cure_timer_running_ = false;
-      auto_part_at_temp_ = false;
+    if (z.step_done) {
+      z.at_temp = false;
+      z.done    = last;
     }
+    all_done    = all_done && z.step_done;
+    all_at_temp = all_at_temp && (z.step_done || z.at_temp);
   }
+  auto_part_at_temp_ = part_detected() && all_at_temp;
+
+  // The load moves on together; a zone still loading holds it back
+  if (last || !all_done || loading_ || !part_detected()) return;
+  begin_segment(seg_ + 1);
 }
 
 void StateMachine::update_auto_cure_complete(std::chrono::steady_clock::time_point /*now*/){
@@ -331,56 +831,129 @@ void StateMachine::update_auto_cure_complete(std::chrono::steady_clock::time_poi
   // Stay in this state until user acknowledges (command_acknowledgeAutoCureComplete)
 }
 
-void StateMachine::update_part_detection(){
-  if (st_ != State::Ready || part_detected_) return;
+// Runs on every new IR reading so the wall baseline is learnt before Ready;
+// an estimator only looks for a part while armed (Ready, and Curing while
+// the load is still coming in)
+void StateMachine::update_part_detection(std::chrono::steady_clock::time_point t){
+  for (size_t i = 0; i < n_parts_; ++i) {
+    PartZone& z = parts_[i];
+    if (!z.fresh) continue;
+    const bool found = z.est.update(z.ir_c, t);
+    if (!found || z.detected) continue;
+    if (st_ != State::Ready && !(st_ == State::Curing && loading_)) continue;
+
+    // The first part opens the load window for the rest of the rack
+    if (!part_detected()) {
+      loading_     = n_parts_ > 1;
+      load_closes_ = t + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                           std::chrono::duration<double>(P_.part_zone_load_window_s));
+    }
+    z.detected = true;
+    if (st_ == State::Curing) {
+      z.est.disarm();
+      if (mode_ == OperatingMode::Auto && segment().basis == RecipeSegment::Basis::Cure)
+        z.cure.start(segment().cure);
+    }
+  }
+}
 
-  if (std::isnan(part_baseline_c_)) part_baseline_c_ = last_part_c_;
+void StateMachine::update_cure(std::chrono::steady_clock::time_point t){
+  if (mode_ != OperatingMode::Auto || st_ != State::Curing) return;
+  // Filtered part temperature, so noise does not inflate the Arrhenius term
+  for (size_t i = 0; i < n_parts_; ++i) {
+    PartZone& z = parts_[i];
+    if (z.fresh && z.cure.running()) z.cure.add(z.part_c(), t);
+  }
+}
 
-  part_baseline_c_ = (1.0 - part_baseline_alpha_) * part_baseline_c_
-                   +  part_baseline_alpha_       * last_part_c_;
+// Closes the load once every zone has a part or the window runs out; an
+// empty zone stops looking, so a later IR dip there is not a new part
+void StateMachine::update_load(std::chrono::steady_clock::time_point now){
+  if (!loading_) return;
+  bool all = true;
+  for (size_t i = 0; i < n_parts_; ++i) all = all && parts_[i].detected;
+  if (!all && now < load_closes_) return;
+
+  loading_ = false;
+  for (auto& z : parts_)
+    if (!z.detected) z.est.disarm();
+}
 
-  const bool   wall_hot_enough = (part_baseline_c_ >= P_.part_min_valid_c);
-  const double drop            = part_baseline_c_ - last_part_c_;
-  const bool   big_drop        = (drop >= P_.ir_drop_delta_c);
+// Learns from every warm-up, auto or manual: the IR channel sees the back
+// wall while no part is in, which gives the model its residual-heat term
+void StateMachine::update_heatup(std::chrono::steady_clock::time_point t){
+  if (st_ == State::Warming) {
+    if (!heatup_.warming()) heatup_.begin(P_.air_target_c, t);
+    heatup_.add(last_air_c_, last_part_c_, t);
+  } else if (heatup_.warming()) {
+    if (st_ == State::Ready) heatup_.end(t);
+    else                     heatup_.abort();
+  }
 
-  if (wall_hot_enough && big_drop) {
-    part_detected_ = true;
+  const bool want = (st_ == State::Warming) || (st_ == State::Idle && preheat_pending_);
+  if (!want) {
+    warmup_eta_s_ = std::numeric_limits<double>::quiet_NaN();
+    return;
   }
+  if (warmup_eta_at_ != std::chrono::steady_clock::time_point{} &&
+      t - warmup_eta_at_ < kWarmupEtaRefresh) return;
+
+  warmup_eta_at_ = t;
+  warmup_eta_s_  = heatup_.eta_s(last_air_c_, last_part_c_,
+                                 st_ == State::Warming ? P_.air_target_c : preheat_target_c_);
+}
+
+void StateMachine::update_preheat(std::chrono::steady_clock::time_point now){
+  // Wait for the first ETA after scheduling (update_heatup() computes it)
+  if (!preheat_pending_ || warmup_eta_at_ == std::chrono::steady_clock::time_point{}) return;
+
+  const double lead_s = std::isnan(warmup_eta_s_)
+                          ? P_.preheat_fallback_s
+                          : warmup_eta_s_ + P_.preheat_margin_s;
+  preheat_start_at_ = preheat_by_ - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double>(lead_s));
+  preheat_start_in_s_ = std::chrono::duration<double>(preheat_start_at_ - now).count();
+  if (now < preheat_start_at_) return;
+
+  preheat_pending_ = false;
+  if (st_ != State::Idle) return;   // oven already in use
+  command_startRecipe(preheat_recipe_);
+}
+
+double StateMachine::part_eta_s() const {
+  const int lag = lagging_zone();
+  if (lag < 0) return std::numeric_limits<double>::quiet_NaN();
+  const double tol  = recipe_.segments.empty() ? P_.auto_target_temp_tolerance_c
+                                               : segment().tolerance_c;
+  const double band = (mode_ == OperatingMode::Auto) ? P_.part_target_c - tol
+                                                     : P_.part_target_c;
+  return parts_[lag].est.time_to_target_s(band, last_air_c_);
 }
 
 // ===== Data logging bridge =====
-void StateMachine::logCurrentState(const std::vector<double>& temps) {
+void StateMachine::logCurrentState(const SampleFrame& frame) {
   // Log only during AUTO mode and when logger is active
   if (mode_ != OperatingMode::Auto || !data_logger_.isLogging()) return;
 
   // We expect at least 6 channels (CH1..CH6). CH4 is intentionally skipped.
-  if (temps.size() < 6) return;
-
-  // Map channels:
-  // CH1 = temps[0] (Air)
-  // CH2 = temps[1]
-  // CH3 = temps[2]
-  // CH5 = temps[4]
-  // CH6 = temps[5] (IR/Part)
-  const double ch1 = temps[0];
-  const double ch2 = temps[1];
-  const double ch3 = temps[2];
-  const double ch5 = temps[4];
-  const double ch6 = temps[5];
+  if (frame.count < 6) return;
+
+  // CH1 = Air, CH6 = IR/Part
+  const double ch1 = frame.value_of(1);
+  const double ch2 = frame.value_of(2);
+  const double ch3 = frame.value_of(3);
+  const double ch5 = frame.value_of(5);
+  const double ch6 = frame.value_of(6);
+
+  // Part temperature and cure per zone
+  ZonePoint zones[kMaxPartZones];
+  for (size_t i = 0; i < n_parts_; ++i) {
+    const PartZone& z = parts_[i];
+    zones[i].part_c   = z.detected ? z.part_c() : std::numeric_limits<double>::quiet_NaN();
+    zones[i].cure_pct = z.detected ? std::min(z.cure.progress(), 1.0) * 100.0 : 0.0;
+  }
 
   // DataLogger stores setpoint internally from startSession()
-  data_logger_.logPoint(ch1, ch2, ch3, ch5, ch6, stateToString(st_));
-}
-
-std::string StateMachine::stateToString(State s) {
-  switch (s) {
-    case State::Idle:             return "Idle";
-    case State::Warming:          return "Warming";
-    case State::Ready:            return "Ready";
-    case State::Curing:           return "Curing";
-    case State::Shutdown:         return "Shutdown";
-    case State::Fault:            return "Fault";
-    case State::AutoCureComplete: return "AutoCureComplete";
-  }
-  return "Unknown";
+  const AirFusion::Result& air = air_fusion_.result();
+  data_logger_.logPoint(ch1, ch2, ch3, ch5, ch6, air.air_c, air.spread_c, zones, st_);
 }
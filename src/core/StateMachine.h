@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <limits>
 #include <vector>
@@ -9,8 +11,72 @@
 #include "../hw/ITempSensor.h"
 #include "../hw/IRelay.h"
 #include "Events.h"
+#include "SampleFrame.h"
+#include "AirFusion.h"
+#include "Pid.h"
+#include "PartEstimator.h"
+#include "CureIntegrator.h"
+#include "Recipe.h"
+#include "HeatupModel.h"
+#include "RelayAutotune.h"
 #include "../data/DataLogger.h"
 
+class Diagnostics;
+
+// One part zone, as the UI and the log see it
+struct PartZoneStatus {
+  int    channel{0};          // IR channel
+  bool   detected{false};     // has a part in this load
+  bool   at_temp{false};      // auto: cure counting; manual: at part_target_c
+  bool   done{false};
+  double part_c{std::numeric_limits<double>::quiet_NaN()};
+  double cure_progress{0.0};  // auto, 0..1
+  int    seconds_left{0};
+};
+
+// Everything the UI reads from the state machine, as one copyable value.
+// Published by ControlExecutor when tick() runs on its own thread.
+struct ControlStatus {
+  State                state{State::Idle};
+  OperatingMode        mode{OperatingMode::Manual};
+  double               air_c{std::numeric_limits<double>::quiet_NaN()};
+  double               ir_c{std::numeric_limits<double>::quiet_NaN()};
+  AirFusion::Result    air{};               // zone fusion behind air_c (bus source only)
+  bool                 part_detected{false};
+  double               part_c{std::numeric_limits<double>::quiet_NaN()};   // see part_c()
+  int                  seconds_left{0};
+  double               auto_target_temp{0.0};
+  bool                 auto_part_at_temp{false};
+  bool                 auto_cure_complete{false};
+  double               heat_duty{0.0};       // PID output, 0..1
+  double               air_setpoint_c{std::numeric_limits<double>::quiet_NaN()};
+  double               part_rate_c_min{std::numeric_limits<double>::quiet_NaN()};
+  double               part_eta_s{std::numeric_limits<double>::quiet_NaN()};   // to the cure band
+  double               cure_progress{0.0};   // auto Curing, 0..1 (slowest part, whole recipe)
+  int                  recipe_segment{0};    // auto Curing: 0-based segment running
+  int                  recipe_segments{0};
+  bool                 recipe_ramping{false};
+  double               segment_soak_c{0.0};
+  std::array<PartZoneStatus, kMaxPartZones> parts{};
+  int                  part_zones{1};
+  double               warmup_eta_s{std::numeric_limits<double>::quiet_NaN()};
+  bool                 preheat_pending{false};
+  double               preheat_target_c{0.0};
+  double               preheat_start_in_s{0.0};
+
+  // PID gains in use, and the relay autotune (OperatingMode::Autotune)
+  Pid::Gains           pid_gains{};
+  RelayAutotune::Phase autotune_phase{RelayAutotune::Phase::Idle};
+  int                  autotune_cycles{0};
+  int                  autotune_cycles_needed{0};
+  const char*          autotune_failure{""};   // static string
+  int                  autotune_starts{0};     // command_startAutotune() calls so far
+
+  // The cure log could not be opened for streaming and is buffered in
+  // memory, to be written when the session ends
+  bool                 log_in_memory{false};
+};
+
 class StateMachine {
 public:
   StateMachine(Params p, ITempSensor& air_sensor, ITempSensor& part_sensor,
@@ -19,6 +85,36 @@ public:
 
   void tick(std::chrono::steady_clock::time_point now);
 
+  // Read air and part from one coherent SampleFrame per tick instead of the
+  // two ITempSensor references (channels are THKA channel ids). Each new
+  // frame is also passed to logCurrentState() by tick(). The air channel
+  // is the only air zone and the part channel the only part zone until
+  // setAirZones() / setPartZones().
+  void setSampleSource(const SampleBus* bus, int air_channel, int part_channel) {
+    samples_ = bus;
+    air_channel_ = air_channel;
+    setAirZones({{air_channel, 1.0}});
+    setPartZones({part_channel});
+  }
+
+  // Chamber thermocouples fused into the controlled air temperature (see
+  // AirFusion); a failed zone is voted out instead of faulting the oven
+  void setAirZones(const std::vector<AirZone>& zones);
+  const AirFusion::Result& airZones() const { return air_fusion_.result(); }
+
+  // Rack positions, one IR channel each (up to kMaxPartZones; the first is
+  // also the wall reading for warm-up learning). Every zone detects its own
+  // part and cures on its own; the first detection moves Ready to Curing,
+  // the other zones keep looking for part_zone_load_window_s, and the load
+  // is complete once every zone with a part is. Needs a sample source for
+  // more than one zone. Call while Idle.
+  void setPartZones(const std::vector<int>& ir_channels);
+  size_t partZones() const { return n_parts_; }
+  PartZoneStatus partZone(size_t zone) const;
+
+  // Record the age of the frame each tick() decides on (not owned, may be null)
+  void setDiagnostics(Diagnostics* diag) { diag_ = diag; }
+
   // Manual mode commands
   void command_start();
   void command_stop();
@@ -30,11 +126,32 @@ public:
   void command_enterShutdown();
   void command_enterFault();
 
-  // Auto mode commands
+  // Auto mode commands. A target temperature runs Recipe::single(); the
+  // default cure is auto_cure_duration_seconds at the target, Arrhenius-
+  // scaled within the auto tolerance. Recipes must pass Recipe::check().
   void command_startAutoMode(double target_temp);
+  void command_startAutoMode(double target_temp, const CureProfile& cure);
+  void command_startRecipe(const Recipe& recipe);
   void command_cancelAutoMode();
   void command_acknowledgeAutoCureComplete();  // User clicks OK
 
+  // Start auto mode at target_c (or the recipe, warming to its load_c) in
+  // time to reach it by `by`. The start time follows the learnt warm-up ETA
+  // and is re-planned as the idle oven cools. Only fires from Idle;
+  // replaces any earlier schedule.
+  void command_schedulePreheat(double target_c, std::chrono::steady_clock::time_point by);
+  void command_schedulePreheat(const Recipe& recipe, std::chrono::steady_clock::time_point by);
+  void command_cancelPreheat();
+
+  // Relay-feedback autotune at setpoint_c (see RelayAutotune). The contactor
+  // is driven by the relay until enough cycles are seen; the resulting gains
+  // replace the PID gains and are saved under recipe_key. Ends in Idle.
+  // The THKA setpoints must sit kAutotuneThkaMarginC above setpoint_c for
+  // the test, or the THKA's own on/off loop clips the relay cycle.
+  static constexpr double kAutotuneThkaMarginC = 20.0;
+  void command_startAutotune(double setpoint_c, const std::string& recipe_key);
+  void command_cancelAutotune();
+
   // Inputs
   void setFault(bool f)       { fault_ = f; }
   void setDoorOpen(bool open) { door_open_ = open; }
@@ -45,12 +162,35 @@ public:
 
   double air_c() const { return last_air_c_; }
   double ir_c()  const { return last_part_c_; }
-  double part_c() const {
-    return part_detected_ ? last_part_c_ : std::numeric_limits<double>::quiet_NaN();
-  }
+  // Filtered temperature and rate of the part that decides the load (the
+  // detected zone furthest from done); raw IR if the estimator is not
+  // tracking it, e.g. a manual Curing
+  double part_c() const;
+  double part_rate_c_s() const;
+
+  // Warm-up: learnt ETA to the air target (Warming) or to the pre-heat
+  // target (Idle with a schedule), refreshed every few seconds; NaN if
+  // unknown. Bootstrap the model from past cure logs with
+  // learnHeatupFromLogs().
+  double warmup_eta_s() const { return warmup_eta_s_; }
+  int    learnHeatupFromLogs(size_t max_files = 20);
+  const HeatupModel& heatupModel() const { return heatup_; }
 
-  bool part_detected() const { return part_detected_; }
-  int  seconds_left()  const;
+  // Recipe progress of the least cured part so far, 0..1: whole segments
+  // done plus the running one's share (soak time or cure equivalence)
+  double cure_progress() const;
+
+  // Auto recipe in use (the last one started) and the segment running
+  const Recipe& recipe() const { return recipe_; }
+  size_t recipe_segment() const { return seg_; }
+  bool   recipe_ramping() const { return ramping_; }
+
+  // Predicted seconds until the part reaches the cure band (part target,
+  // less the recipe segment's tolerance in auto mode); NaN if unknown
+  double part_eta_s() const;
+
+  bool part_detected() const;   // in any zone
+  int  seconds_left()  const;   // until the whole load is done
 
   // Auto mode status
   bool   is_auto_mode()       const { return mode_ == OperatingMode::Auto; }
@@ -58,14 +198,47 @@ public:
   bool   auto_part_at_temp()  const { return auto_part_at_temp_; }
   bool   auto_cure_complete() const { return auto_cure_complete_; }
 
+  ControlStatus status() const;
+
+  // PID gains in use; auto mode loads per-recipe gains saved by autotune
+  void setPidGains(const Pid::Gains& g);
+  const Pid::Gains& pidGains() const { return air_pid_.gains(); }
+  void setPidGainsPath(const std::string& path) { gains_path_ = path; }
+  const RelayAutotune& autotune() const { return autotune_; }
+
+  // Heat control output (0..1) and the air setpoint it is chasing
+  double heat_duty()      const { return heat_duty_; }
+  double air_setpoint_c() const { return air_setpoint_c_; }
+
   // Data logging API
   DataLogger&       dataLogger()       { return data_logger_; }
   const DataLogger& dataLogger() const { return data_logger_; }
 
-  // Called from OvenBackend::onThkaUpdate() to log a sample (AUTO mode only)
-  void logCurrentState(const std::vector<double>& temps);
+  // Log a sample (AUTO mode only). Called by tick() for every new frame
+  // when a sample source is set.
+  void logCurrentState(const SampleFrame& frame);
 
 private:
+  // One rack position and the part in it
+  struct PartZone {
+    int                                   channel{6};
+    PartEstimator                         est;
+    CureIntegrator                        cure;
+    double                                ir_c{std::numeric_limits<double>::quiet_NaN()};
+    bool                                  fresh{false};        // new reading this tick
+    bool                                  detected{false};
+    bool                                  at_temp{false};
+    bool                                  done{false};
+    bool                                  timer_running{false};  // manual dwell
+    std::chrono::steady_clock::time_point cure_ends{};
+    double                                soak_s{0.0};          // recipe: this segment
+    bool                                  step_done{false};     // recipe: this segment
+
+    // Filtered part temperature, raw IR if the estimator lost it
+    double part_c() const { return est.part_found() ? est.part_c() : ir_c; }
+    void   clear();
+  };
+
   // State transitions / updates
   void enter(State s);
   void update_idle();
@@ -73,7 +246,27 @@ private:
   void update_ready(std::chrono::steady_clock::time_point now);
   void update_curing(std::chrono::steady_clock::time_point now);
   void update_shutdown();
-  void update_part_detection();
+  void update_part_detection(std::chrono::steady_clock::time_point t);
+  void update_cure(std::chrono::steady_clock::time_point t);
+  void update_heatup(std::chrono::steady_clock::time_point t);
+  void update_load(std::chrono::steady_clock::time_point now);
+
+  // Recipe sequencer (auto Curing)
+  void   begin_segment(size_t seg);
+  void   update_recipe(std::chrono::steady_clock::time_point now);
+  double segment_progress(const PartZone& z) const;
+  double zone_progress(const PartZone& z) const;
+  double zone_remaining_s(const PartZone& z) const;
+  const RecipeSegment& segment() const { return recipe_.segments[seg_]; }
+  int  lagging_zone() const;
+  bool load_complete() const;
+  void update_preheat(std::chrono::steady_clock::time_point now);
+
+  // Heat control (PID + time-proportioned contactor)
+  void enable_heat(bool on);
+  void update_heat(std::chrono::steady_clock::time_point now);
+  double air_setpoint(double dt_s);
+  void update_autotune(std::chrono::steady_clock::time_point now);
 
   // Auto mode specific updates
   void update_auto_warming();
@@ -81,9 +274,6 @@ private:
   void update_auto_curing(std::chrono::steady_clock::time_point now);
   void update_auto_cure_complete(std::chrono::steady_clock::time_point now);
 
-  // Helper: stringify state for CSV
-  static std::string stateToString(State s);
-
   // --- Members ---
   Params       P_;
   ITempSensor& air_;
@@ -96,20 +286,43 @@ private:
   IRelay&      buzzerL_;
   IRelay&      contactor_;
 
+  const SampleBus* samples_{nullptr};
+  int              air_channel_{1};
+  uint64_t         sample_seq_{0};   // seq of the last frame seen by tick()
+  AirFusion        air_fusion_;
+  Diagnostics*     diag_{nullptr};
+
   State         st_{State::Idle};
   OperatingMode mode_{OperatingMode::Manual};
   bool          fault_{false};
   bool          door_open_{false};
 
   double last_air_c_{  std::numeric_limits<double>::quiet_NaN() };
-  double last_part_c_{ std::numeric_limits<double>::quiet_NaN() };
+  double last_part_c_{ std::numeric_limits<double>::quiet_NaN() };   // zone 0 IR
 
-  bool                                        cure_timer_running_{false};
-  std::chrono::steady_clock::time_point       cure_ends_{};
+  // Part zones; loading_ while the other zones may still get a part
+  std::array<PartZone, kMaxPartZones>   parts_{};
+  size_t                                n_parts_{1};
+  bool                                  loading_{false};
+  std::chrono::steady_clock::time_point load_closes_{};
 
-  bool   part_detected_{false};
-  double part_baseline_c_{ std::numeric_limits<double>::quiet_NaN() };
-  double part_baseline_alpha_{0.02};
+  // Heat control
+  bool                                  heat_enabled_{false};
+  Pid                                   air_pid_;
+  Pid                                   part_pid_;   // cascade outer loop
+  TimeProportioner                      heat_window_;
+  double                                heat_duty_{0.0};
+  double                                air_setpoint_c_{std::numeric_limits<double>::quiet_NaN()};
+  std::chrono::steady_clock::time_point last_heat_{};
+
+  // Autotune
+  RelayAutotune                         autotune_;
+  RelayAutotune::Options                autotune_opt_{};
+  bool                                  autotune_pending_{false};   // starts on the next tick
+  std::chrono::steady_clock::time_point autotune_epoch_{};
+  std::string                           autotune_key_;
+  int                                   autotune_starts_{0};
+  std::string                           gains_path_;
 
   // Auto mode state
   double                                      auto_target_temp_{200.0};
@@ -117,6 +330,26 @@ private:
   bool                                        auto_cure_complete_{false};
   std::chrono::steady_clock::time_point       auto_cure_start_{};
 
+  // Recipe sequencer: segment seg_, ramping the air setpoint (ramp_sp_c_)
+  // until it reaches the soak temperature, then soaking
+  Recipe                                      recipe_{};
+  size_t                                      seg_{0};
+  bool                                        ramping_{false};
+  double                                      ramp_sp_c_{0.0};
+  double                                      air_soak_s_{0.0};
+  std::chrono::steady_clock::time_point       recipe_t_{};
+
+  // Warm-up model and scheduled pre-heat
+  HeatupModel                                 heatup_;
+  double                                      warmup_eta_s_{std::numeric_limits<double>::quiet_NaN()};
+  std::chrono::steady_clock::time_point       warmup_eta_at_{};
+  bool                                        preheat_pending_{false};
+  double                                      preheat_target_c_{0.0};
+  Recipe                                      preheat_recipe_{};
+  std::chrono::steady_clock::time_point       preheat_by_{};
+  std::chrono::steady_clock::time_point       preheat_start_at_{};
+  double                                      preheat_start_in_s_{0.0};
+
   // Data logging member
   DataLogger data_logger_;
 };
@@ -0,0 +1,222 @@
+#include "CureLog.h"
+#include "../core/Events.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char     kFileMagic[8]   = {'O', 'V', 'N', 'C', 'U', 'R', 'E', '1'};
+constexpr uint32_t kBlockMagic     = 0x314B4C42;  // "BLK1"
+constexpr uint16_t kVersion        = 1;
+constexpr size_t   kFileHeaderSize = 32;
+constexpr size_t   kColumnSize     = 16;
+constexpr size_t   kBlockHeaderSize = 16;
+
+constexpr size_t align_up(size_t n, size_t a) { return (n + a - 1) & ~(a - 1); }
+
+template <typename T>
+void put(std::string& out, const T& v) {
+    out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+T get(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+size_t block_size(size_t rows, size_t columns) {
+    size_t n = kBlockHeaderSize;
+    n += align_up(rows * sizeof(uint16_t), 4);
+    n += rows * columns * sizeof(float);
+    n += rows;
+    return align_up(n, 8);
+}
+
+} // namespace
+
+// ----------------------------------------------------------------- writer ---
+
+std::string CureLogWriter::encodeHeader(const CureLogHeader& h) {
+    std::string out;
+    const uint16_t ncols = static_cast<uint16_t>(h.columns.size());
+    const uint32_t size  = static_cast<uint32_t>(kFileHeaderSize + ncols * kColumnSize);
+
+    out.append(kFileMagic, sizeof(kFileMagic));
+    put(out, kVersion);
+    put(out, ncols);
+    put(out, size);
+    put(out, h.start_unix_ms);
+    put(out, h.setpoint_c);
+    put(out, uint32_t{0});
+
+    for (const auto& c : h.columns) {
+        char name[kColumnSize - 1] = {};
+        std::strncpy(name, c.name.c_str(), sizeof(name) - 1);
+        put(out, c.channel);
+        out.append(name, sizeof(name));
+    }
+    return out;
+}
+
+void CureLogWriter::add(uint64_t elapsed_ms, const float* values, uint8_t state) {
+    // Deltas are 16 bit; a longer gap closes the current block early.
+    if (!dt_.empty() && elapsed_ms - last_ms_ > 0xFFFF) encodeBlock(done_);
+
+    if (dt_.empty()) {
+        base_ms_ = elapsed_ms;
+        dt_.push_back(0);
+    } else {
+        dt_.push_back(static_cast<uint16_t>(elapsed_ms - last_ms_));
+    }
+    last_ms_ = elapsed_ms;
+
+    for (size_t c = 0; c < columns_; ++c) cols_[c].push_back(values[c]);
+    state_.push_back(state);
+}
+
+void CureLogWriter::flush(std::string& out) {
+    out += done_;
+    done_.clear();
+    encodeBlock(out);
+}
+
+void CureLogWriter::encodeBlock(std::string& out) {
+    if (dt_.empty()) return;
+
+    const uint32_t rows = static_cast<uint32_t>(dt_.size());
+    const size_t   start = out.size();
+    out.reserve(start + block_size(rows, columns_));
+
+    put(out, kBlockMagic);
+    put(out, rows);
+    put(out, base_ms_);
+
+    out.append(reinterpret_cast<const char*>(dt_.data()), rows * sizeof(uint16_t));
+    out.resize(start + kBlockHeaderSize + align_up(rows * sizeof(uint16_t), 4), '\0');
+
+    for (const auto& col : cols_)
+        out.append(reinterpret_cast<const char*>(col.data()), rows * sizeof(float));
+
+    out.append(reinterpret_cast<const char*>(state_.data()), rows);
+    out.resize(start + block_size(rows, columns_), '\0');
+
+    dt_.clear();
+    for (auto& col : cols_) col.clear();
+    state_.clear();
+}
+
+// ----------------------------------------------------------------- reader ---
+
+CureLogReader::~CureLogReader() {
+    close();
+}
+
+void CureLogReader::close() {
+    if (map_) ::munmap(const_cast<uint8_t*>(map_), map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    header_ = {};
+    blocks_.clear();
+    rows_ = 0;
+    valid_bytes_ = 0;
+}
+
+bool CureLogReader::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kFileHeaderSize) {
+        ::close(fd);
+        return false;
+    }
+
+    void* m = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED) return false;
+
+    map_      = static_cast<const uint8_t*>(m);
+    map_size_ = static_cast<size_t>(st.st_size);
+
+    // --- file header
+    if (std::memcmp(map_, kFileMagic, sizeof(kFileMagic)) != 0 ||
+        get<uint16_t>(map_ + 8) != kVersion) {
+        close();
+        return false;
+    }
+    const uint16_t ncols = get<uint16_t>(map_ + 10);
+    const uint32_t hsize = get<uint32_t>(map_ + 12);
+    if (hsize != kFileHeaderSize + ncols * kColumnSize || hsize > map_size_) {
+        close();
+        return false;
+    }
+    header_.start_unix_ms = get<int64_t>(map_ + 16);
+    header_.setpoint_c    = get<float>(map_ + 24);
+
+    for (uint16_t c = 0; c < ncols; ++c) {
+        const uint8_t* p = map_ + kFileHeaderSize + c * kColumnSize;
+        const char*    name = reinterpret_cast<const char*>(p + 1);
+        header_.columns.push_back({p[0], std::string(name, strnlen(name, kColumnSize - 1))});
+    }
+
+    // --- blocks, stopping at the first incomplete one
+    size_t off = hsize;
+    valid_bytes_ = off;
+    while (off + kBlockHeaderSize <= map_size_) {
+        if (get<uint32_t>(map_ + off) != kBlockMagic) break;
+        const uint32_t rows = get<uint32_t>(map_ + off + 4);
+        const size_t   size = block_size(rows, ncols);
+        if (rows == 0 || off + size > map_size_) break;
+
+        Block b;
+        b.rows    = rows;
+        b.base_ms = get<uint64_t>(map_ + off + 8);
+        const uint8_t* p = map_ + off + kBlockHeaderSize;
+        b.dt_ms   = reinterpret_cast<const uint16_t*>(p);
+        p += align_up(rows * sizeof(uint16_t), 4);
+        b.values  = reinterpret_cast<const float*>(p);
+        p += rows * ncols * sizeof(float);
+        b.state   = p;
+
+        blocks_.push_back(b);
+        rows_ += rows;
+        off   += size;
+        valid_bytes_ = off;
+    }
+    return true;
+}
+
+bool CureLogReader::exportCSV(const std::string& path) const {
+    if (!map_) return false;
+
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    std::fputs("Time(s)", f);
+    for (const auto& c : header_.columns) std::fprintf(f, ",%s", c.name.c_str());
+    std::fputs(",Setpoint(°C),State\n", f);
+
+    const size_t ncols = header_.columns.size();
+    for (const auto& b : blocks_) {
+        uint64_t t = b.base_ms;
+        for (uint32_t r = 0; r < b.rows; ++r) {
+            t += b.dt_ms[r];
+            std::fprintf(f, "%.2f", t / 1000.0);
+            for (size_t c = 0; c < ncols; ++c) std::fprintf(f, ",%.2f", b.column(c)[r]);
+            std::fprintf(f, ",%.2f,%s\n", header_.setpoint_c,
+                         stateName(static_cast<State>(b.state[r])));
+        }
+    }
+
+    const bool ok = std::ferror(f) == 0;
+    return std::fclose(f) == 0 && ok;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Binary columnar cure-log format (.ovl)
+ *
+ * Little-endian, everything 4/8-byte aligned so columns can be used in place
+ * from an mmap'd file.
+ *
+ *   File header (32 bytes)
+ *     char     magic[8]        "OVNCURE1"
+ *     uint16   version         1
+ *     uint16   column_count    float columns per row
+ *     uint32   header_size     bytes, including the column table
+ *     int64    start_unix_ms   session start, wall clock
+ *     float    setpoint_c
+ *     uint32   reserved
+ *   Column table: column_count x 16 bytes
+ *     uint8    channel         THKA channel id (0 = derived value)
+ *     char     name[15]        CSV header name, NUL padded
+ *
+ *   Blocks, repeated to EOF
+ *     uint32   magic           "BLK1"
+ *     uint32   rows
+ *     uint64   base_ms         session-relative time of row 0
+ *     uint16   dt_ms[rows]     delta to previous row (dt_ms[0] = 0), padded to 4
+ *     float    col[column_count][rows]
+ *     uint8    state[rows]     State enum value; block padded to 8 bytes
+ *
+ * A block is only valid once fully written; readers stop at the first
+ * truncated or corrupt block, which is how a crashed session is recovered.
+ */
+
+static_assert(std::endian::native == std::endian::little, "CureLog assumes a little-endian host");
+
+struct CureLogColumn {
+    uint8_t     channel{0};
+    std::string name;
+};
+
+struct CureLogHeader {
+    int64_t                    start_unix_ms{0};
+    float                      setpoint_c{0.0f};
+    std::vector<CureLogColumn> columns;
+};
+
+// Accumulates rows and encodes them as one block at a time.
+class CureLogWriter {
+public:
+    explicit CureLogWriter(size_t columns) : columns_(columns), cols_(columns) {}
+
+    static std::string encodeHeader(const CureLogHeader& h);
+
+    // elapsed_ms must be non-decreasing within a session
+    void add(uint64_t elapsed_ms, const float* values, uint8_t state);
+
+    size_t rows()  const { return dt_.size(); }
+    bool   empty() const { return dt_.empty() && done_.empty(); }
+
+    // Append the pending rows to out as complete blocks and start a new block.
+    void flush(std::string& out);
+
+private:
+    void encodeBlock(std::string& out);
+
+    size_t                          columns_;
+    uint64_t                        base_ms_{0};
+    uint64_t                        last_ms_{0};
+    std::vector<uint16_t>           dt_;
+    std::vector<std::vector<float>> cols_;
+    std::vector<uint8_t>            state_;
+    std::string                     done_;   // blocks closed early by a time gap
+};
+
+// Zero-copy reader: column pointers point straight into the mapping.
+class CureLogReader {
+public:
+    struct Block {
+        uint32_t        rows;
+        uint64_t        base_ms;
+        const uint16_t* dt_ms;
+        const float*    values;   // column c starts at values + c * rows
+        const uint8_t*  state;
+
+        const float* column(size_t c) const { return values + c * rows; }
+    };
+
+    CureLogReader() = default;
+    ~CureLogReader();
+
+    CureLogReader(const CureLogReader&) = delete;
+    CureLogReader& operator=(const CureLogReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const CureLogHeader&      header()     const { return header_; }
+    const std::vector<Block>& blocks()     const { return blocks_; }
+    size_t                    rowCount()   const { return rows_; }
+    // Bytes up to the end of the last complete block
+    size_t                    validBytes() const { return valid_bytes_; }
+
+    // Same layout as DataLogger's CSV, so scripts/generate_graphs.py can read it
+    bool exportCSV(const std::string& path) const;
+
+private:
+    const uint8_t*     map_{nullptr};
+    size_t             map_size_{0};
+    CureLogHeader      header_;
+    std::vector<Block> blocks_;
+    size_t             rows_{0};
+    size_t             valid_bytes_{0};
+};
@@ -0,0 +1,231 @@
+#include "DataLogger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len  -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+DataLogger::~DataLogger() {
+    stopSession();
+}
+
+bool DataLogger::enableStreaming(const std::string& directory, LogFormat format) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (!fs::is_directory(directory, ec)) return false;
+
+    recoverPartialLogs(directory);
+
+    stream_dir_ = directory;
+    format_     = format;
+    if (!ring_) ring_ = std::make_unique<Slot[]>(kRingCapacity);
+    streaming_ = true;
+    return true;
+}
+
+int DataLogger::recoverPartialLogs(const std::string& directory) {
+    std::error_code ec;
+    int recovered = 0;
+
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        const fs::path p = entry.path();
+        if (!entry.is_regular_file(ec) || p.extension() != ".part") continue;
+
+        const fs::path inner = p.stem();                // cure_log_X.csv / cure_log_X.ovl
+        if (inner.extension() == ".ovl") {
+            // Drop a trailing partial block left by an interrupted write
+            CureLogReader reader;
+            if (reader.open(p.string())) {
+                const size_t keep = reader.validBytes();
+                reader.close();
+                fs::resize_file(p, keep, ec);
+            }
+        } else {
+            // Drop a trailing partial line left by an interrupted write
+            std::ifstream in(p, std::ios::binary);
+            std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            in.close();
+            const size_t keep = content.rfind('\n');
+            fs::resize_file(p, keep == std::string::npos ? 0 : keep + 1, ec);
+        }
+
+        // cure_log_X.csv.part -> cure_log_X_recovered.csv
+        fs::path target = p.parent_path() /
+                          (inner.stem().string() + "_recovered" + inner.extension().string());
+        fs::rename(p, target, ec);
+        if (!ec) ++recovered;
+    }
+    return recovered;
+}
+
+bool DataLogger::openStream() {
+    stream_finalized_ = false;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+
+    final_path_ = stream_dir_ + "/" + session_filename_ + extension();
+    part_path_  = final_path_ + ".part";
+    fd_ = ::open(part_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        stream_error_ = part_path_ + ": " + std::strerror(errno);
+        final_path_.clear();
+        return false;
+    }
+
+    if (format_ == LogFormat::Binary) {
+        CureLogHeader h;
+        h.start_unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        h.setpoint_c = static_cast<float>(session_setpoint_);
+        h.columns = {{1, "CH1_Air(°C)"}, {2, "CH2(°C)"}, {3, "CH3(°C)"},
+                     {5, "CH5(°C)"},     {6, "CH6_IR(°C)"},
+                     {0, "Air(°C)"},     {0, "Spread(°C)"}};
+        // Derived per-zone values, so channel 0 like the fused air
+        for (size_t z = 1; z <= part_zones_; ++z) {
+            h.columns.push_back({0, "Part" + std::to_string(z) + "(°C)"});
+            h.columns.push_back({0, "Cure" + std::to_string(z) + "(%)"});
+        }
+        blocks_ = CureLogWriter(h.columns.size());
+        const std::string hdr = CureLogWriter::encodeHeader(h);
+        write_all(fd_, hdr.data(), hdr.size());
+    } else {
+        const std::string hdr = csvHeader();
+        write_all(fd_, hdr.data(), hdr.size());
+    }
+    ::fsync(fd_);
+
+    writer_run_.store(true, std::memory_order_release);
+    writer_ = std::thread(&DataLogger::writerLoop, this);
+    return true;
+}
+
+void DataLogger::closeStream() {
+    if (writer_.joinable()) {
+        writer_run_.store(false, std::memory_order_release);
+        writer_.join();
+    }
+    if (fd_ < 0) return;
+
+    // Writer has exited; flush whatever it left in the ring
+    std::string buf;
+    drainRing(buf);
+    blocks_.flush(buf);
+    write_all(fd_, buf.data(), buf.size());
+    ::fsync(fd_);
+    ::close(fd_);
+    fd_ = -1;
+
+    std::error_code ec;
+    fs::rename(part_path_, final_path_, ec);
+    stream_finalized_ = !ec;
+}
+
+void DataLogger::pushStream(double ch1, double ch2, double ch3, double ch5, double ch6,
+                            double air, double spread, const ZonePoint* zones, State state) {
+    if (fd_ < 0) return;
+
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= kRingCapacity) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Slot& s = ring_[head & (kRingCapacity - 1)];
+    s.elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - session_start_).count();
+    s.ch[0] = ch1;
+    s.ch[1] = ch2;
+    s.ch[2] = ch3;
+    s.ch[3] = ch5;
+    s.ch[4] = ch6;
+    s.ch[5] = air;
+    s.ch[6] = spread;
+    std::copy_n(zones, part_zones_, s.zone);
+    s.state = state;
+
+    head_.store(head + 1, std::memory_order_release);
+}
+
+size_t DataLogger::drainRing(std::string& buf) {
+    const size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t count = head - tail;
+
+    char line[320];
+    for (; tail != head; ++tail) {
+        const Slot& s = ring_[tail & (kRingCapacity - 1)];
+        if (format_ == LogFormat::Binary) {
+            float v[kFixedColumns + 2 * kMaxPartZones];
+            for (size_t c = 0; c < kFixedColumns; ++c) v[c] = static_cast<float>(s.ch[c]);
+            for (size_t z = 0; z < part_zones_; ++z) {
+                v[kFixedColumns + 2 * z]     = static_cast<float>(s.zone[z].part_c);
+                v[kFixedColumns + 2 * z + 1] = static_cast<float>(s.zone[z].cure_pct);
+            }
+            blocks_.add(s.elapsed_ms, v, static_cast<uint8_t>(s.state));
+            continue;
+        }
+        int n = std::snprintf(line, sizeof(line),
+                              "%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,",
+                              s.elapsed_ms / 1000.0, s.ch[0], s.ch[1], s.ch[2], s.ch[3], s.ch[4],
+                              s.ch[5], s.ch[6]);
+        for (size_t z = 0; z < part_zones_ && n > 0 && n < static_cast<int>(sizeof(line)); ++z)
+            n += std::snprintf(line + n, sizeof(line) - n, "%.2f,%.2f,",
+                               s.zone[z].part_c, s.zone[z].cure_pct);
+        if (n > 0 && n < static_cast<int>(sizeof(line)))
+            n += std::snprintf(line + n, sizeof(line) - n, "%.2f,%s\n",
+                               session_setpoint_, stateName(s.state));
+        if (n > 0) buf.append(line, std::min<size_t>(n, sizeof(line) - 1));
+    }
+
+    tail_.store(tail, std::memory_order_release);
+    return count;
+}
+
+void DataLogger::writerLoop() {
+    using Clock = std::chrono::steady_clock;
+    std::string buf;
+    buf.reserve(64 * 1024);
+    auto last_sync = Clock::now();
+    bool dirty = false;
+
+    while (writer_run_.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(kFlushInterval);
+
+        // CSV lines go out every flush; binary rows are collected into one
+        // block per sync interval so blocks stay large and complete on disk.
+        buf.clear();
+        dirty |= drainRing(buf) > 0;
+        const bool sync_due = Clock::now() - last_sync >= kSyncInterval;
+        if (sync_due) blocks_.flush(buf);
+        if (!buf.empty()) write_all(fd_, buf.data(), buf.size());
+
+        if (dirty && sync_due) {
+            ::fdatasync(fd_);
+            last_sync = Clock::now();
+            dirty = false;
+        }
+    }
+}
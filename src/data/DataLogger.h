@@ -1,11 +1,26 @@
 #pragma once
 #include <vector>
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "../core/Events.h"
+#include "CureLog.h"
+
+// One part zone's row values (see StateMachine::setPartZones)
+struct ZonePoint {
+    double part_c;    // filtered part temperature, NaN until a part is detected
+    double cure_pct;  // cure equivalence, %
+};
 
 struct DataPoint {
     std::chrono::steady_clock::time_point timestamp;
@@ -15,36 +30,89 @@ struct DataPoint {
     // ch4 is skipped
     double ch5_temp;
     double ch6_temp;  // IR
+    double air_temp;  // fused chamber air (AirFusion)
+    double spread;    // hottest - coldest air zone
+    std::array<ZonePoint, kMaxPartZones> zones;   // first part_zones in use
     double setpoint;
-    std::string state;
+    State state;
+};
+
+// On-disk format for streamed sessions
+enum class LogFormat {
+    Csv,     // <session>.csv, same layout as saveToCSV()
+    Binary,  // <session>.ovl, see CureLog.h
 };
 
+/**
+ * Cure-session logger.
+ *
+ * By default points are buffered in memory and written by saveToCSV().
+ * After enableStreaming(dir) every session is instead appended to
+ * <dir>/<session>.<ext>.part as it runs: logPoint() only pushes into a
+ * preallocated single-producer/single-consumer ring, and a writer thread
+ * drains it to disk in batches with a periodic fsync. stopSession() drops
+ * the .part suffix; a .part left behind by a crash is recovered on the next
+ * enableStreaming(). A session whose file cannot be opened is buffered in
+ * memory instead, as without streaming, with the reason in streamError().
+ */
 class DataLogger {
 public:
+    static constexpr size_t kRingCapacity = 4096;  // power of two, ~7 min at 10 Hz
+    static constexpr std::chrono::milliseconds kFlushInterval{200};
+    static constexpr std::chrono::seconds      kSyncInterval{2};
+
     DataLogger() = default;
-    
-    void startSession(double setpoint) {
+    ~DataLogger();
+
+    DataLogger(const DataLogger&) = delete;
+    DataLogger& operator=(const DataLogger&) = delete;
+
+    // Switch to streaming mode. Creates the directory if needed and recovers
+    // any partial logs found there. Returns false if the directory is unusable.
+    bool enableStreaming(const std::string& directory, LogFormat format = LogFormat::Csv);
+    bool isStreaming() const { return streaming_; }
+
+    // Finalise every *.part in directory (trailing partial line or block
+    // dropped). Returns the number of files recovered.
+    static int recoverPartialLogs(const std::string& directory);
+
+    // part_zones: ZonePoints per logPoint(), logged as Part<n>/Cure<n> columns
+    void startSession(double setpoint, size_t part_zones = 1) {
+        stopSession();
+
         data_.clear();
         session_setpoint_ = setpoint;
+        part_zones_ = std::min(part_zones, kMaxPartZones);
         session_start_ = std::chrono::steady_clock::now();
         logging_active_ = true;
-        
+        stream_error_.clear();
+
         // Generate filename with timestamp
         auto now = std::chrono::system_clock::now();
         auto time_t = std::chrono::system_clock::to_time_t(now);
         std::stringstream ss;
         ss << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S");
         session_filename_ = "cure_log_" + ss.str();
+
+        session_streamed_ = streaming_ && openStream();
     }
-    
+
     void stopSession() {
+        if (!logging_active_) return;
         logging_active_ = false;
+        if (session_streamed_) closeStream();
     }
-    
-    void logPoint(double ch1, double ch2, double ch3, double ch5, double ch6, 
-                  const std::string& state) {
+
+    // zones: the session's part_zones entries
+    void logPoint(double ch1, double ch2, double ch3, double ch5, double ch6,
+                  double air, double spread, const ZonePoint* zones, State state) {
         if (!logging_active_) return;
-        
+
+        if (session_streamed_) {
+            pushStream(ch1, ch2, ch3, ch5, ch6, air, spread, zones, state);
+            return;
+        }
+
         DataPoint point;
         point.timestamp = std::chrono::steady_clock::now();
         point.ch1_temp = ch1;
@@ -52,28 +120,34 @@ public:
         point.ch3_temp = ch3;
         point.ch5_temp = ch5;
         point.ch6_temp = ch6;
+        point.air_temp = air;
+        point.spread = spread;
+        std::copy_n(zones, part_zones_, point.zones.begin());
         point.setpoint = session_setpoint_;
         point.state = state;
-        
+
         data_.push_back(point);
     }
-    
+
+    // A streamed session is already on disk; this only reports whether its
+    // file was finalised.
     bool saveToCSV(const std::string& directory = "/home/pi/cure_logs") const {
+        if (session_streamed_) return stream_finalized_;
         if (data_.empty()) return false;
-        
+
         std::string filepath = directory + "/" + session_filename_ + ".csv";
         std::ofstream file(filepath);
-        
+
         if (!file.is_open()) return false;
-        
+
         // Header
-        file << "Time(s),CH1_Air(°C),CH2(°C),CH3(°C),CH5(°C),CH6_IR(°C),Setpoint(°C),State\n";
-        
+        file << csvHeader();
+
         // Data
         for (const auto& point : data_) {
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
                 point.timestamp - session_start_).count() / 1000.0;
-            
+
             file << std::fixed << std::setprecision(2)
                  << elapsed << ","
                  << point.ch1_temp << ","
@@ -81,22 +155,78 @@ public:
                  << point.ch3_temp << ","
                  << point.ch5_temp << ","
                  << point.ch6_temp << ","
-                 << point.setpoint << ","
-                 << point.state << "\n";
+                 << point.air_temp << ","
+                 << point.spread << ",";
+            for (size_t z = 0; z < part_zones_; ++z)
+                file << point.zones[z].part_c << "," << point.zones[z].cure_pct << ",";
+            file << point.setpoint << ","
+                 << stateName(point.state) << "\n";
         }
-        
+
         file.close();
         return true;
     }
-    
+
     const std::vector<DataPoint>& getData() const { return data_; }
     std::string getSessionFilename() const { return session_filename_; }
+    // Full path of the last streamed session file (empty in memory mode)
+    std::string getSessionPath() const { return final_path_; }
     bool isLogging() const { return logging_active_; }
-    
+    // Why the current (or last) session is in memory although streaming is
+    // enabled; empty if it streams
+    const std::string& streamError() const { return stream_error_; }
+
+    // Points discarded because the writer thread fell a full ring behind
+    uint64_t droppedPoints() const { return dropped_.load(std::memory_order_relaxed); }
+
 private:
+    static constexpr size_t kFixedColumns = 7;   // CH1, CH2, CH3, CH5, CH6, fused air, spread
+
+    // Fixed-size ring entry: no heap allocation on the logging path
+    struct Slot {
+        uint64_t  elapsed_ms;
+        double    ch[kFixedColumns];
+        ZonePoint zone[kMaxPartZones];
+        State     state;
+    };
+
+    std::string csvHeader() const {
+        std::string h = "Time(s),CH1_Air(°C),CH2(°C),CH3(°C),CH5(°C),CH6_IR(°C),Air(°C),Spread(°C),";
+        for (size_t z = 1; z <= part_zones_; ++z)
+            h += "Part" + std::to_string(z) + "(°C),Cure" + std::to_string(z) + "(%),";
+        return h + "Setpoint(°C),State\n";
+    }
+
+    bool openStream();   // false (and stream_error_) if the file cannot be opened
+    void closeStream();
+    void pushStream(double ch1, double ch2, double ch3, double ch5, double ch6,
+                    double air, double spread, const ZonePoint* zones, State state);
+    void writerLoop();
+    size_t drainRing(std::string& buf);
+    const char* extension() const { return format_ == LogFormat::Binary ? ".ovl" : ".csv"; }
+
     std::vector<DataPoint> data_;
     double session_setpoint_{0.0};
+    size_t part_zones_{1};
     std::chrono::steady_clock::time_point session_start_;
     bool logging_active_{false};
     std::string session_filename_;
-};
\ No newline at end of file
+
+    // Streaming mode
+    bool                    streaming_{false};
+    bool                    session_streamed_{false};  // this session goes to a file
+    bool                    stream_finalized_{false};
+    std::string             stream_error_;
+    LogFormat               format_{LogFormat::Csv};
+    std::string             stream_dir_;
+    std::string             part_path_;
+    std::string             final_path_;
+    CureLogWriter           blocks_{kFixedColumns};  // binary format: rows since last sync
+    int                     fd_{-1};
+    std::unique_ptr<Slot[]> ring_;
+    std::atomic<size_t>     head_{0};    // next slot to fill   (producer)
+    std::atomic<size_t>     tail_{0};    // next slot to write  (writer thread)
+    std::atomic<uint64_t>   dropped_{0};
+    std::atomic<bool>       writer_run_{false};
+    std::thread             writer_;
+};
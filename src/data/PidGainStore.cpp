@@ -0,0 +1,65 @@
+#include "PidGainStore.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+std::string pidGainsPath() {
+    if (const char* xdg = std::getenv("XDG_CONFIG_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/oven/pid_gains";
+    const char* home = std::getenv("HOME");
+    return (home ? std::string(home) : std::string("/home/pi")) + "/.config/oven/pid_gains";
+}
+
+bool loadPidGains(const std::string& path, const std::string& key, PidGains& out) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        std::string k;
+        PidGains g;
+        if (!(ss >> k >> g.kp >> g.ki >> g.kd)) continue;
+        if (k == key) {
+            out = g;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool savePidGains(const std::string& path, const std::string& key, const PidGains& gains) {
+    // Keep every other recipe's line as it is
+    std::vector<std::string> lines;
+    {
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream ss(line);
+            std::string k;
+            if (ss >> k && k != key) lines.push_back(line);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        out << "# recipe kp ki kd\n";
+        for (const auto& l : lines) out << l << "\n";
+        out.precision(6);
+        out << key << " " << gains.kp << " " << gains.ki << " " << gains.kd << "\n";
+        if (!out) return false;
+    }
+
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+
+/**
+ * Tuned PID gains, persisted per recipe.
+ *
+ * One line per recipe key (Recipe::key) in a small text file:
+ *
+ *     # recipe kp ki kd
+ *     T200 0.052 0.0011 0.61
+ *
+ * Keys contain no whitespace. Writes go through a temporary file and a
+ * rename, so a crash never leaves a half-written store.
+ */
+struct PidGains {
+    double kp{0.0};
+    double ki{0.0};
+    double kd{0.0};
+};
+
+// $XDG_CONFIG_HOME/oven/pid_gains, else ~/.config/oven/pid_gains
+std::string pidGainsPath();
+
+bool loadPidGains(const std::string& path, const std::string& key, PidGains& out);
+bool savePidGains(const std::string& path, const std::string& key, const PidGains& gains);
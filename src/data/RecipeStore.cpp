@@ -0,0 +1,157 @@
+#include "RecipeStore.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+constexpr double kDefaultEaKjMol = 62.0;
+
+RecipeSegment cureSegment(double ramp_c_min, double soak_c, double soak_min, double band_c,
+                          double ea_kj_mol = kDefaultEaKjMol) {
+    RecipeSegment s;
+    s.ramp_c_min  = ramp_c_min;
+    s.soak_c      = soak_c;
+    s.soak_s      = soak_min * 60.0;
+    s.basis       = RecipeSegment::Basis::Cure;
+    s.tolerance_c = band_c;
+    s.cure        = CureProfile::arrhenius(soak_c, s.soak_s, band_c, ea_kj_mol * 1000.0);
+    return s;
+}
+
+// Finish the recipe being parsed: keep it if it is complete
+void finish(Recipe& r, bool& bad, int line, std::vector<Recipe>& out, std::string& errors) {
+    if (r.key.empty()) return;
+    std::string why = bad ? "bad segment line" : r.check();
+    if (why.empty()) {
+        out.push_back(r);
+    } else {
+        errors += "recipe " + r.key + " (line " + std::to_string(line) + "): " + why + "\n";
+    }
+    r = Recipe{};
+    bad = false;
+}
+
+} // namespace
+
+std::string recipesPath() {
+    if (const char* xdg = std::getenv("XDG_CONFIG_HOME"); xdg && *xdg)
+        return std::string(xdg) + "/oven/recipes";
+    const char* home = std::getenv("HOME");
+    return (home ? std::string(home) : std::string("/home/pi")) + "/.config/oven/recipes";
+}
+
+std::vector<Recipe> defaultRecipes() {
+    std::vector<Recipe> out;
+
+    // The single-temperature auto cycles, under the keys autotune uses
+    for (double t : {180.0, 200.0}) {
+        Recipe r;
+        r.key    = Recipe::keyFor(t);
+        r.name   = "Standard " + std::to_string(static_cast<int>(t)) + " °C";
+        r.load_c = t;
+        r.segments.push_back(cureSegment(0.0, t, t < 190.0 ? 20.0 : 12.0, 15.0));
+        out.push_back(r);
+    }
+
+    // Outgassing substrates: flow out at 140 °C, then a limited ramp to cure
+    Recipe degas;
+    degas.key    = "DEGAS200";
+    degas.name   = "Degas 140 / cure 200 °C";
+    degas.load_c = 140.0;
+    RecipeSegment flow;
+    flow.soak_c      = 140.0;
+    flow.soak_s      = 10 * 60.0;
+    flow.basis       = RecipeSegment::Basis::Part;
+    flow.tolerance_c = 10.0;
+    degas.segments.push_back(flow);
+    degas.segments.push_back(cureSegment(5.0, 200.0, 12.0, 15.0));
+    out.push_back(degas);
+
+    return out;
+}
+
+bool loadRecipes(const std::string& path, std::vector<Recipe>& out, std::string& errors) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    Recipe r;
+    bool bad = false;
+    int recipe_line = 0;
+    int n = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        ++n;
+        std::istringstream ss(line);
+        std::string kind;
+        if (!(ss >> kind) || kind[0] == '#') continue;
+
+        if (kind == "recipe") {
+            finish(r, bad, recipe_line, out, errors);
+            recipe_line = n;
+            if (!(ss >> r.key >> r.load_c)) {
+                errors += "line " + std::to_string(n) + ": bad recipe line\n";
+                r = Recipe{};
+                continue;
+            }
+            std::getline(ss >> std::ws, r.name);
+            if (r.name.empty()) r.name = r.key;
+        } else if (kind == "segment") {
+            if (r.key.empty()) {
+                errors += "line " + std::to_string(n) + ": segment outside a recipe\n";
+                continue;
+            }
+            double ramp, soak_c, soak_min, tol;
+            std::string basis;
+            RecipeSegment s;
+            if (!(ss >> ramp >> soak_c >> soak_min >> basis >> tol) || !parseBasis(basis, s.basis)) {
+                bad = true;
+                continue;
+            }
+            double ea;
+            if (!(ss >> ea)) ea = kDefaultEaKjMol;
+            if (s.basis == RecipeSegment::Basis::Cure) {
+                s = cureSegment(ramp, soak_c, soak_min, tol, ea);
+            } else {
+                s.ramp_c_min  = ramp;
+                s.soak_c      = soak_c;
+                s.soak_s      = soak_min * 60.0;
+                s.tolerance_c = tol;
+            }
+            r.segments.push_back(s);
+        } else {
+            errors += "line " + std::to_string(n) + ": unknown \"" + kind + "\"\n";
+        }
+    }
+    finish(r, bad, recipe_line, out, errors);
+    return true;
+}
+
+bool saveRecipes(const std::string& path, const std::vector<Recipe>& recipes) {
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        out << "# recipe <key> <load °C> <name ...>\n"
+               "# segment <ramp °C/min> <soak °C> <soak min> <air|part|cure> <tolerance °C> [Ea kJ/mol]\n";
+        out.precision(6);
+        for (const auto& r : recipes) {
+            out << "\nrecipe " << r.key << " " << r.load_c << " " << r.name << "\n";
+            for (const auto& s : r.segments) {
+                out << "segment " << s.ramp_c_min << " " << s.soak_c << " " << s.soak_s / 60.0
+                    << " " << basisName(s.basis) << " " << s.tolerance_c;
+                if (s.basis == RecipeSegment::Basis::Cure) out << " " << s.cure.ea_j_mol / 1000.0;
+                out << "\n";
+            }
+        }
+        if (!out) return false;
+    }
+
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
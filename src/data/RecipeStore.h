@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "../core/Recipe.h"
+
+/**
+ * Recipe library: a small text file, loaded at startup.
+ *
+ *     # recipe <key> <load °C> <name ...>
+ *     # segment <ramp °C/min> <soak °C> <soak min> <air|part|cure> <tolerance °C> [Ea kJ/mol]
+ *     recipe DEGAS200 140 Degas 140 / cure 200
+ *     segment 0 140 10 part 10
+ *     segment 5 200 12 cure 15 62
+ *
+ * Segments belong to the recipe line above them. A cure segment's profile
+ * is Arrhenius around the soak point (Ea defaults to 62 kJ/mol). A recipe
+ * with a bad line is dropped as a whole, never run half-parsed. Writes go
+ * through a temporary file and a rename, like the PID gain store.
+ */
+
+// $XDG_CONFIG_HOME/oven/recipes, else ~/.config/oven/recipes
+std::string recipesPath();
+
+// What a fresh install starts with
+std::vector<Recipe> defaultRecipes();
+
+// Returns false if the file cannot be read. Dropped recipes are described
+// in errors, one per line.
+bool loadRecipes(const std::string& path, std::vector<Recipe>& out, std::string& errors);
+bool saveRecipes(const std::string& path, const std::vector<Recipe>& recipes);
@@ -0,0 +1,84 @@
+#include "TrendHistory.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+TrendHistory::TrendHistory(size_t channels, size_t capacity)
+    : channels_(channels),
+      capacity_(std::max<size_t>(capacity, 1)),
+      t_ms_(capacity_, 0),
+      values_(channels_ * capacity_, std::numeric_limits<float>::quiet_NaN()) {}
+
+size_t TrendHistory::index(size_t i) const {
+    // oldest sample sits at head_ once the ring has wrapped
+    const size_t oldest = (size_ == capacity_) ? head_ : 0;
+    size_t j = oldest + i;
+    return j >= capacity_ ? j - capacity_ : j;
+}
+
+void TrendHistory::append(int64_t t_ms, const double* values) {
+    t_ms_[head_] = t_ms;
+    for (size_t c = 0; c < channels_; ++c)
+        values_[c * capacity_ + head_] = static_cast<float>(values[c]);
+
+    if (++head_ == capacity_) head_ = 0;
+    if (size_ < capacity_) ++size_;
+}
+
+int64_t TrendHistory::newestMs() const {
+    if (size_ == 0) return 0;
+    return t_ms_[head_ == 0 ? capacity_ - 1 : head_ - 1];
+}
+
+size_t TrendHistory::lowerBound(int64_t t_ms) const {
+    size_t lo = 0, hi = size_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (t_ms_[index(mid)] < t_ms) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+void TrendHistory::decimate(size_t channel, double window_s, size_t buckets,
+                            std::vector<Bucket>& out) const {
+    out.clear();
+    if (size_ == 0 || channel >= channels_ || buckets == 0 || window_s <= 0) return;
+
+    const int64_t newest = newestMs();
+    const int64_t window = static_cast<int64_t>(window_s * 1000.0);
+    const int64_t start  = newest - window;
+    const double  width  = static_cast<double>(window) / buckets;
+    const float*  v      = values_.data() + channel * capacity_;
+
+    out.reserve(buckets);
+
+    size_t i   = lowerBound(start);
+    size_t cur = buckets;   // no bucket open yet
+    float  lo  = 0, hi = 0;
+
+    auto emit = [&]() {
+        if (cur == buckets) return;
+        const double centre_ms = start + (cur + 0.5) * width;
+        out.push_back({cur, (centre_ms - newest) / 1000.0, lo, hi});
+    };
+
+    for (; i < size_; ++i) {
+        const size_t k = index(i);
+        const float  x = v[k];
+        if (std::isnan(x)) continue;
+
+        size_t b = static_cast<size_t>((t_ms_[k] - start) / width);
+        if (b >= buckets) b = buckets - 1;
+
+        if (b != cur) {
+            emit();
+            cur = b;
+            lo = hi = x;
+        } else {
+            lo = std::min(lo, x);
+            hi = std::max(hi, x);
+        }
+    }
+    emit();
+}
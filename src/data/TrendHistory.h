@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Fixed-capacity history of all THKA channels for the trend chart.
+ *
+ * Storage is allocated once: one float array per channel (structure of
+ * arrays) plus a shared timestamp array, used as a ring. Appending never
+ * allocates, and a per-channel min/max scan walks contiguous memory.
+ *
+ * Not thread-safe; owned and used by the GUI thread.
+ */
+class TrendHistory {
+public:
+    // One min/max-decimated output point (bucket)
+    struct Bucket {
+        size_t index; // 0 .. buckets-1, oldest first
+        double t_s;   // bucket centre, seconds relative to the newest sample
+        float  min;
+        float  max;
+    };
+
+    TrendHistory(size_t channels, size_t capacity);
+
+    size_t channels() const { return channels_; }
+    size_t capacity() const { return capacity_; }
+    size_t size()     const { return size_; }
+
+    // t_ms: monotonic milliseconds. values has channels() entries; NaN marks
+    // a missing reading and is skipped by decimate().
+    void append(int64_t t_ms, const double* values);
+    void clear() { size_ = 0; head_ = 0; }
+
+    int64_t newestMs() const;
+
+    // Min/max decimation of one channel over the last window_s seconds into
+    // at most `buckets` points (one per pixel column, say). Empty buckets
+    // are omitted.
+    void decimate(size_t channel, double window_s, size_t buckets,
+                  std::vector<Bucket>& out) const;
+
+private:
+    size_t index(size_t i) const;         // i-th oldest sample -> ring slot
+    size_t lowerBound(int64_t t_ms) const; // first sample with t >= t_ms
+
+    size_t               channels_;
+    size_t               capacity_;
+    size_t               size_{0};
+    size_t               head_{0};        // next slot to write
+    std::vector<int64_t> t_ms_;
+    std::vector<float>   values_;         // [channel][capacity]
+};
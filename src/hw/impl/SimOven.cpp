@@ -0,0 +1,102 @@
+#include "SimOven.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Fixed per-zone offsets for CH1..CH5 (°C per 100 °C above ambient), so
+// zone spread grows with temperature like the real oven's does
+constexpr double kZoneSkew[5] = {0.0, 1.5, -1.0, 2.5, -2.0};
+
+} // namespace
+
+SimOven::SimOven() : SimOven(Params{}) {}
+
+SimOven::SimOven(Params p, uint32_t seed)
+  : P_(p), rng_(seed),
+    heater_c_(p.ambient_c), air_c_(p.ambient_c), wall_c_(p.ambient_c)
+{
+  for (auto& part : parts_) part.c = p.ambient_c;
+}
+
+void SimOven::insert_part(double mass_kg, double cp_j_kgk, double temp_c, int slot) {
+  Part& part   = parts_[slot];
+  part.present = true;
+  part.c_j_k   = std::max(mass_kg * cp_j_kgk, 1.0);
+  part.c       = std::isnan(temp_c) ? P_.ambient_c : temp_c;
+}
+
+void SimOven::advance(double seconds) {
+  while (seconds > 0) {
+    const double dt = std::min(seconds, P_.max_step_s);
+    step(dt);
+    seconds -= dt;
+  }
+}
+
+// Explicit Euler; max_step_s is far below the smallest node time constant
+// (air: C / ΣG ≈ 3 s with the door open and fans running).
+void SimOven::step(double dt) {
+  const double fans = (fan_.on ? 0.5 : 0.0) + (fan2_.on ? 0.5 : 0.0);
+
+  const double g_heater = P_.heater_g_w_k + fans * P_.heater_fan_g_w_k;
+  const double g_wall   = P_.air_wall_g_w_k + fans * P_.air_wall_fan_g_w_k;
+  const double g_part   = (P_.part_h_w_m2k + fans * P_.part_fan_h_w_m2k) * P_.part_area_m2;
+  const double g_door   = door_open_ ? P_.door_open_g_w_k : 0.0;
+
+  if (!std::isnan(setpoint_c_)) {
+    if (air_c_ <= setpoint_c_ - P_.controller_hyst_c) calling_ = true;
+    if (air_c_ >= setpoint_c_ + P_.controller_hyst_c) calling_ = false;
+  } else {
+    calling_ = true;
+  }
+
+  const double q_in     = (contactor_.on && calling_) ? P_.heater_w : 0.0;
+  const double q_h_air  = g_heater * (heater_c_ - air_c_);
+  const double q_a_wall = g_wall * (air_c_ - wall_c_);
+  double q_a_parts = 0.0;
+  for (auto& part : parts_) {
+    if (!part.present) continue;
+    const double q = g_part * (air_c_ - part.c);
+    q_a_parts += q;
+    part.c    += dt * q / part.c_j_k;
+  }
+  const double q_door   = g_door * (air_c_ - P_.ambient_c);
+  const double q_loss   = P_.wall_loss_g_w_k * (wall_c_ - P_.ambient_c);
+
+  heater_c_ += dt * (q_in - q_h_air) / P_.heater_c_j_k;
+  air_c_    += dt * (q_h_air - q_a_wall - q_a_parts - q_door) / P_.air_c_j_k;
+  wall_c_   += dt * (q_a_wall - q_loss) / P_.wall_c_j_k;
+
+  energy_j_ += q_in * dt;
+  t_s_      += dt;
+}
+
+double SimOven::noise() {
+  return P_.sensor_noise_c > 0 ? P_.sensor_noise_c * gauss_(rng_) : 0.0;
+}
+
+double SimOven::read_air(int zone) {
+  const double skew = kZoneSkew[zone % 5] * (air_c_ - P_.ambient_c) / 100.0;
+  return air_c_ + skew + noise();
+}
+
+double SimOven::read_ir(int slot) {
+  // Part fills the field of view when present; otherwise the back wall.
+  // Low emissivity pulls the reading slightly towards ambient.
+  const Part&  part   = parts_[slot];
+  const double target = part.present ? part.c : wall_c_;
+  const double bias   = (1.0 - P_.ir_emissivity) * 0.1 * (target - P_.ambient_c);
+  return target - bias + noise();
+}
+
+void SimOven::fill_frame(SampleFrame& frame) {
+  const int irs = std::clamp(P_.ir_sensors, 1, kMaxParts);
+  frame.acquired = now();
+  frame.count = static_cast<uint8_t>(5 + irs);
+  for (int i = 0; i < 5 + irs; ++i) {
+    frame.channel[i] = static_cast<uint8_t>(i + 1);
+    frame.quality[i] = kSampleOk;
+    frame.value[i]   = (i < 5) ? read_air(i) : read_ir(i - 5);
+  }
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "../ITempSensor.h"
+#include "../IRelay.h"
+#include "../../core/SampleFrame.h"
+
+/**
+ * Lumped thermal model of the oven, behind the same ITempSensor / IRelay
+ * interfaces as the real hardware.
+ *
+ * Nodes: heater elements, air, walls (skin + racks) and up to kMaxParts
+ * parts, one per rack position. The contactor switches heater power; the
+ * fans scale the convective coupling between nodes; an open door exchanges
+ * air with the room. Each rack position has its own IR sensor, which sees
+ * the part when one is inserted there and the back wall otherwise, so
+ * inserting a cold part produces the IR drop update_part_detection() waits
+ * for.
+ *
+ * Time only moves in advance(), so a 20 minute cure runs as fast as the
+ * caller can tick. Noise comes from a seeded generator: same seed, same run.
+ * Not thread-safe.
+ */
+class SimOven {
+public:
+  static constexpr int kMaxParts = 4;
+
+  struct Params {
+    double ambient_c          = 22.0;
+
+    double heater_w           = 12000.0;  // contactor closed
+    double heater_c_j_k       = 8000.0;   // element thermal mass
+    double heater_g_w_k       = 120.0;    // element -> air, fans off (fans add heater_fan_g_w_k)
+    double heater_fan_g_w_k   = 480.0;
+
+    double air_c_j_k          = 3000.0;   // ~2.9 m³ of air plus circulation ducting
+    double wall_c_j_k         = 90000.0;  // inner skin, racks, hangers
+    double air_wall_g_w_k     = 75.0;     // natural convection (fans add air_wall_fan_g_w_k)
+    double air_wall_fan_g_w_k = 300.0;
+    double wall_loss_g_w_k    = 15.0;     // through insulation and seals
+    double door_open_g_w_k    = 400.0;    // air exchange while the door is open
+
+    double part_h_w_m2k       = 6.0;      // natural convection on the part
+    double part_fan_h_w_m2k   = 22.0;     // added with both fans running
+    double part_area_m2       = 2.0;      // each
+
+    double sensor_noise_c     = 0.1;      // 1 σ on every reading
+    double ir_emissivity      = 0.9;      // uncorrected ε error pulls IR readings towards ambient
+    int    ir_sensors         = 1;        // CH6, CH7, ...: rack positions 0, 1, ... in frames
+    double controller_hyst_c  = 1.0;      // THKA on/off band around the setpoint
+    double max_step_s         = 0.05;     // integration sub-step
+  };
+
+  SimOven();
+  explicit SimOven(Params p, uint32_t seed = 1);
+
+  // ---- plant I/O (same interfaces as the hardware) ----
+  ITempSensor& air_sensor()  { return air_; }
+  ITempSensor& part_sensor() { return ir_; }
+  IRelay& contactor() { return contactor_; }
+  IRelay& fan()       { return fan_; }
+  IRelay& fan2()      { return fan2_; }
+
+  // The THKA regulates the heaters itself once given a setpoint (on/off on
+  // CH1 with hysteresis); the contactor only enables power. NaN = no
+  // setpoint, full power whenever the contactor is closed.
+  void set_controller_setpoint(double c) { setpoint_c_ = c; }
+
+  // Frame laid out like the THKA: CH1..CH5 air zones, then one IR channel
+  // per rack position from CH6 (ir_sensors of them)
+  void fill_frame(SampleFrame& frame);
+
+  // ---- time ----
+  void   advance(double seconds);
+  double time_s() const { return t_s_; }
+
+  // Simulated steady_clock, for StateMachine::tick()
+  std::chrono::steady_clock::time_point now() const {
+    return epoch_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                      std::chrono::duration<double>(t_s_));
+  }
+
+  // ---- events ----
+  void set_door_open(bool open) { door_open_ = open; }
+  bool door_open() const { return door_open_; }
+
+  // A part enters rack position slot at temp_c (room temperature if NaN);
+  // replaces any part there
+  void insert_part(double mass_kg, double cp_j_kgk = 500.0,
+                   double temp_c = std::numeric_limits<double>::quiet_NaN(), int slot = 0);
+  // Unload the whole rack
+  void remove_part() { for (auto& p : parts_) p.present = false; }
+  bool part_present(int slot = 0) const { return parts_[slot].present; }
+
+  // ---- true state (no noise) ----
+  double air_c()    const { return air_c_; }
+  double wall_c()   const { return wall_c_; }
+  double part_c(int slot = 0) const { return parts_[slot].c; }
+  double heater_c() const { return heater_c_; }
+  double energy_kwh() const { return energy_j_ / 3.6e6; }
+
+private:
+  struct Relay : IRelay {
+    bool on{false};
+    void set(bool v) override { on = v; }
+    bool get() const override { return on; }
+  };
+
+  struct Probe : ITempSensor {
+    SimOven* oven;
+    bool ir;
+    Probe(SimOven* o, bool is_ir) : oven(o), ir(is_ir) {}
+    double read_celsius() override { return ir ? oven->read_ir(0) : oven->read_air(0); }
+  };
+
+  struct Part {
+    bool   present{false};
+    double c_j_k{0.0};
+    double c{0.0};
+  };
+
+  void   step(double dt);
+  double noise();
+  double read_air(int zone);
+  double read_ir(int slot);
+
+  Params P_;
+  std::mt19937 rng_;
+  std::normal_distribution<double> gauss_{0.0, 1.0};
+  std::chrono::steady_clock::time_point epoch_{};
+
+  Relay contactor_, fan_, fan2_;
+  Probe air_{this, false};
+  Probe ir_{this, true};
+
+  double t_s_{0.0};
+  double heater_c_, air_c_, wall_c_;
+  std::array<Part, kMaxParts> parts_{};
+  bool   door_open_{false};
+  double energy_j_{0.0};
+  double setpoint_c_{std::numeric_limits<double>::quiet_NaN()};
+  bool   calling_{true};                // THKA output state
+};
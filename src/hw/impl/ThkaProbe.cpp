@@ -0,0 +1,170 @@
+#include "ThkaProbe.h"
+#include <modbus/modbus.h>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// One single-register read with the given function code: the rc of the
+// libmodbus call, errno left as it set it
+int read_one(modbus_t* ctx, ThkaReadFn fn, uint16_t reg, uint16_t& val) {
+  return (fn == ThkaReadFn::Input)
+           ? modbus_read_input_registers(ctx, reg, 1, &val)
+           : modbus_read_registers(ctx, reg, 1, &val);
+}
+
+// silent: set if the device did not answer at all (as opposed to turning
+// a function code down); the register is then not tried further
+ThkaRegisterCaps probe_one(modbus_t* ctx, uint16_t reg, double scale, bool* silent = nullptr) {
+  ThkaRegisterCaps caps;
+  caps.reg     = reg;
+  caps.scale   = scale;
+  caps.value_c = std::nan("");
+
+  uint16_t val{};
+  for (ThkaReadFn fn : {ThkaReadFn::Input, ThkaReadFn::Holding}) {
+    const int rc = read_one(ctx, fn, reg, val);
+    if (rc == 1) {
+      caps.fn      = fn;
+      caps.value_c = val * scale;
+      break;
+    }
+    if (!thka_answered(rc, errno)) {
+      if (silent) *silent = true;
+      break;
+    }
+  }
+  return caps;
+}
+
+} // namespace
+
+std::vector<ThkaRegisterCaps> thka_probe_range(modbus_t* ctx, uint16_t first,
+                                               uint16_t count, double scale) {
+  std::vector<ThkaRegisterCaps> out;
+  out.reserve(count);
+  for (uint16_t i = 0; i < count; ++i)
+    out.push_back(probe_one(ctx, static_cast<uint16_t>(first + i), scale));
+  return out;
+}
+
+bool thka_answered(int rc, int err) {
+  return rc != -1 || (err >= EMBXILFUN && err <= EMBXGTAR);
+}
+
+bool thka_probe_channels(modbus_t* ctx, const std::vector<ThkaChannel>& channels,
+                         std::vector<ThkaRegisterCaps>& out) {
+  out.clear();
+  for (const auto& c : channels) {
+    const bool seen = std::any_of(out.begin(), out.end(),
+                                  [&](const ThkaRegisterCaps& k) { return k.reg == c.reg_meas; });
+    if (seen) continue;
+    // One timeout is enough: a silent device would cost one per register
+    bool silent = false;
+    out.push_back(probe_one(ctx, c.reg_meas, c.scale, &silent));
+    if (silent) return false;
+  }
+  std::sort(out.begin(), out.end(),
+            [](const ThkaRegisterCaps& a, const ThkaRegisterCaps& b) { return a.reg < b.reg; });
+
+  // Verify each contiguous same-function run with one block read.
+  std::vector<uint16_t> buf;
+  size_t i = 0;
+  while (i < out.size()) {
+    size_t j = i + 1;
+    while (j < out.size() && out[i].fn != ThkaReadFn::None && out[j].fn == out[i].fn &&
+           out[j].reg == out[j - 1].reg + 1 && j - i < MODBUS_MAX_READ_REGISTERS)
+      ++j;
+
+    const int n = static_cast<int>(j - i);
+    if (n > 1) {
+      buf.assign(n, 0);
+      int rc = (out[i].fn == ThkaReadFn::Input)
+                 ? modbus_read_input_registers(ctx, out[i].reg, n, buf.data())
+                 : modbus_read_registers(ctx, out[i].reg, n, buf.data());
+      for (size_t k = i; k < j; ++k) out[k].block = (rc == n);
+    }
+    i = j;
+  }
+  return true;
+}
+
+std::string thka_caps_cache_path(const ThkaConfig& cfg) {
+  std::string dir;
+  if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+    dir = std::string(xdg) + "/oven";
+  } else {
+    const char* home = std::getenv("HOME");
+    dir = (home ? std::string(home) : std::string("/home/pi")) + "/.cache/oven";
+  }
+
+  std::string dev = std::filesystem::path(cfg.device).filename().string();
+  if (dev.empty()) dev = "thka";
+  return dir + "/thka_" + dev + "_" + std::to_string(cfg.slave_id) + ".caps";
+}
+
+bool thka_load_caps(const std::string& path, const std::vector<ThkaChannel>& channels,
+                    std::vector<ThkaRegisterCaps>& out) {
+  std::ifstream in(path);
+  if (!in.is_open()) return false;
+
+  std::vector<ThkaRegisterCaps> caps;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream ss(line);
+    unsigned reg{}, fn{}, block{};
+    double scale{};
+    if (!(ss >> reg >> fn >> scale >> block)) return false;
+    if (fn != 0x03 && fn != 0x04) return false;
+
+    ThkaRegisterCaps k;
+    k.reg     = static_cast<uint16_t>(reg);
+    k.fn      = static_cast<ThkaReadFn>(fn);
+    k.scale   = scale;
+    k.block   = block != 0;
+    k.value_c = std::nan("");
+    caps.push_back(k);
+  }
+
+  // Every configured register must be present with the same scale.
+  for (const auto& c : channels) {
+    auto it = std::find_if(caps.begin(), caps.end(),
+                           [&](const ThkaRegisterCaps& k) { return k.reg == c.reg_meas; });
+    if (it == caps.end() || std::abs(it->scale - c.scale) > 1e-9) return false;
+  }
+
+  std::sort(caps.begin(), caps.end(),
+            [](const ThkaRegisterCaps& a, const ThkaRegisterCaps& b) { return a.reg < b.reg; });
+  out = std::move(caps);
+  return true;
+}
+
+bool thka_save_caps(const std::string& path, const std::vector<ThkaRegisterCaps>& caps) {
+  std::error_code ec;
+  std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+  // Write a sibling file and rename it over the old one so a crash never
+  // leaves a half-written cache behind.
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    out << "# THKA register capabilities: reg fn scale block\n";
+    for (const auto& k : caps) {
+      if (k.fn == ThkaReadFn::None) continue;
+      out << k.reg << " " << static_cast<unsigned>(k.fn) << " "
+          << k.scale << " " << (k.block ? 1 : 0) << "\n";
+    }
+    if (!out) return false;
+  }
+
+  std::filesystem::rename(tmp, path, ec);
+  return !ec;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ThkaRs485Temp.h"
+
+typedef struct _modbus modbus_t;
+
+// Modbus function code a THKA register answers reads on.
+enum class ThkaReadFn : uint8_t {
+  None    = 0x00,  // did not answer either function
+  Holding = 0x03,
+  Input   = 0x04,
+};
+
+// What the probe learned about one register. There is no valid range:
+// the THKA has no register describing one and a single probe reading
+// cannot tell it. Implausible readings are left to FilterBank's Hampel stage.
+struct ThkaRegisterCaps {
+  uint16_t   reg{0};
+  ThkaReadFn fn{ThkaReadFn::None};
+  double     scale{0.1};   // °C per raw count, as configured when probed
+  bool       block{false}; // answers as part of a multi-register read
+  double     value_c{0};   // reading taken during the probe (not persisted)
+};
+
+// Probe every register in [first, first + count) one by one: try 0x04,
+// then 0x03, and record which one answered. Used by scan_registers.
+std::vector<ThkaRegisterCaps> thka_probe_range(modbus_t* ctx, uint16_t first,
+                                               uint16_t count, double scale);
+
+// The device answered a read (rc from libmodbus, err its errno), if only
+// with a Modbus exception, as opposed to a timeout or a garbled frame
+bool thka_answered(int rc, int err);
+
+// Probe the measurement registers of the configured channels, then verify
+// that contiguous runs sharing a function code also answer as one block.
+// Gives up, returning false, at the first register the device does not
+// answer at all.
+bool thka_probe_channels(modbus_t* ctx, const std::vector<ThkaChannel>& channels,
+                         std::vector<ThkaRegisterCaps>& out);
+
+// On-disk cache, keyed by device and slave id:
+//   $XDG_CACHE_HOME/oven/thka_<device>_<slave>.caps  (or ~/.cache/oven/...)
+std::string thka_caps_cache_path(const ThkaConfig& cfg);
+
+// Load cached caps. Returns false if the file is missing, unreadable, or does
+// not cover every configured channel with a matching scale.
+bool thka_load_caps(const std::string& path, const std::vector<ThkaChannel>& channels,
+                    std::vector<ThkaRegisterCaps>& out);
+
+// Save caps; registers that answered neither function are left out so they
+// are probed again on the next connect.
+bool thka_save_caps(const std::string& path, const std::vector<ThkaRegisterCaps>& caps);
@@ -1,56 +1,567 @@
 #include "ThkaRs485Temp.h"
+#include "ThkaProbe.h"
+#include "core/Diagnostics.h"
+#include "core/LinkHealth.h"
 #include <modbus/modbus.h>
 #include <cmath>
-#include <stdexcept>
 #include <cerrno>
 #include <iostream>
 #include <mutex>
-#include <thread>
 #include <chrono>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Inter-byte gaps the host sees include the USB-serial adapter's latency
+// timer (16 ms on FTDI), whatever the line rate
+constexpr double kMinByteTimeout_s = 0.02;
+constexpr double kMaxByteTimeout_s = 0.2;
+constexpr double kMaxResponseTimeout_s = 1.0;
+
+void set_timeout(modbus_t* ctx, int (*set)(modbus_t*, uint32_t, uint32_t), double s) {
+  const auto us = static_cast<uint32_t>(std::lround(s * 1e6));
+  set(ctx, us / 1000000, us % 1000000);
+}
+
+ThkaReadFn other_fn(ThkaReadFn fn) {
+  return fn == ThkaReadFn::Holding ? ThkaReadFn::Input : ThkaReadFn::Holding;
+}
+
+} // namespace
 
 // -----------------------------------------------------------------------------
 // Internal "Impl" struct - MUST be defined BEFORE we use p_->anything
 // -----------------------------------------------------------------------------
 struct ThkaRs485Temp::Impl {
+  // A run of consecutive measurement registers fetched with one request.
+  // slots[k] is the index into cfg.channels for register (start + k).
+  struct Span {
+    uint16_t start;
+    uint16_t count;
+    ThkaReadFn fn;        // None = not learned yet, try 0x04 then 0x03
+    bool block;           // every member answered a multi-register read
+    std::vector<int> slots;
+    std::vector<int> members;        // slots plus channels aliasing their registers
+    LatencyHistogram* rtt{nullptr};  // set by set_diagnostics()
+    RttEstimator est{};              // response timeout for this span's read
+  };
+
   ThkaConfig cfg;
-  modbus_t* ctx{nullptr};
+  modbus_t* ctx{nullptr};      // null while disconnected
+  bool lost{false};            // a hard I/O error since connect()
+  std::string error;           // why the last connect() failed or the link was lost
+  Diagnostics* diag{nullptr};
+  std::string caps_path;
+  std::vector<ThkaRegisterCaps> caps;  // per measurement register, sorted by reg
+  std::vector<Span> spans;             // built from cfg.channels + caps
+  std::vector<uint16_t> rx;            // scratch buffer, sized for the largest span
+  std::vector<LatencyHistogram*> write_rtt;  // indexed like cfg.channels
+  std::vector<LatencyHistogram*> sv_rtt;     // SV read-back, indexed like cfg.channels
+  std::vector<RttEstimator> sv_est;          // SV read-back (and write) timeouts, likewise
+  std::vector<int> span_of;                  // span reading each channel's register
+  std::vector<int> group;                    // set_span_groups(), indexed like cfg.channels
 
+  // Over the whole device: fails reads at once while it does not answer
+  CircuitBreaker breaker;
+
+  // Setpoints the device was last read back to hold (raw counts, -1 =
+  // unknown), indexed like cfg.channels. Only a read-back updates it.
+  std::vector<int32_t> sv_shadow;
+  ThkaReadFn sv_fn{ThkaReadFn::Holding};
+  std::vector<std::pair<uint16_t, size_t>> sv_runs;  // scratch: (SV register, entry)
+  std::vector<uint16_t> sv_buf;                      // scratch: one run's raw values
+
+  // Last poll, indexed like cfg.channels (preallocated, reused every poll)
+  std::vector<double>  fresh;
+  std::vector<double>  last_valid;
+  std::vector<uint8_t> quality;        // SampleQuality flags
+  std::vector<uint8_t> polled;         // read (or tried) since the last frame
+  std::vector<int>     primary;        // channel whose register read fills this one
+
+  // No bus traffic here: spans come from the capability cache, if it
+  // covers the config, until connect() can probe
   explicit Impl(const ThkaConfig& c) : cfg(c) {
-    ctx = modbus_new_rtu(c.device.c_str(), c.baud, c.parity, c.databits, c.stopbits);
-    if (!ctx)
-      throw std::runtime_error("modbus_new_rtu failed (could not open serial port)");
+    caps_path = thka_caps_cache_path(cfg);
+    if (!cfg.channels.empty())
+      thka_load_caps(caps_path, cfg.channels, caps);
+    build_spans();
+
+    fresh.assign(cfg.channels.size(), std::nan(""));
+    last_valid.assign(cfg.channels.size(), std::nan(""));
+    quality.assign(cfg.channels.size(), kSampleMissing);
+    polled.assign(cfg.channels.size(), 0);
+    sv_shadow.assign(cfg.channels.size(), -1);
+    sv_est.assign(cfg.channels.size(), RttEstimator(rtt_options(1)));
+    error = "not connected";
+  }
 
-    if (modbus_set_slave(ctx, c.slave_id) == -1)
-      throw std::runtime_error("modbus_set_slave failed");
+  // Time for one character on the line
+  double char_s() const {
+    const int bits = 1 + cfg.databits + (cfg.parity == 'N' ? 0 : 1) + cfg.stopbits;
+    return static_cast<double>(bits) / cfg.baud;
+  }
 
-    timeval tv{1, 0};
-    modbus_set_response_timeout(ctx, tv.tv_sec, tv.tv_usec);
+  // A read of `count` registers: never time out before request and answer
+  // can have crossed the wire twice over
+  RttEstimator::Options rtt_options(int count) const {
+    RttEstimator::Options o;
+    const int chars = 8 + 5 + 2 * count;
+    o.min_s = std::max(o.min_s, 2.0 * chars * char_s());
+    o.max_s = kMaxResponseTimeout_s;
+    return o;
+  }
 
-    if (modbus_connect(ctx) == -1)
-      throw std::runtime_error(std::string("modbus_connect failed: ") + modbus_strerror(errno));
+  // Response timeout from the estimate, byte timeout from its jitter
+  void set_timeouts(const RttEstimator& est) {
+    set_timeout(ctx, modbus_set_response_timeout, est.timeout_s());
+    set_timeout(ctx, modbus_set_byte_timeout,
+                std::clamp(est.rttvar_s(), kMinByteTimeout_s, kMaxByteTimeout_s));
   }
 
-  ~Impl() {
+  // One read request: timeouts from est, which learns from the answer;
+  // the breaker counts it
+  template <typename Fn>
+  int request(RttEstimator& est, LatencyHistogram* hist, Fn fn) {
+    set_timeouts(est);
+    const auto t0 = std::chrono::steady_clock::now();
+    const int rc  = fn();
+    const int err = errno;
+    const auto t1 = std::chrono::steady_clock::now();
+    if (hist) hist->record(t1 - t0);
+
+    if (thka_answered(rc, err)) {
+      est.sample(std::chrono::duration<double>(t1 - t0).count());
+      breaker.success();
+    } else {
+      est.timed_out();
+      if (breaker.failure(t1) && diag) ++diag->breaker_trips;
+      errno = err;
+      check_link();
+    }
+    errno = err;
+    return rc;
+  }
+
+  ~Impl() { close(); }
+
+  void close() {
     if (ctx) {
       modbus_close(ctx);
       modbus_free(ctx);
+      ctx = nullptr;
+    }
+  }
+
+  // A fresh libmodbus context every time: after a USB reset the old one
+  // holds a dead file descriptor
+  bool open() {
+    close();
+    lost = false;
+    ctx = modbus_new_rtu(cfg.device.c_str(), cfg.baud, cfg.parity, cfg.databits, cfg.stopbits);
+    if (!ctx) {
+      error = "modbus_new_rtu failed: " + std::string(modbus_strerror(errno));
+      return false;
+    }
+    if (modbus_set_slave(ctx, cfg.slave_id) == -1) {
+      error = "modbus_set_slave failed";
+      close();
+      return false;
+    }
+
+    // Nothing measured on a new port yet
+    set_timeouts(RttEstimator(rtt_options(1)));
+
+    if (modbus_connect(ctx) == -1) {
+      error = cfg.device + ": " + modbus_strerror(errno);
+      close();
+      return false;
+    }
+    error.clear();
+
+    // Without a cached layout, probe the device once and persist what it
+    // answered. A device that does not answer fails the connect, and a
+    // layout where nothing answered is not kept: both probe again next time.
+    if (caps.empty() && !cfg.channels.empty()) {
+      std::vector<ThkaRegisterCaps> probed;
+      if (!thka_probe_channels(ctx, cfg.channels, probed)) {
+        error = cfg.device + ": THKA not answering";
+        close();
+        return false;
+      }
+      if (std::any_of(probed.begin(), probed.end(),
+                      [](const ThkaRegisterCaps& k) { return k.fn != ThkaReadFn::None; })) {
+        caps = std::move(probed);
+        thka_save_caps(caps_path, caps);
+        build_spans();
+        apply_diagnostics();
+      }
+    }
+
+    // The device may have been power-cycled along with the link; and a
+    // breaker left open by the outage probes at once
+    std::fill(sv_shadow.begin(), sv_shadow.end(), -1);
+    breaker.probe();
+    return true;
+  }
+
+  // After a failed request: errors that mean the port itself is gone
+  // (adapter unplugged or reset) rather than a device not answering
+  void check_link() {
+    const int e = errno;
+    if (e == EIO || e == ENXIO || e == ENODEV || e == EBADF || e == EPIPE) {
+      lost  = true;
+      error = cfg.device + ": " + modbus_strerror(e);
+    }
+  }
+
+  void apply_diagnostics() {
+    write_rtt.assign(cfg.channels.size(), nullptr);
+    sv_rtt.assign(cfg.channels.size(), nullptr);
+    for (auto& s : spans)
+      s.rtt = diag ? diag->rtt("read", s.start) : nullptr;
+    if (!diag)
+      return;
+    for (size_t i = 0; i < cfg.channels.size(); ++i) {
+      write_rtt[i] = diag->rtt("write", cfg.channels[i].reg_sv);
+      sv_rtt[i]    = diag->rtt("read", cfg.channels[i].reg_sv);
+    }
+  }
+
+  ThkaRegisterCaps* caps_for(uint16_t reg) {
+    auto it = std::lower_bound(caps.begin(), caps.end(), reg,
+                               [](const ThkaRegisterCaps& k, uint16_t r) { return k.reg < r; });
+    return (it != caps.end() && it->reg == reg) ? &*it : nullptr;
+  }
+
+  // Group channels into contiguous register spans that share a function
+  // code (768..773 -> one span when all answer 0x04 as a block).
+  void build_spans() {
+    // A span whose registers stay the same keeps its timeout estimate
+    std::vector<Span> old;
+    old.swap(spans);
+    const auto group_of = [&](int idx) { return group.empty() ? -1 : group[idx]; };
+
+    // Stable, so of channels sharing a register the lowest index is the
+    // one kept in slots: primary[] below relies on it
+    std::vector<int> order(cfg.channels.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return cfg.channels[a].reg_meas < cfg.channels[b].reg_meas;
+    });
+
+    size_t widest = 0;
+    for (int idx : order) {
+      const uint16_t reg = cfg.channels[idx].reg_meas;
+      const ThkaRegisterCaps* k = caps_for(reg);
+      const ThkaReadFn fn = k ? k->fn : ThkaReadFn::None;
+      const bool block    = k && k->block;
+
+      if (!spans.empty()) {
+        Span& s = spans.back();
+        const int end = s.start + s.count;
+        if (reg < end) {                      // duplicate register
+          continue;
+        }
+        if (reg == end && fn != ThkaReadFn::None && fn == s.fn && block && s.block &&
+            group_of(idx) == group_of(s.slots.front()) && s.count < MODBUS_MAX_READ_REGISTERS) {
+          s.slots.push_back(idx);
+          ++s.count;
+          widest = std::max<size_t>(widest, s.count);
+          continue;
+        }
+      }
+      spans.push_back({reg, 1, fn, block, {idx}, {}});
+      widest = std::max<size_t>(widest, 1);
+    }
+    rx.assign(widest, 0);
+    for (auto& s : spans) {
+      s.est = RttEstimator(rtt_options(s.count));
+      for (const Span& o : old)
+        if (o.start == s.start && o.count == s.count) s.est = o.est;
+    }
+
+    // Channels sharing a register with an earlier one ride on its read
+    const auto& channels = cfg.channels;
+    primary.assign(channels.size(), -1);
+    for (size_t i = 0; i < channels.size(); ++i) {
+      primary[i] = static_cast<int>(i);
+      for (size_t j = 0; j < i; ++j) {
+        if (channels[j].reg_meas == channels[i].reg_meas) { primary[i] = static_cast<int>(j); break; }
+      }
+    }
+    span_of.assign(channels.size(), -1);
+    for (size_t k = 0; k < spans.size(); ++k) {
+      Span& s = spans[k];
+      for (int idx : s.slots)
+        for (size_t i = 0; i < channels.size(); ++i)
+          if (primary[i] == idx) {
+            s.members.push_back(static_cast<int>(i));
+            span_of[i] = static_cast<int>(k);
+          }
+    }
+  }
+
+  static int read_fn(modbus_t* ctx, ThkaReadFn fn, uint16_t start, int count, uint16_t* dst) {
+    return (fn == ThkaReadFn::Holding)
+             ? modbus_read_registers(ctx, start, count, dst)
+             : modbus_read_input_registers(ctx, start, count, dst);
+  }
+
+  int timed_read(Span& s, ThkaReadFn fn) {
+    return request(s.est, s.rtt, [&] { return read_fn(ctx, fn, s.start, s.count, rx.data()); });
+  }
+
+  // Read one span into out[] (indexed like cfg.channels). A span with a
+  // known function code costs exactly one request; an unknown one starts
+  // with 0x04. The other code is only tried when the device turns the
+  // first down (new firmware, another controller on the port), and is
+  // remembered if it answers. A timeout is not retried.
+  bool read_span(Span& s, std::vector<double>& out) {
+    if (!ctx || lost)
+      return false;
+    bool ok = false;
+    const ThkaReadFn first = s.fn != ThkaReadFn::None ? s.fn : ThkaReadFn::Input;
+    for (ThkaReadFn fn : {first, other_fn(first)}) {
+      const int rc = timed_read(s, fn);
+      if (rc == s.count) {
+        if (fn != s.fn) learn(s, fn);
+        ok = true;
+        break;
+      }
+      if (!thka_answered(rc, errno)) break;
+    }
+    if (!ok)
+      return false;
+
+    for (uint16_t k = 0; k < s.count; ++k) {
+      const int idx = s.slots[k];
+      out[idx] = rx[k] * cfg.channels[idx].scale;
+    }
+    return true;
+  }
+
+  // The span has just answered `fn`: unknown at probe time, or the cached
+  // code was turned down. The cache is rewritten so a restart agrees.
+  void learn(Span& s, ThkaReadFn fn) {
+    s.fn = fn;
+    for (uint16_t k = 0; k < s.count; ++k) {
+      if (ThkaRegisterCaps* c = caps_for(static_cast<uint16_t>(s.start + k)))
+        c->fn = fn;
+    }
+    thka_save_caps(caps_path, caps);
+  }
+
+  // Read one span into `fresh`. A member whose read failed holds its last
+  // valid value and is flagged stale (or missing if it never read).
+  // With the breaker open there is no last value to trust: members read
+  // NaN, missing, until the device answers again.
+  bool poll_span(Span& s) {
+    const auto now = std::chrono::steady_clock::now();
+    bool ok = false;
+    if (!ctx || lost) {
+      // No port: counts against the device like a timeout, without the wait
+      if (breaker.failure(now) && diag) ++diag->breaker_trips;
+    } else if (breaker.allow(now)) {
+      ok = read_span(s, fresh);
+    }
+    for (int i : s.members) {
+      if (ok) {
+        fresh[i]      = fresh[primary[i]];
+        last_valid[i] = fresh[i];
+        quality[i]    = kSampleOk;
+      } else {
+        mark_failed(i);
+      }
+      polled[i] = 1;
+    }
+    return ok;
+  }
+
+  void mark_failed(int i) {
+    fresh[i]   = breaker.open() ? std::nan("") : last_valid[i];
+    quality[i] = std::isnan(fresh[i]) ? kSampleMissing : kSampleStale;
+  }
+
+  // One transaction per contiguous register span instead of one per channel
+  void poll_all() {
+    for (auto& span : spans)
+      poll_span(span);
+  }
+
+  // Everything read since the last frame; channels that were not are held
+  // at their last valid value
+  void fill_frame(SampleFrame& frame) {
+    const size_t n = std::min(cfg.channels.size(), SampleFrame::kMaxChannels);
+    frame.acquired = std::chrono::steady_clock::now();
+    frame.count = static_cast<uint8_t>(n);
+    for (size_t i = 0; i < n; ++i) {
+      if (breaker.open()) {
+        mark_failed(static_cast<int>(i));
+      } else if (!polled[i]) {
+        fresh[i]   = last_valid[i];
+        quality[i] = std::isnan(fresh[i]) ? kSampleMissing : kSampleHeld;
+      }
+      frame.channel[i] = static_cast<uint8_t>(cfg.channels[i].id);
+      frame.value[i]   = fresh[i];
+      frame.quality[i] = quality[i];
     }
+    std::fill(polled.begin(), polled.end(), 0);
   }
 
-  double read_reg(uint16_t reg, double scale) {
+  // One channel's register on its own (timeouts from its span). As in
+  // read_span(), the other code is only tried when the first is turned
+  // down; the span learns from its own reads, not from this one.
+  double read_reg(int i) {
+    if (!ctx || lost || !breaker.allow(std::chrono::steady_clock::now()))
+      return std::nan("");
+    const ThkaChannel& c = cfg.channels[i];
+    RttEstimator& est = spans[span_of[i]].est;
     uint16_t val{};
-    int rc = modbus_read_input_registers(ctx, reg, 1, &val);
-    if (rc != 1)
-      rc = modbus_read_registers(ctx, reg, 1, &val);
+    const ThkaRegisterCaps* k = caps_for(c.reg_meas);
+    const ThkaReadFn first = k && k->fn != ThkaReadFn::None ? k->fn : ThkaReadFn::Input;
+    int rc = request(est, nullptr, [&] { return read_fn(ctx, first, c.reg_meas, 1, &val); });
+    if (rc != 1 && thka_answered(rc, errno))
+      rc = request(est, nullptr, [&] { return read_fn(ctx, other_fn(first), c.reg_meas, 1, &val); });
     if (rc != 1)
       return std::nan("");
-    return val * scale;
+    return val * c.scale;
+  }
+
+  int index_of(int ch) const {
+    for (size_t i = 0; i < cfg.channels.size(); ++i)
+      if (cfg.channels[i].id == ch) return static_cast<int>(i);
+    return -1;
+  }
+
+  static uint16_t sv_raw(double value, double scale) {
+    return static_cast<uint16_t>(std::clamp(std::lround(value / scale), 0L, 65535L));
   }
 
-  bool write_reg(uint16_t reg, double value, double scale) {
-    uint16_t raw = static_cast<uint16_t>(value / scale);
-    int rc = modbus_write_register(ctx, reg, raw);
-    return rc == 1;
+  // Sort sv_runs by register and call fn(first, count) for every run of
+  // consecutive registers (sv_runs[first .. first + count))
+  template <typename Fn>
+  void for_each_run(Fn fn) {
+    std::sort(sv_runs.begin(), sv_runs.end());
+    size_t first = 0;
+    for (size_t k = 1; k <= sv_runs.size(); ++k) {
+      if (k < sv_runs.size() && sv_runs[k].first == sv_runs[k - 1].first + 1 &&
+          k - first < MODBUS_MAX_WRITE_REGISTERS)
+        continue;
+      if (k > first) fn(first, k - first);
+      first = k;
+    }
+  }
+
+  size_t write_setpoints(std::vector<ThkaSetpoint>& sv) {
+    sv_runs.clear();
+    for (auto& e : sv) e.confirmed = e.sent = false;
+    if (!ctx || lost || breaker.open())
+      return 0;
+    for (size_t k = 0; k < sv.size(); ++k) {
+      const int i = index_of(sv[k].channel);
+      if (i < 0) continue;
+      const ThkaChannel& c = cfg.channels[i];
+      if (sv_shadow[i] == sv_raw(sv[k].value_c, c.scale)) {
+        sv[k].confirmed = true;    // already there, nothing to send
+        continue;
+      }
+      sv_runs.push_back({c.reg_sv, k});
+    }
+
+    size_t sent = 0;
+    for_each_run([&](size_t first, size_t count) {
+      if (lost) return;
+      sv_buf.resize(count);
+      for (size_t j = 0; j < count; ++j) {
+        const ThkaSetpoint& e = sv[sv_runs[first + j].second];
+        sv_buf[j] = sv_raw(e.value_c, cfg.channels[index_of(e.channel)].scale);
+      }
+      const int i = index_of(sv[sv_runs[first].second].channel);
+      LatencyHistogram* rtt = write_rtt.empty() ? nullptr : write_rtt[i];
+      // The answer is not trusted, so it teaches neither the estimate nor
+      // the breaker; the read-back does. A dead port is another matter.
+      set_timeouts(sv_est[i]);
+      const auto t0 = std::chrono::steady_clock::now();
+      errno = 0;
+      if (modbus_write_registers(ctx, sv_runs[first].first, static_cast<int>(count),
+                                 sv_buf.data()) == -1)
+        check_link();
+      if (rtt) rtt->record(std::chrono::steady_clock::now() - t0);
+      if (lost) return;
+      for (size_t j = 0; j < count; ++j) sv[sv_runs[first + j].second].sent = true;
+      sent += count;
+    });
+    return sent;
+  }
+
+  // Read the SV registers of sv_runs[first .. first + count) into sv_buf
+  // and the shadow with one request; sv[] is what sv_runs indexes. True if
+  // the run answered.
+  bool read_sv_run(const std::vector<ThkaSetpoint>& sv, size_t first, size_t count) {
+    sv_buf.resize(count);
+    const uint16_t start = sv_runs[first].first;
+    const int i0 = index_of(sv[sv_runs[first].second].channel);
+    LatencyHistogram* rtt = sv_rtt.empty() ? nullptr : sv_rtt[i0];
+    const int n = static_cast<int>(count);
+    int rc = request(sv_est[i0], rtt, [&] { return read_fn(ctx, sv_fn, start, n, sv_buf.data()); });
+    if (rc != n && thka_answered(rc, errno)) {
+      // Turned down: the other function code, remembered if it answers
+      const ThkaReadFn other = other_fn(sv_fn);
+      rc = request(sv_est[i0], rtt, [&] { return read_fn(ctx, other, start, n, sv_buf.data()); });
+      if (rc == n) sv_fn = other;
+    }
+
+    for (size_t j = 0; j < count; ++j)
+      sv_shadow[index_of(sv[sv_runs[first + j].second].channel)] = rc == n ? sv_buf[j] : -1;
+    return rc == n;
+  }
+
+  // Queue the SV registers of sv's entries in sv_runs (all of them, or
+  // only the unconfirmed). False if nothing may go on the bus.
+  bool collect_sv(const std::vector<ThkaSetpoint>& sv, bool unconfirmed_only) {
+    sv_runs.clear();
+    if (!ctx || lost || !breaker.allow(std::chrono::steady_clock::now()))
+      return false;
+    for (size_t k = 0; k < sv.size(); ++k) {
+      if (unconfirmed_only && sv[k].confirmed) continue;
+      const int i = index_of(sv[k].channel);
+      if (i >= 0) sv_runs.push_back({cfg.channels[i].reg_sv, k});
+    }
+    return true;
+  }
+
+  bool verify_setpoints(std::vector<ThkaSetpoint>& sv) {
+    if (!collect_sv(sv, true))
+      return false;
+
+    bool all = true;
+    for_each_run([&](size_t first, size_t count) {
+      const bool ok = read_sv_run(sv, first, count);
+      for (size_t j = 0; j < count; ++j) {
+        ThkaSetpoint& e = sv[sv_runs[first + j].second];
+        e.confirmed = ok && sv_buf[j] == sv_raw(e.value_c, cfg.channels[index_of(e.channel)].scale);
+        all = all && e.confirmed;
+      }
+    });
+    return all;
+  }
+
+  bool read_setpoints(std::vector<ThkaSetpoint>& sv) {
+    for (auto& e : sv) e.confirmed = false;
+    if (!collect_sv(sv, false))
+      return false;
+
+    for_each_run([&](size_t first, size_t count) {
+      if (!read_sv_run(sv, first, count)) return;
+      for (size_t j = 0; j < count; ++j) {
+        ThkaSetpoint& e = sv[sv_runs[first + j].second];
+        e.value_c   = sv_buf[j] * cfg.channels[index_of(e.channel)].scale;
+        e.confirmed = true;
+      }
+    });
+    return std::all_of(sv.begin(), sv.end(), [](const ThkaSetpoint& e) { return e.confirmed; });
   }
 };
 
@@ -71,79 +582,153 @@ double ThkaRs485Temp::read_celsius() {
   return read_channel_celsius(p_->cfg.channels.front().id);
 }
 
+bool ThkaRs485Temp::connect() {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return p_->open();
+}
+
+void ThkaRs485Temp::disconnect() {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  p_->close();
+  if (p_->error.empty()) p_->error = "not connected";
+}
+
+bool ThkaRs485Temp::connected() const {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return p_->ctx && !p_->lost;
+}
+
+std::string ThkaRs485Temp::last_error() const {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return p_->error;
+}
+
+std::vector<ThkaRegisterCaps> ThkaRs485Temp::probe_registers(uint16_t first, uint16_t count,
+                                                             double scale) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  if (!p_->ctx || p_->lost) return {};
+  p_->set_timeouts(RttEstimator(p_->rtt_options(1)));
+  return thka_probe_range(p_->ctx, first, count, scale);
+}
+
+bool ThkaRs485Temp::responding() const {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return !p_->breaker.open();
+}
+
+double ThkaRs485Temp::probe_interval_s() const {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return p_->breaker.open_s();
+}
+
+void ThkaRs485Temp::set_diagnostics(Diagnostics* diag) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  p_->diag = diag;
+  p_->apply_diagnostics();
+}
+
 double ThkaRs485Temp::read_channel_celsius(int ch) {
   std::lock_guard<std::mutex> lock(modbus_mutex_);  // Thread-safe
-  
-  for (const auto& c : p_->cfg.channels) {
-    if (c.id == ch)
-      return p_->read_reg(c.reg_meas, c.scale);
-  }
-  return std::nan("");
+
+  const int i = p_->index_of(ch);
+  return i < 0 ? std::nan("") : p_->read_reg(i);
 }
 
 bool ThkaRs485Temp::write_setpoint_celsius(int ch, double value) {
-  std::lock_guard<std::mutex> lock(modbus_mutex_);  // Thread-safe - CRITICAL!
-  
-  for (const auto& c : p_->cfg.channels) {
-    if (c.id == ch) {
-      uint16_t raw = static_cast<uint16_t>(value / c.scale);
-      
-      std::cout << "[THKA] Writing " << value << "°C to CH" << ch 
-                << " (register " << c.reg_sv << ", raw value " << raw << ")" << std::endl;
-      
-      // Small delay to ensure bus is clear
-      std::this_thread::sleep_for(std::chrono::milliseconds(50));
-      
-      bool modbus_result = p_->write_reg(c.reg_sv, value, c.scale);
-      
-      // QUIRK: THKA registers 0-5 report failure but actually work
-      if (c.reg_sv >= 0 && c.reg_sv <= 5) {
-        std::cout << "[THKA] Write sent to setpoint register " << c.reg_sv 
-                  << " (registers 0-5 report false failure)" << std::endl;
-        
-        // Give THKA time to process
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        return true;  // Always succeed for 0-5
-      }
-      
-      if (modbus_result) {
-        std::cout << "[THKA] Write successful!" << std::endl;
-      } else {
-        std::cerr << "[THKA] Write failed to register " << c.reg_sv << std::endl;
-      }
-      
-      return modbus_result;
-    }
+  // Up to three read-backs, each after a wait for the controller to latch
+  // SV (a few hundred ms on some): the register's measured response
+  // timeout, within kMinSettle_s..kMaxSettle_s, doubling each time
+  constexpr int kReadBacks = 3;
+  constexpr double kMinSettle_s = 0.1;
+  constexpr double kMaxSettle_s = 0.4;
+
+  std::vector<ThkaSetpoint> sv{{ch, value}};
+  const int i = p_->index_of(ch);
+  if (i < 0) {
+    std::cerr << "[THKA] ERROR: Channel " << ch << " not in config!" << std::endl;
+    return false;
+  }
+  if (write_setpoints_celsius(sv) == 0) return sv[0].confirmed;
+
+  double settle_s;
+  {
+    std::lock_guard<std::mutex> lock(modbus_mutex_);
+    const RttEstimator& est = p_->sv_est[i];
+    settle_s = std::clamp(est.measured() ? est.timeout_s() : kMinSettle_s, kMinSettle_s, kMaxSettle_s);
   }
-  
-  std::cerr << "[THKA] ERROR: Channel " << ch << " not in config!" << std::endl;
-  return false;
+  for (int k = 0; k < kReadBacks; ++k) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(settle_s));
+    if (verify_setpoints(sv)) break;
+    settle_s = std::min(2.0 * settle_s, kMaxSettle_s);
+  }
+  return sv[0].confirmed;
+}
+
+size_t ThkaRs485Temp::write_setpoints_celsius(std::vector<ThkaSetpoint>& sv) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return p_->write_setpoints(sv);
+}
+
+bool ThkaRs485Temp::verify_setpoints(std::vector<ThkaSetpoint>& sv) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return p_->verify_setpoints(sv);
+}
+
+bool ThkaRs485Temp::read_setpoints_celsius(std::vector<ThkaSetpoint>& sv) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return p_->read_setpoints(sv);
 }
 
 std::vector<double> ThkaRs485Temp::read_all_channels_celsius() {
   std::lock_guard<std::mutex> lock(modbus_mutex_);  // Thread-safe
-  
-  static std::vector<double> last_valid;
-  const auto& channels = p_->cfg.channels;
 
-  if (last_valid.size() != channels.size())
-      last_valid.assign(channels.size(), std::nan(""));
+  p_->poll_all();
+  return p_->fresh;
+}
 
-  std::vector<double> out;
-  out.reserve(channels.size());
+void ThkaRs485Temp::read_frame(SampleFrame& frame) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);  // Thread-safe
 
-  for (size_t i = 0; i < channels.size(); ++i) {
-    double val = p_->read_reg(channels[i].reg_meas, channels[i].scale);
+  p_->poll_all();
+  p_->fill_frame(frame);
+}
 
-    if (std::isnan(val)) {
-      val = last_valid[i];
-    } else {
-      last_valid[i] = val;
+size_t ThkaRs485Temp::span_count() const {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  return p_->spans.size();
+}
+
+std::vector<int> ThkaRs485Temp::span_channels(size_t span) const {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  std::vector<int> ids;
+  if (span >= p_->spans.size()) return ids;
+  for (int i : p_->spans[span].members)
+    ids.push_back(p_->cfg.channels[i].id);
+  return ids;
+}
+
+void ThkaRs485Temp::set_span_groups(const std::vector<std::vector<int>>& groups) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  const auto& channels = p_->cfg.channels;
+  std::vector<int> group(channels.size(), -1);
+  for (size_t g = 0; g < groups.size(); ++g)
+    for (int ch : groups[g]) {
+      const int i = p_->index_of(ch);
+      if (i >= 0) group[i] = static_cast<int>(g);
     }
+  if (group == p_->group) return;
+  p_->group = std::move(group);
+  p_->build_spans();
+  p_->apply_diagnostics();
+}
 
-    out.push_back(val);
-  }
+bool ThkaRs485Temp::read_span(size_t span) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  if (span >= p_->spans.size()) return false;
+  return p_->poll_span(p_->spans[span]);
+}
 
-  return out;
-}
\ No newline at end of file
+void ThkaRs485Temp::take_frame(SampleFrame& frame) {
+  std::lock_guard<std::mutex> lock(modbus_mutex_);
+  p_->fill_frame(frame);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../ITempSensor.h"
+#include "../../core/SampleFrame.h"
 #include <string>
 #include <vector>
 #include <cstdint>
@@ -23,16 +24,106 @@ struct ThkaConfig {
   std::vector<ThkaChannel> channels;
 };
 
+// One channel's setpoint in a batched write; confirmed once the device is
+// known to hold value_c (read back, or already there per the shadow); sent
+// if the write went out on the bus
+struct ThkaSetpoint {
+  int    channel;
+  double value_c;
+  bool   confirmed{false};
+  bool   sent{false};
+};
+
+struct ThkaRegisterCaps;  // ThkaProbe.h
+class Diagnostics;
+
+/**
+ * The THKA temperature controller over Modbus RTU.
+ *
+ * The constructor does not touch the port, so a missing or late USB-RS485
+ * adapter never stops the caller: connect() opens it (probing register
+ * capabilities the first time, unless cached) and can be called again
+ * whenever connected() turns false. Until then reads fail at once (stale
+ * or missing samples) and setpoints are not sent. connected() turns false
+ * on errors that mean the port is gone (unplugged, reset).
+ *
+ * Every read waits for its answer as long as the round trips measured for
+ * that span (or SV register) say it should: srtt + 4·rttvar, doubled per
+ * timeout in a row, within the frames' wire time and 1 s; the byte timeout
+ * follows the measured jitter. A device that does not answer five reads in
+ * a row (or has no port) trips a circuit breaker: reads then fail without
+ * touching the bus and their channels read NaN, kSampleMissing, instead of
+ * a stale value. One read is let through as a probe after 1 s, then after
+ * twice as long each time it fails, up to 30 s.
+ */
 class ThkaRs485Temp : public ITempSensor {
 public:
   explicit ThkaRs485Temp(const ThkaConfig& cfg);
   ~ThkaRs485Temp() override;
 
+  // Open (or reopen) the port with a fresh libmodbus context. False if it
+  // failed, with the reason in last_error().
+  bool connect();
+  void disconnect();
+  bool connected() const;
+  std::string last_error() const;   // why it is not connected; empty when it is
+
+  // The circuit breaker is closed (or probing); while it is open, the
+  // seconds between probes
+  bool   responding() const;
+  double probe_interval_s() const;
+
   double read_celsius() override;
   double read_channel_celsius(int ch);
+  // Write one setpoint and read it back (waiting for the controller to
+  // latch it, under a second in all); true once the device holds it
   bool   write_setpoint_celsius(int ch, double value);
+
+  // Batched setpoints. Channels the device already holds the value for
+  // (per the shadow of the last read-back) are confirmed without touching
+  // the bus; the rest go out as one 0x10 write per run of contiguous SV
+  // registers. Returns how many were sent. The write's own answer is not
+  // trusted (SV 0-5 report failure when the write has landed), so sent
+  // setpoints stay unconfirmed until verify_setpoints(); an error that
+  // means the port is gone stops the batch, and the rest are not sent.
+  size_t write_setpoints_celsius(std::vector<ThkaSetpoint>& sv);
+
+  // Read back the SV registers of the unconfirmed entries (one 0x03 read
+  // per contiguous run) into the shadow, and confirm those that match.
+  // Returns true if every entry is confirmed.
+  bool   verify_setpoints(std::vector<ThkaSetpoint>& sv);
+  // What the device holds: every entry's SV register read into value_c
+  // (confirmed if it answered). Returns true if every entry was read.
+  bool   read_setpoints_celsius(std::vector<ThkaSetpoint>& sv);
   std::vector<double> read_all_channels_celsius();
 
+  // Same poll as read_all_channels_celsius(), into a preallocated frame with
+  // per-channel quality flags and the acquisition time (seq is left alone).
+  void read_frame(SampleFrame& frame);
+
+  // The same poll a span at a time, for a caller that schedules the bus
+  // itself: span_count() spans of contiguous registers, each read with one
+  // request by read_span() (true if it answered). take_frame() then fills
+  // frame with everything read since the last frame; a channel that was
+  // not read is flagged kSampleHeld and keeps its last valid value.
+  size_t span_count() const;
+  std::vector<int> span_channels(size_t span) const;  // THKA channel ids
+
+  // Never put channels of different groups (lists of channel ids) in one
+  // span, so the caller can read them at different rates; unlisted
+  // channels form one more group. Rebuilds the spans if that changes them.
+  void set_span_groups(const std::vector<std::vector<int>>& groups);
+  bool read_span(size_t span);
+  void take_frame(SampleFrame& frame);
+
+  // Probe [first, first + count) for 0x04/0x03 support (see ThkaProbe.h)
+  std::vector<ThkaRegisterCaps> probe_registers(uint16_t first, uint16_t count,
+                                                double scale = 0.1);
+
+  // Record the round-trip time of every Modbus transaction into diag
+  // (per span / register; not owned, may be null)
+  void set_diagnostics(Diagnostics* diag);
+
 private:
   struct Impl;
   Impl* p_;
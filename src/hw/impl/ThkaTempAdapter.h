@@ -1,35 +1,31 @@
 #pragma once
 #include "../ITempSensor.h"
-#include <cmath>
-#include <atomic>
+#include "../../core/SampleFrame.h"
 
 /**
  * NON-BLOCKING adapter for THKA channels
  * 
- * Returns the last cached value from ThkaPoller.
+ * Returns the channel's value from the latest SampleFrame that ThkaPoller
+ * published on the SampleBus.
  * This prevents blocking the GUI thread on every StateMachine tick.
  * 
- * The actual THKA reads happen in the background ThkaPoller thread,
- * and this adapter just returns the latest cached value.
+ * The actual THKA reads happen in the background ThkaPoller thread.
+ * StateMachine reads air and part from one frame when given the bus via
+ * setSampleSource(); this adapter covers plain ITempSensor users.
  */
 class ThkaTempAdapter : public ITempSensor {
 public:
-  ThkaTempAdapter(int channel)
-    : channel_(channel), cached_temp_(std::nan("")) {}
+  ThkaTempAdapter(const SampleBus& bus, int channel)
+    : bus_(bus), channel_(channel) {}
 
   // Called by StateMachine in GUI thread - returns cached value instantly
   double read_celsius() override {
-    return cached_temp_.load();
-  }
-  
-  // Called by ThkaPoller in worker thread - updates cache
-  void update_cache(double temp) {
-    cached_temp_.store(temp);
+    return bus_.load().value_of(channel_);
   }
   
   int channel() const { return channel_; }
 
 private:
+  const SampleBus& bus_;
   int channel_;
-  std::atomic<double> cached_temp_;  // Thread-safe cache
-};
\ No newline at end of file
+};
@@ -2,7 +2,13 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include <iostream>
+#include <cstdlib>
+#include <memory>
 #include "core/StateMachine.h"
+#include "core/ControlExecutor.h"
+#include "core/Diagnostics.h"
+#include "core/PollPolicy.h"
+#include "data/RecipeStore.h"
 #include "hw/IHeater.h"
 #include "hw/IFan.h"
 #include "hw/ITempSensor.h"
@@ -17,7 +23,9 @@ int main(int argc, char* argv[]) {
   QGuiApplication app(argc, argv);
 
   // ---- REAL THKA CONFIG ----
+  // OVEN_THKA_DEVICE points the app at another port, e.g. thka_emu's link
   ThkaConfig cfg;
+  if (const char* dev = std::getenv("OVEN_THKA_DEVICE"); dev && *dev) cfg.device = dev;
   cfg.channels = {
     {1, 768, 0, 0.1},  // CH1: Air temp - Read from 768, Write setpoint to 0
     {2, 769, 1, 0.1},  // CH2: Read temp from 769, Write setpoint to 1
@@ -26,19 +34,46 @@ int main(int argc, char* argv[]) {
     {5, 772, 4, 0.1},  // CH5: Read temp from 772, Write setpoint to 4
     {6, 773, 5, 0.1},  // CH6: IR sensor - Read from 773, Write setpoint to 5
   };
-  
+
+  // Does not open the port: the poller connects, and reconnects after a
+  // USB reset, on its own thread, so the GUI comes up without the adapter
   ThkaRs485Temp thka(cfg);
 
+  // ---- THKA READING FILTERS (same order as cfg.channels) ----
+  // Air zones: drop single-sample spikes, and no reading may move faster
+  // than the air can. IR: median of 3 against spikes, no slew limit (a part
+  // going in is a step). Calibration offsets/gains also go here.
+  ChannelFilter airFilter;
+  airFilter.hampel_k       = 3.5;
+  airFilter.hampel_min_c   = 1.0;
+  airFilter.rate_limit_c_s = 10.0;
+
+  ChannelFilter irFilter;
+  irFilter.median       = 3;
+  irFilter.hampel_k     = 3.5;
+  irFilter.hampel_min_c = 2.0;
+
+  const std::vector<ChannelFilter> thkaFilters = {
+    airFilter, airFilter, airFilter, airFilter, airFilter,  // CH1..CH5
+    irFilter,                                                // CH6
+  };
+
+  // Latency histograms (bus RTT, poll, tick jitter, sample age), shown on
+  // the DIAGNOSTICS page
+  Diagnostics diag;
+  thka.set_diagnostics(&diag);
+
   // ---- NON-BLOCKING TEMPERATURE SENSORS ----
-  // These adapters cache the last value from ThkaPoller
-  // StateMachine reads from cache (instant, non-blocking)
-  // ThkaPoller updates cache in background thread
-  ThkaTempAdapter air_sensor(1);   // Channel 1 = air temp
-  ThkaTempAdapter part_sensor(6);  // Channel 6 = IR sensor
+  // ThkaPoller publishes every poll as one SampleFrame on this bus
+  // StateMachine reads air + IR from the same frame (instant, non-blocking)
+  SampleBus samples;
+  ThkaTempAdapter air_sensor(samples, 1);   // Channel 1 = air temp
+  ThkaTempAdapter part_sensor(samples, 6);  // Channel 6 = IR sensor
 
   std::cout << "\n=== Temperature Sensors Configuration ===" << std::endl;
   std::cout << "Air sensor:  THKA Channel 1 (register 768) - CACHED" << std::endl;
   std::cout << "IR sensor:   THKA Channel 6 (register 773) - CACHED" << std::endl;
+  std::cout << "Air control: CH1, CH2, CH3, CH5 fused (median vote, mean)" << std::endl;
   std::cout << "Sensors use non-blocking cached values" << std::endl;
 
   // ---- GPIO ----
@@ -66,11 +101,64 @@ int main(int argc, char* argv[]) {
   P.ir_drop_delta_c    = 15.0;
 
   StateMachine sm(P, air_sensor, part_sensor, fan2, fan, greenL, redL, amberL, buzzerL, contactor);
+  sm.setSampleSource(&samples, air_sensor.channel(), part_sensor.channel());
+  // Controlled air = fusion of the chamber zones (CH4 is not one, as in the log)
+  sm.setAirZones({{1, 1.0}, {2, 1.0}, {3, 1.0}, {5, 1.0}});
+  // Part zones: one IR channel per rack position, each part cured on its
+  // own. Another pyrometer goes on a THKA input (cfg.channels, with an
+  // irFilter) and its channel id here.
+  sm.setPartZones({part_sensor.channel()});
+  sm.setDiagnostics(&diag);
+
+  // Warm-up ETA starts from what past cure logs say about this oven
+  const int heatupWindows = sm.learnHeatupFromLogs();
+  std::cout << "Heat-up model: " << heatupWindows << " windows learnt from cure logs" << std::endl;
+
+  // ---- Control thread (optional) ----
+  // OVEN_RT_CONTROL=<1..99> ticks the state machine on its own SCHED_FIFO
+  // thread at that priority; 0 uses the thread without RT scheduling.
+  // Unset keeps ticking on the GUI timer.
+  std::unique_ptr<ControlExecutor> control;
+  if (const char* rt = std::getenv("OVEN_RT_CONTROL")) {
+    ControlExecutor::Options opt;
+    opt.rt_priority = std::atoi(rt);
+    opt.diag = &diag;
+    control = std::make_unique<ControlExecutor>(sm, opt);
+  }
 
   // ---- Backend ----
   OvenBackend backend(&sm);
+  backend.setSampleBus(&samples);
+  backend.setControlExecutor(control.get());
+  backend.setDiagnostics(&diag);
+  backend.setThkaFilters(thkaFilters);
+  // Read every poll ahead of setpoint writes and the other channels: the
+  // fused air zones and the IR part detection runs on
+  backend.setThkaCriticalChannels({1, 2, 3, 5, part_sensor.channel()});
+  // 1 Hz while idle, the IR every cycle while waiting for a part
+  backend.setThkaPollPolicy(PollPolicy::defaults({1, 2, 3, 5}, {part_sensor.channel()}));
+
+  // Recipe library; a fresh install gets the defaults written out to edit
+  std::vector<Recipe> recipes;
+  std::string recipeErrors;
+  const std::string recipeFile = recipesPath();
+  if (!loadRecipes(recipeFile, recipes, recipeErrors)) {
+    recipes = defaultRecipes();
+    if (!saveRecipes(recipeFile, recipes))
+      std::cerr << "Could not write default recipes to " << recipeFile << std::endl;
+  }
+  if (!recipeErrors.empty()) std::cerr << recipeFile << ":\n" << recipeErrors;
+  std::cout << "Recipes: " << recipes.size() << " from " << recipeFile << std::endl;
+  backend.setRecipes(recipes);
   backend.setThka(&thka);
-  backend.setSensorAdapters(&air_sensor, &part_sensor);  // Connect adapters to backend
+  if (control) {
+    control->start();
+    std::cout << "Control loop: own thread, 50 ms, ";
+    if (control->realtime())
+      std::cout << "SCHED_FIFO priority " << control->rt_priority() << std::endl;
+    else
+      std::cout << "real-time disabled" << std::endl;
+  }
 
   // ---- QML Engine ----
   QQmlApplicationEngine engine;
@@ -1,10 +1,20 @@
 #include "OvenBackend.h"
 #include "ui/ThkaPoller.h"
 #include "hw/impl/ThkaRs485Temp.h"
-#include "hw/impl/ThkaTempAdapter.h"
+#include "ui/TrendModel.h"
+#include "core/BusScheduler.h"
+#include "core/ControlExecutor.h"
+#include "core/Diagnostics.h"
+#include "data/PidGainStore.h"
+#include <QDateTime>
+#include <QTime>
+#include <QStringList>
+#include <QDir>
 #include <QDebug>
 #include <QtMath>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 using Clock = std::chrono::steady_clock;
 
@@ -22,16 +32,34 @@ OvenBackend::OvenBackend(StateMachine* sm, QObject* parent)
     });
     tick_.start();
 
+    trend_ = new TrendModel(kTrendChannels, kTrendHours * 3600 * 10, this);
+    trendTimer_.setInterval(1000);
+    connect(&trendTimer_, &QTimer::timeout, trend_, &TrendModel::refresh);
+    trendTimer_.start();
+
     setStatus("Idle");
 }
 
+QObject* OvenBackend::trend() const {
+    return trend_;
+}
+
 void OvenBackend::setThka(ThkaRs485Temp* thka) {
     thka_ = thka;
     if (!thka_) return;
+    if (!bus_) {
+        qWarning() << "OvenBackend::setThka called without a SampleBus.";
+        return;
+    }
 
-    setManualSetpointStatus("Connected to THKA controller – ready to send setpoints");
+    // The poller connects on its own thread; onThkaLinkChanged() follows it
+    setManualSetpointStatus("Connecting to THKA controller…");
 
-    poller_ = new ThkaPoller(thka_);
+    poller_ = new ThkaPoller(thka_, bus_);
+    poller_->setDiagnostics(diag_);
+    poller_->setFilters(filters_);
+    poller_->setCriticalChannels(critical_);
+    poller_->setPollPolicy(pollPolicy_);
     poller_->moveToThread(&thkaThread_);
 
     connect(&thkaThread_, &QThread::finished, poller_, &QObject::deleteLater);
@@ -40,41 +68,43 @@ void OvenBackend::setThka(ThkaRs485Temp* thka) {
     
     // Connect to write completion signal
     connect(poller_, &ThkaPoller::writeComplete, this, &OvenBackend::onWriteComplete);
+    connect(poller_, &ThkaPoller::linkChanged,   this, &OvenBackend::onThkaLinkChanged);
 
     thkaThread_.start();
 }
 
-void OvenBackend::setSensorAdapters(ThkaTempAdapter* air, ThkaTempAdapter* part) {
-    airAdapter_ = air;
-    partAdapter_ = part;
-}
+void OvenBackend::onThkaUpdate(quint64 /*seq*/) {
+    // StateMachine reads (and logs) the bus itself on every tick; here we
+    // only feed the trend and the display from the same frame.
+    const SampleFrame frame = bus_->load();
+
+    // Trend history runs in every mode
+    trend_->append(frame.value.data(), frame.count);
 
-void OvenBackend::onThkaUpdate(const QVariantList& temps) {
-    // Update the sensor adapters with fresh data from THKA
-    if (airAdapter_ && temps.size() > 0) {
-        airAdapter_->update_cache(temps[0].toDouble());
-    }
-    if (partAdapter_ && temps.size() > 5) {
-        partAdapter_->update_cache(temps[5].toDouble());
-    }
-    
-    // Log data if in auto mode
-    if (sm_ && sm_->is_auto_mode() && temps.size() >= 6) {
-        std::vector<double> temp_vec;
-        temp_vec.reserve(temps.size());
-        for (const auto& t : temps) {
-            temp_vec.push_back(t.toDouble());
-        }
-        sm_->logCurrentState(temp_vec);
-    }
-    
     // Update GUI display
+    QVariantList temps;
+    temps.reserve(frame.count);
+    for (size_t i = 0; i < frame.count; ++i) {
+        temps.push_back(frame.value[i]);
+    }
     if (temps != thkaTemps_) {
         thkaTemps_ = temps;
         emit thkaTempsChanged();
     }
 }
 
+void OvenBackend::onThkaLinkChanged(bool up, const QString& detail) {
+    const bool wasUp = thkaLinkUp_;
+    thkaLinkUp_     = up;
+    thkaLinkStatus_ = detail;
+    emit thkaLinkChanged();
+
+    if (up && !wasUp)
+        setManualSetpointStatus("Connected to THKA controller – ready to send setpoints");
+    else if (!up)
+        setManualSetpointStatus("THKA link down – setpoints are sent when it is back");
+}
+
 void OvenBackend::onWriteComplete(int channel, bool success) {
     // This runs in GUI thread after write completes in background
     if (success) {
@@ -88,7 +118,28 @@ void OvenBackend::onWriteComplete(int channel, bool success) {
 }
 
 void OvenBackend::onTick() {
-    if (sm_) sm_->tick(Clock::now());
+    // With an executor the control thread ticks; the timer only refreshes status
+    if (!sm_ || (executor_ && executor_->running())) return;
+
+    const auto now = Clock::now();
+    if (diag_ && lastTick_ != Clock::time_point{}) {
+        const auto late = (now - lastTick_) - std::chrono::milliseconds(tick_.interval());
+        diag_->tick_jitter.record(late < Clock::duration::zero() ? -late : late);
+    }
+    lastTick_ = now;
+
+    sm_->tick(now);
+}
+
+void OvenBackend::runCommand(std::function<void(StateMachine&)> cmd) {
+    if (!sm_) return;
+    if (executor_ && executor_->running()) executor_->post(std::move(cmd));
+    else cmd(*sm_);
+}
+
+ControlStatus OvenBackend::controlStatus() const {
+    if (executor_ && executor_->running()) return executor_->status();
+    return sm_ ? sm_->status() : ControlStatus{};
 }
 
 // ============ MANUAL MODE COMMANDS ============
@@ -114,37 +165,37 @@ void OvenBackend::sendManualSetpoint(double value) {
 
 void OvenBackend::enterIdle() {
     if (!sm_) return;
-    sm_->command_enterIdle();
+    runCommand([](StateMachine& sm) { sm.command_enterIdle(); });
     setStatus("Idle");
 }
 
 void OvenBackend::enterWarming() {
     if (!sm_) return;
-    sm_->command_enterWarming();
+    runCommand([](StateMachine& sm) { sm.command_enterWarming(); });
     setStatus("Warming");
 }
 
 void OvenBackend::enterReady() {
     if (!sm_) return;
-    sm_->command_enterReady();
+    runCommand([](StateMachine& sm) { sm.command_enterReady(); });
     setStatus("Ready");
 }
 
 void OvenBackend::enterCuring() {
     if (!sm_) return;
-    sm_->command_enterCuring();
+    runCommand([](StateMachine& sm) { sm.command_enterCuring(); });
     setStatus("Curing");
 }
 
 void OvenBackend::enterShutdown() {
     if (!sm_) return;
-    sm_->command_enterShutdown();
+    runCommand([](StateMachine& sm) { sm.command_enterShutdown(); });
     setStatus("Shutdown");
 }
 
 void OvenBackend::enterFault() {
     if (!sm_) return;
-    sm_->command_enterFault();
+    runCommand([](StateMachine& sm) { sm.command_enterFault(); });
     setStatus("Fault");
 }
 
@@ -169,7 +220,7 @@ void OvenBackend::startAutoMode(double targetTemp) {
     }
     
     // Let StateMachine handle the control logic
-    sm_->command_startAutoMode(targetTemp);
+    runCommand([targetTemp](StateMachine& sm) { sm.command_startAutoMode(targetTemp); });
     
     // Update local state
     autoTargetTemp_ = targetTemp;
@@ -184,10 +235,77 @@ void OvenBackend::startAutoMode(double targetTemp) {
     setStatus("Auto: Starting");
 }
 
+void OvenBackend::startRecipe(int index) {
+    if (!sm_) {
+        qWarning() << "Cannot start recipe - StateMachine null";
+        return;
+    }
+
+    if (index < 0 || index >= static_cast<int>(recipes_.size())) {
+        qWarning() << "Cannot start recipe - no recipe" << index;
+        return;
+    }
+
+    if (!thka_ || !poller_) {
+        qWarning() << "Cannot start recipe - THKA not connected";
+        return;
+    }
+
+    // THKA setpoints at the hottest step: the SM ramps the air below it
+    const Recipe recipe = recipes_[index];
+    for (int ch = 1; ch <= 6; ++ch) {
+        QMetaObject::invokeMethod(poller_, "queueWrite", Qt::QueuedConnection,
+                                  Q_ARG(int, ch),
+                                  Q_ARG(double, recipe.max_c()));
+    }
+
+    runCommand([recipe](StateMachine& sm) { sm.command_startRecipe(recipe); });
+
+    autoTargetTemp_ = recipe.load_c;
+    autoModeActive_ = true;
+    autoCureComplete_ = false;
+
+    emit autoModeActiveChanged();
+    emit autoTargetTempChanged();
+    emit autoCureCompleteChanged();
+
+    setAutoStatus(QString("Starting %1...").arg(QString::fromStdString(recipe.name)));
+    setStatus("Auto: Starting");
+}
+
+void OvenBackend::setRecipes(const std::vector<Recipe>& recipes) {
+    recipes_.clear();
+    recipesModel_.clear();
+    for (const auto& r : recipes) {
+        if (!r.check().empty()) continue;
+        recipes_.push_back(r);
+
+        // "140°C 10 min part, 5°C/min → 200°C 12 min cure"
+        QStringList steps;
+        for (const auto& seg : r.segments) {
+            QString step;
+            if (seg.ramp_c_min > 0) step += QString("%1°C/min → ").arg(seg.ramp_c_min, 0, 'g', 3);
+            step += QString("%1°C %2 min %3")
+                .arg(seg.soak_c, 0, 'f', 0)
+                .arg(seg.soak_s / 60.0, 0, 'g', 3)
+                .arg(basisName(seg.basis));
+            steps << step;
+        }
+
+        QVariantMap m;
+        m["key"]     = QString::fromStdString(r.key);
+        m["name"]    = QString::fromStdString(r.name);
+        m["summary"] = steps.join(", ");
+        m["maxTemp"] = r.max_c();
+        recipesModel_.push_back(m);
+    }
+    emit recipesChanged();
+}
+
 void OvenBackend::cancelAutoMode() {
     if (!sm_) return;
     
-    sm_->command_cancelAutoMode();
+    runCommand([](StateMachine& sm) { sm.command_cancelAutoMode(); });
     
     autoModeActive_ = false;
     autoCureComplete_ = false;
@@ -202,9 +320,7 @@ void OvenBackend::cancelAutoMode() {
 
 void OvenBackend::acknowledgeAutoCureComplete() {
     // Tell StateMachine to exit AutoCureComplete state
-    if (sm_) {
-        sm_->command_acknowledgeAutoCureComplete();
-    }
+    runCommand([](StateMachine& sm) { sm.command_acknowledgeAutoCureComplete(); });
     
     // Reset UI state
     autoCureComplete_ = false;
@@ -214,11 +330,261 @@ void OvenBackend::acknowledgeAutoCureComplete() {
     emit autoModeActiveChanged();
 }
 
+// ============ PRE-HEAT ============
+
+void OvenBackend::schedulePreheat(double targetTemp, const QString& time, int recipe) {
+    if (!sm_) return;
+
+    if (!thka_ || !poller_) {
+        qWarning() << "Cannot schedule pre-heat - THKA not connected";
+        return;
+    }
+
+    const QTime at = QTime::fromString(time.trimmed(), "h:mm");
+    if (!at.isValid()) {
+        setPreheatStatus(QString("Invalid time \"%1\" (use hh:mm)").arg(time));
+        return;
+    }
+
+    // Next occurrence of hh:mm, as a steady_clock deadline for the SM
+    const QDateTime now = QDateTime::currentDateTime();
+    QDateTime by(now.date(), at);
+    if (by <= now) by = by.addDays(1);
+    const auto deadline = Clock::now() + std::chrono::milliseconds(now.msecsTo(by));
+
+    const bool useRecipe = recipe >= 0 && recipe < static_cast<int>(recipes_.size());
+    const double thkaSetpoint = useRecipe ? recipes_[recipe].max_c() : targetTemp;
+    if (useRecipe) targetTemp = recipes_[recipe].load_c;
+
+    // Setpoints go out now; nothing heats until the SM closes the contactor
+    for (int ch = 1; ch <= 6; ++ch) {
+        QMetaObject::invokeMethod(poller_, "queueWrite", Qt::QueuedConnection,
+                                  Q_ARG(int, ch),
+                                  Q_ARG(double, thkaSetpoint));
+    }
+
+    if (useRecipe) {
+        const Recipe r = recipes_[recipe];
+        runCommand([r, deadline](StateMachine& sm) { sm.command_schedulePreheat(r, deadline); });
+    } else {
+        runCommand([targetTemp, deadline](StateMachine& sm) {
+            sm.command_schedulePreheat(targetTemp, deadline);
+        });
+    }
+
+    autoTargetTemp_ = targetTemp;
+    emit autoTargetTempChanged();
+
+    preheatBy_ = at.toString("hh:mm");
+    preheatPending_ = true;
+    emit preheatPendingChanged();
+    setPreheatStatus(QString("Pre-heat to %1°C by %2 scheduled")
+        .arg(targetTemp, 0, 'f', 0)
+        .arg(preheatBy_));
+}
+
+void OvenBackend::cancelPreheat() {
+    if (!sm_) return;
+
+    runCommand([](StateMachine& sm) { sm.command_cancelPreheat(); });
+
+    preheatPending_ = false;
+    emit preheatPendingChanged();
+    setPreheatStatus("Pre-heat cancelled");
+}
+
+void OvenBackend::updatePreheatStatus(const ControlStatus& cs) {
+    const int eta = std::isnan(cs.warmup_eta_s) ? -1 : static_cast<int>(std::lround(cs.warmup_eta_s));
+    if (warmupEta_ != eta) {
+        warmupEta_ = eta;
+        emit warmupEtaChanged();
+    }
+
+    if (!cs.preheat_pending) {
+        if (preheatPending_) {
+            preheatPending_ = false;
+            emit preheatPendingChanged();
+            if (cs.mode == OperatingMode::Auto)
+                setPreheatStatus(QString("Pre-heat started for %1").arg(preheatBy_));
+        }
+        return;
+    }
+
+    const int startIn = std::max(0, static_cast<int>(cs.preheat_start_in_s));
+    setPreheatStatus(QString("Pre-heat to %1°C by %2 - starts in %3:%4 (warm-up %5)")
+        .arg(cs.preheat_target_c, 0, 'f', 0)
+        .arg(preheatBy_)
+        .arg(startIn / 3600)
+        .arg((startIn / 60) % 60, 2, 10, QChar('0'))
+        .arg(eta < 0 ? QString("learning") : QString("%1 min").arg((eta + 59) / 60)));
+}
+
+// ============ AIR ZONES ============
+
+void OvenBackend::updateAirZones(const ControlStatus& cs) {
+    const AirFusion::Result& a = cs.air;
+    const double spread = std::isnan(a.spread_c) ? -1.0 : std::round(a.spread_c * 10.0) / 10.0;
+
+    QString text;
+    if (a.zones_used > 1) {
+        text = QString("Spread %1°C  hottest CH%2 %3°C  coldest CH%4 %5°C")
+            .arg(spread, 0, 'f', 1)
+            .arg(a.hottest_ch).arg(a.hottest_c, 0, 'f', 1)
+            .arg(a.coldest_ch).arg(a.coldest_c, 0, 'f', 1);
+    }
+    if (a.degraded()) {
+        if (!text.isEmpty()) text += "  ";
+        text += QString("⚠ %1/%2 zones").arg(a.zones_used).arg(a.zones);
+        if (a.stale) text += " (held)";
+    }
+
+    if (airSpread_ == spread && airZonesStatus_ == text && airDegraded_ == a.degraded()) return;
+    airSpread_ = spread;
+    airZonesStatus_ = text;
+    airDegraded_ = a.degraded();
+    emit airZonesChanged();
+}
+
+// ============ PART ZONES ============
+
+void OvenBackend::updatePartZones(const ControlStatus& cs) {
+    QVariantList zones;
+    for (int i = 0; i < cs.part_zones; ++i) {
+        const PartZoneStatus& z = cs.parts[i];
+        QVariantMap m;
+        m["channel"]  = z.channel;
+        m["detected"] = z.detected;
+        m["atTemp"]   = z.at_temp;
+        m["done"]     = z.done;
+        m["temp"]     = std::isnan(z.part_c) ? -1.0 : std::round(z.part_c * 10.0) / 10.0;
+        m["progress"] = std::floor(z.cure_progress * 100.0);
+        m["timeLeft"] = z.seconds_left;
+        zones.push_back(m);
+    }
+    if (zones == partZones_) return;
+    partZones_ = zones;
+    emit partZonesChanged();
+}
+
+// ============ AUTOTUNE ============
+
+void OvenBackend::startAutotune(double setpoint) {
+    if (!sm_) {
+        qWarning() << "Cannot start autotune - StateMachine null";
+        return;
+    }
+
+    if (!thka_ || !poller_) {
+        qWarning() << "Cannot start autotune - THKA not connected";
+        return;
+    }
+
+    // THKA setpoints above the test setpoint, so its own loop never cuts
+    // the heaters before the relay does; the ones they replace are put
+    // back when the autotune ends, however it ends
+    QMetaObject::invokeMethod(poller_, "saveSetpoints", Qt::QueuedConnection);
+    const double thkaSetpoint = setpoint + StateMachine::kAutotuneThkaMarginC;
+    for (int ch = 1; ch <= 6; ++ch) {
+        QMetaObject::invokeMethod(poller_, "queueWrite", Qt::QueuedConnection,
+                                  Q_ARG(int, ch),
+                                  Q_ARG(double, thkaSetpoint));
+    }
+
+    // Until a status carries this start, a non-Autotune mode is the old one
+    autotuneStart_ = controlStatus().autotune_starts + 1;
+    const std::string key = Recipe::keyFor(setpoint);
+    runCommand([setpoint, key](StateMachine& sm) { sm.command_startAutotune(setpoint, key); });
+
+    autotuneActive_ = true;
+    emit autotuneActiveChanged();
+
+    setAutotuneStatus(QString("Starting at %1°C...").arg(setpoint, 0, 'f', 1));
+    setStatus("Autotune: Starting");
+}
+
+void OvenBackend::cancelAutotune() {
+    if (!sm_) return;
+
+    runCommand([](StateMachine& sm) { sm.command_cancelAutotune(); });
+    if (poller_)
+        QMetaObject::invokeMethod(poller_, "restoreSetpoints", Qt::QueuedConnection);
+
+    autotuneActive_ = false;
+    emit autotuneActiveChanged();
+
+    setAutotuneStatus("Cancelled");
+    setStatus("Idle");
+}
+
+void OvenBackend::updateAutotuneStatus(const ControlStatus& cs) {
+    const bool active = (cs.mode == OperatingMode::Autotune);
+    // A status that has seen the start command shows the relay running or,
+    // if it ended in its first tick (sensor fault), already finished
+    const bool finished = autotuneActive_ && !active &&
+                          cs.autotune_starts >= autotuneStart_;
+    if (autotuneActive_ && !active && !finished) return;
+
+    if (autotuneActive_ != active) {
+        autotuneActive_ = active;
+        emit autotuneActiveChanged();
+    }
+
+    if (active) {
+        setAutotuneStatus(QString("Relay test: cycle %1 / %2 (Air: %3°C)")
+            .arg(cs.autotune_cycles)
+            .arg(cs.autotune_cycles_needed)
+            .arg(std::isnan(cs.air_c) ? 0.0 : cs.air_c, 0, 'f', 1));
+        setStatus("Autotune: Running");
+        return;
+    }
+
+    if (!finished) return;
+
+    if (poller_)
+        QMetaObject::invokeMethod(poller_, "restoreSetpoints", Qt::QueuedConnection);
+    if (cs.autotune_phase == RelayAutotune::Phase::Done) {
+        setAutotuneStatus(QString("✓ Saved Kp %1  Ki %2  Kd %3")
+            .arg(cs.pid_gains.kp, 0, 'g', 3)
+            .arg(cs.pid_gains.ki, 0, 'g', 3)
+            .arg(cs.pid_gains.kd, 0, 'g', 3));
+    } else if (cs.autotune_phase == RelayAutotune::Phase::Failed) {
+        setAutotuneStatus(QString("Failed: %1").arg(QString::fromUtf8(cs.autotune_failure)));
+    }
+    setStatus("Idle");
+}
+
+void OvenBackend::updatePollState(const ControlStatus& cs) {
+    // The poller starts out in Idle/Manual, as the state machine does
+    if (!poller_ || (cs.state == polledState_ && cs.mode == polledMode_)) return;
+    polledState_ = cs.state;
+    polledMode_  = cs.mode;
+    QMetaObject::invokeMethod(poller_, "setControlState", Qt::QueuedConnection,
+                              Q_ARG(int, static_cast<int>(cs.state)),
+                              Q_ARG(int, static_cast<int>(cs.mode)));
+}
+
 void OvenBackend::updateAutoModeStatus() {
     if (!sm_) return;
     
+    // One snapshot per refresh, so state and temperatures agree
+    const ControlStatus cs = controlStatus();
+
+    updatePreheatStatus(cs);
+    updateAirZones(cs);
+    updatePartZones(cs);
+    updateAutotuneStatus(cs);
+    updatePollState(cs);
+
+    if (cureLogInMemory_ != cs.log_in_memory) {
+        cureLogInMemory_ = cs.log_in_memory;
+        if (cureLogInMemory_)
+            qWarning() << "Cure log cannot be written to disk - keeping it in memory";
+        emit cureLogInMemoryChanged();
+    }
+
     // Check if StateMachine is in auto mode
-    bool smInAutoMode = sm_->is_auto_mode();
+    bool smInAutoMode = (cs.mode == OperatingMode::Auto);
+    setAutoCureProgress(smInAutoMode ? cs.cure_progress * 100.0 : 0.0);
     
     if (autoModeActive_ != smInAutoMode) {
         autoModeActive_ = smInAutoMode;
@@ -228,16 +594,25 @@ void OvenBackend::updateAutoModeStatus() {
     if (!smInAutoMode) return;
     
     // Get current state and temperatures
-    State state = sm_->state();
-    double airTemp = thkaTemps_.isEmpty() ? 0.0 : thkaTemps_[0].toDouble();
-    double irTemp = (thkaTemps_.size() > 5) ? thkaTemps_[5].toDouble() : 0.0;
+    State state = cs.state;
+    double airTemp = std::isnan(cs.air_c) ? 0.0 : cs.air_c;
+    double irTemp = std::isnan(cs.ir_c) ? 0.0 : cs.ir_c;
     
     // Update status based on state
     switch(state) {
         case State::Warming:
-            setAutoStatus(QString("Warming: %1°C / %2°C")
-                .arg(airTemp, 0, 'f', 1)
-                .arg(sm_->auto_target_temp(), 0, 'f', 1));
+            if (cs.warmup_eta_s >= 0) {
+                const int eta = static_cast<int>(std::lround(cs.warmup_eta_s));
+                setAutoStatus(QString("Warming: %1°C / %2°C (ready in ~%3:%4)")
+                    .arg(airTemp, 0, 'f', 1)
+                    .arg(cs.auto_target_temp, 0, 'f', 1)
+                    .arg(eta / 60)
+                    .arg(eta % 60, 2, 10, QChar('0')));
+            } else {
+                setAutoStatus(QString("Warming: %1°C / %2°C")
+                    .arg(airTemp, 0, 'f', 1)
+                    .arg(cs.auto_target_temp, 0, 'f', 1));
+            }
             setStatus("Auto: Warming");
             break;
             
@@ -247,27 +622,65 @@ void OvenBackend::updateAutoModeStatus() {
             setStatus("Auto: Ready");
             break;
             
-        case State::Curing:
-            if (sm_->auto_part_at_temp()) {
-                int timeLeft = sm_->seconds_left();
+        case State::Curing: {
+            // The part that decides the load; the IR reading if none is tracked
+            const double partTemp = std::isnan(cs.part_c) ? irTemp : cs.part_c;
+            QString rack;
+            if (cs.part_zones > 1) {
+                int loaded = 0, done = 0;
+                for (int i = 0; i < cs.part_zones; ++i) {
+                    loaded += cs.parts[i].detected;
+                    done   += cs.parts[i].done;
+                }
+                rack = QString(" - %1/%2 parts cured").arg(done).arg(loaded);
+            }
+            // Multi-step recipe: which step, and the ramp while it runs
+            QString step;
+            if (cs.recipe_segments > 1)
+                step = QString("Step %1/%2 - ").arg(cs.recipe_segment + 1).arg(cs.recipe_segments);
+
+            if (cs.recipe_ramping) {
+                setAutoStatus(step + QString("Ramping to %1°C: air setpoint %2°C (Part: %3°C)%4")
+                    .arg(cs.segment_soak_c, 0, 'f', 0)
+                    .arg(cs.air_setpoint_c, 0, 'f', 1)
+                    .arg(partTemp, 0, 'f', 1)
+                    .arg(rack));
+                setStatus("Auto: Ramping");
+                setAutoCureTimeLeft(0);
+                break;
+            }
+
+            if (cs.auto_part_at_temp) {
+                int timeLeft = cs.seconds_left;
                 setAutoCureTimeLeft(timeLeft);
                 
                 int mins = timeLeft / 60;
                 int secs = timeLeft % 60;
                 
-                setAutoStatus(QString("Curing: %1:%2 remaining (Part: %3°C)")
+                setAutoStatus(step + QString("Curing: %1% - %2:%3 remaining (Part: %4°C)%5")
+                    .arg(cs.cure_progress * 100.0, 0, 'f', 0)
                     .arg(mins)
                     .arg(secs, 2, 10, QChar('0'))
-                    .arg(irTemp, 0, 'f', 1));
+                    .arg(partTemp, 0, 'f', 1)
+                    .arg(rack));
                 setStatus("Auto: Curing");
             } else {
-                setAutoStatus(QString("Heating part: %1°C / %2°C (±10°C)")
-                    .arg(irTemp, 0, 'f', 1)
-                    .arg(sm_->auto_target_temp(), 0, 'f', 1));
+                QString text = QString("Heating part: %1°C / %2°C")
+                    .arg(partTemp, 0, 'f', 1)
+                    .arg(cs.auto_target_temp, 0, 'f', 1);
+                if (!std::isnan(cs.part_eta_s)) {
+                    const int eta = static_cast<int>(std::lround(cs.part_eta_s));
+                    text += QString(" (+%1°C/min, ~%2:%3 to go)")
+                        .arg(cs.part_rate_c_min, 0, 'f', 1)
+                        .arg(eta / 60)
+                        .arg(eta % 60, 2, 10, QChar('0'));
+                }
+                setAutoStatus(step + text + rack);
                 setStatus("Auto: Heating");
                 setAutoCureTimeLeft(0);
             }
             break;
+        }
             
         case State::AutoCureComplete:
             setAutoStatus("✓ Cure Complete! Click OK to continue");
@@ -289,6 +702,76 @@ void OvenBackend::updateAutoModeStatus() {
     }
 }
 
+// ============ DIAGNOSTICS ============
+
+QVariantList OvenBackend::diagnosticsRows() const {
+    QVariantList out;
+    if (!diag_) return out;
+
+    auto ms = [](uint64_t us) { return us / 1000.0; };
+    for (const auto& r : diag_->rows()) {
+        const auto& s = r.snap;
+        QVariantMap row;
+        row["name"]  = QString::fromStdString(r.name);
+        row["count"] = static_cast<qulonglong>(s.total);
+        row["mean"]  = s.mean_us() / 1000.0;
+        row["p50"]   = ms(s.percentile_us(0.50));
+        row["p90"]   = ms(s.percentile_us(0.90));
+        row["p99"]   = ms(s.percentile_us(0.99));
+        row["p999"]  = ms(s.percentile_us(0.999));
+        row["max"]   = ms(s.max_us);
+        out.push_back(row);
+    }
+    return out;
+}
+
+QVariantMap OvenBackend::diagnosticsCounters() const {
+    QVariantMap out;
+    if (!diag_) return out;
+
+    const auto queued    = diag_->writes_queued.load();
+    const auto completed = diag_->writes_completed.load();
+    const auto failed    = diag_->writes_failed.load();
+    out["writesQueued"]    = static_cast<qulonglong>(queued);
+    out["writesCompleted"] = static_cast<qulonglong>(completed);
+    out["writesFailed"]    = static_cast<qulonglong>(failed);
+    out["writesPending"]   = static_cast<qulonglong>(queued - std::min(queued, completed + failed));
+    out["samplesRejected"] = static_cast<qulonglong>(diag_->samples_rejected.load());
+    out["breakerTrips"]    = static_cast<qulonglong>(diag_->breaker_trips.load());
+
+    QVariantList bus;
+    for (size_t c = 0; c < Diagnostics::kBusClasses; ++c) {
+        const auto& b = diag_->bus[c];
+        QVariantMap row;
+        row["name"]         = BusScheduler::className(static_cast<BusScheduler::Class>(c));
+        row["transactions"] = static_cast<qulonglong>(b.transactions.load());
+        row["failures"]     = static_cast<qulonglong>(b.failures.load());
+        row["missed"]       = static_cast<qulonglong>(b.missed_deadlines.load());
+        row["busMs"]        = b.bus_us.load() / 1000.0;
+        bus.push_back(row);
+    }
+    out["bus"] = bus;
+    return out;
+}
+
+QString OvenBackend::dumpDiagnostics() const {
+    if (!diag_) return {};
+
+    const QString dir = QDir::homePath() + "/cure_logs";
+    QDir().mkpath(dir);
+    const QString path = dir + "/diagnostics_"
+        + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".txt";
+    if (!diag_->dump(path.toStdString())) {
+        qWarning() << "Failed to write diagnostics to" << path;
+        return {};
+    }
+    return path;
+}
+
+void OvenBackend::resetDiagnostics() {
+    if (diag_) diag_->reset();
+}
+
 // ============ SETTERS ============
 
 void OvenBackend::setStatus(const QString& s) {
@@ -315,6 +798,24 @@ void OvenBackend::setAutoStatus(const QString& status) {
     emit autoStatusChanged();
 }
 
+void OvenBackend::setPreheatStatus(const QString& status) {
+    if (preheatStatus_ == status) return;
+    preheatStatus_ = status;
+    emit preheatStatusChanged();
+}
+
+void OvenBackend::setAutotuneStatus(const QString& status) {
+    if (autotuneStatus_ == status) return;
+    autotuneStatus_ = status;
+    emit autotuneStatusChanged();
+}
+
+void OvenBackend::setAutoCureProgress(double percent) {
+    if (qFuzzyCompare(autoCureProgress_ + 1.0, percent + 1.0)) return;
+    autoCureProgress_ = percent;
+    emit autoCureProgressChanged();
+}
+
 void OvenBackend::setAutoCureTimeLeft(int seconds) {
     if (autoCureTimeLeft_ == seconds) return;
     autoCureTimeLeft_ = seconds;
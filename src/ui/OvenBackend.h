@@ -4,11 +4,19 @@
 #include <QTimer>
 #include <QVariant>
 #include <QString>
+#include <chrono>
+#include <functional>
+#include <vector>
 #include "../core/StateMachine.h"
+#include "../core/SampleFrame.h"
+#include "../core/FilterBank.h"
+#include "../core/PollPolicy.h"
 
 class ThkaRs485Temp;
 class ThkaPoller;
-class ThkaTempAdapter;
+class TrendModel;
+class ControlExecutor;
+class Diagnostics;
 
 class OvenBackend : public QObject {
     Q_OBJECT
@@ -16,19 +24,73 @@ class OvenBackend : public QObject {
     Q_PROPERTY(QVariantList thkaTemps READ thkaTemps NOTIFY thkaTempsChanged)
     Q_PROPERTY(double manualSetpoint READ manualSetpoint NOTIFY manualSetpointChanged)
     Q_PROPERTY(QString manualSetpointStatus READ manualSetpointStatus NOTIFY manualSetpointStatusChanged)
+    // THKA link: up or not, and why not / when it retries
+    Q_PROPERTY(bool thkaLinkUp READ thkaLinkUp NOTIFY thkaLinkChanged)
+    Q_PROPERTY(QString thkaLinkStatus READ thkaLinkStatus NOTIFY thkaLinkChanged)
+    // The running cure log could not be opened on disk and is kept in memory
+    Q_PROPERTY(bool cureLogInMemory READ cureLogInMemory NOTIFY cureLogInMemoryChanged)
     
     // Auto mode properties
     Q_PROPERTY(bool autoModeActive READ autoModeActive NOTIFY autoModeActiveChanged)
     Q_PROPERTY(double autoTargetTemp READ autoTargetTemp NOTIFY autoTargetTempChanged)
     Q_PROPERTY(QString autoStatus READ autoStatus NOTIFY autoStatusChanged)
     Q_PROPERTY(int autoCureTimeLeft READ autoCureTimeLeft NOTIFY autoCureTimeLeftChanged)
+    Q_PROPERTY(double autoCureProgress READ autoCureProgress NOTIFY autoCureProgressChanged)
     Q_PROPERTY(bool autoCureComplete READ autoCureComplete NOTIFY autoCureCompleteChanged)
+    // Recipe library: one map per recipe {key, name, summary, maxTemp}
+    Q_PROPERTY(QVariantList recipes READ recipes NOTIFY recipesChanged)
+
+    // Learnt warm-up ETA (seconds, -1 unknown) and scheduled pre-heat
+    Q_PROPERTY(int warmupEta READ warmupEta NOTIFY warmupEtaChanged)
+    Q_PROPERTY(bool preheatPending READ preheatPending NOTIFY preheatPendingChanged)
+    Q_PROPERTY(QString preheatStatus READ preheatStatus NOTIFY preheatStatusChanged)
+
+    // Chamber uniformity from the fused air zones: spread (°C, -1 unknown),
+    // "hottest / coldest" text, and whether any zone is out of the estimate
+    Q_PROPERTY(double airSpread READ airSpread NOTIFY airZonesChanged)
+    Q_PROPERTY(QString airZonesStatus READ airZonesStatus NOTIFY airZonesChanged)
+    Q_PROPERTY(bool airDegraded READ airDegraded NOTIFY airZonesChanged)
+    // One map per part zone: channel, detected, atTemp, done, temp, progress (%), timeLeft
+    Q_PROPERTY(QVariantList partZones READ partZones NOTIFY partZonesChanged)
+
+    // Relay autotune of the air PID
+    Q_PROPERTY(bool autotuneActive READ autotuneActive NOTIFY autotuneActiveChanged)
+    Q_PROPERTY(QString autotuneStatus READ autotuneStatus NOTIFY autotuneStatusChanged)
+
+    // Trend history (all modes) for the live chart
+    Q_PROPERTY(QObject* trend READ trend CONSTANT)
 
 public:
     explicit OvenBackend(StateMachine* sm, QObject* parent = nullptr);
 
+    // bus: where ThkaPoller publishes SampleFrames (not owned). Call before setThka().
+    void setSampleBus(SampleBus* bus) { bus_ = bus; }
     void setThka(ThkaRs485Temp* thka);
-    void setSensorAdapters(ThkaTempAdapter* air, ThkaTempAdapter* part);
+
+    // executor: runs StateMachine::tick() on its own thread (not owned).
+    // When set, commands are posted to it and status is read from its
+    // snapshot; otherwise the GUI timer ticks the state machine directly.
+    void setControlExecutor(ControlExecutor* executor) { executor_ = executor; }
+
+    // diag: latency histograms for the diagnostics page (not owned). Call
+    // before setThka() so the poller records into it too.
+    void setDiagnostics(Diagnostics* diag) { diag_ = diag; }
+
+    // Per-channel filtering of THKA readings (ThkaConfig order). Call
+    // before setThka().
+    void setThkaFilters(const std::vector<ChannelFilter>& filters) { filters_ = filters; }
+
+    // THKA channel ids the poller reads every cycle ahead of everything
+    // else (see ThkaPoller::setCriticalChannels()). Call before setThka().
+    void setThkaCriticalChannels(const std::vector<int>& channels) { critical_ = channels; }
+
+    // How often the poller reads each channel, by controller state; it is
+    // told about every state or mode change. Call before setThka().
+    void setThkaPollPolicy(const PollPolicy& policy) { pollPolicy_ = policy; }
+
+    // Recipes offered in auto mode (see RecipeStore); only ones that pass
+    // Recipe::check() are kept
+    void setRecipes(const std::vector<Recipe>& recipes);
 
     // Manual mode commands
     Q_INVOKABLE void enterIdle();
@@ -41,37 +103,88 @@ public:
 
     // Auto mode commands
     Q_INVOKABLE void startAutoMode(double targetTemp);
+    Q_INVOKABLE void startRecipe(int index);   // into recipes
     Q_INVOKABLE void cancelAutoMode();
     Q_INVOKABLE void acknowledgeAutoCureComplete();
 
+    // Pre-heat: be at targetTemp by the next "hh:mm" (wall clock); the
+    // start time comes from the learnt warm-up model. With a recipe index,
+    // that recipe runs and the oven warms to its load temperature instead.
+    Q_INVOKABLE void schedulePreheat(double targetTemp, const QString& time, int recipe = -1);
+    Q_INVOKABLE void cancelPreheat();
+
+    // Autotune commands: relay test at setpoint, gains saved for that target
+    Q_INVOKABLE void startAutotune(double setpoint);
+    Q_INVOKABLE void cancelAutotune();
+
+    // Diagnostics page: one map per histogram {name, count, mean, p50, p90,
+    // p99, p999, max} in milliseconds, plus the setpoint write counters
+    Q_INVOKABLE QVariantList diagnosticsRows() const;
+    Q_INVOKABLE QVariantMap diagnosticsCounters() const;
+    Q_INVOKABLE QString dumpDiagnostics() const;   // returns the file path, "" on failure
+    Q_INVOKABLE void resetDiagnostics();
+
     // Getters
     QString status() const { return status_; }
     QVariantList thkaTemps() const { return thkaTemps_; }
     double manualSetpoint() const { return manualSetpoint_; }
     QString manualSetpointStatus() const { return manualSetpointStatus_; }
+    bool thkaLinkUp() const { return thkaLinkUp_; }
+    QString thkaLinkStatus() const { return thkaLinkStatus_; }
+    bool cureLogInMemory() const { return cureLogInMemory_; }
     
     bool autoModeActive() const { return autoModeActive_; }
     double autoTargetTemp() const { return autoTargetTemp_; }
     QString autoStatus() const { return autoStatus_; }
     int autoCureTimeLeft() const { return autoCureTimeLeft_; }
+    double autoCureProgress() const { return autoCureProgress_; }   // percent
     bool autoCureComplete() const { return autoCureComplete_; }
+    QVariantList recipes() const { return recipesModel_; }
+
+    int warmupEta() const { return warmupEta_; }
+    bool preheatPending() const { return preheatPending_; }
+    QString preheatStatus() const { return preheatStatus_; }
+
+    double airSpread() const { return airSpread_; }
+    QString airZonesStatus() const { return airZonesStatus_; }
+    bool airDegraded() const { return airDegraded_; }
+    QVariantList partZones() const { return partZones_; }
+
+    bool autotuneActive() const { return autotuneActive_; }
+    QString autotuneStatus() const { return autotuneStatus_; }
+
+    QObject* trend() const;
 
 signals:
     void statusChanged();
     void thkaTempsChanged();
     void manualSetpointChanged();
     void manualSetpointStatusChanged();
+    void thkaLinkChanged();
+    void cureLogInMemoryChanged();
     
     void autoModeActiveChanged();
     void autoTargetTempChanged();
     void autoStatusChanged();
     void autoCureTimeLeftChanged();
+    void autoCureProgressChanged();
     void autoCureCompleteChanged();
+    void recipesChanged();
+
+    void warmupEtaChanged();
+    void preheatPendingChanged();
+    void preheatStatusChanged();
+    void airZonesChanged();
+    void partZonesChanged();
+
+    void autotuneActiveChanged();
+    void autotuneStatusChanged();
 
 private slots:
     void onTick();
-    void onThkaUpdate(const QVariantList& temps);
+    void onThkaUpdate(quint64 seq);
     void onWriteComplete(int channel, bool success);
+    void onThkaLinkChanged(bool up, const QString& detail);
 
 private:
     void setStatus(const QString& s);
@@ -80,32 +193,79 @@ private:
     
     void setAutoStatus(const QString& status);
     void setAutoCureTimeLeft(int seconds);
+    void setAutoCureProgress(double percent);
     void setAutoCureComplete(bool complete);
     
+    void setPreheatStatus(const QString& status);
+    void setAutotuneStatus(const QString& status);
+
     void updateAutoModeStatus();
+    void updatePreheatStatus(const ControlStatus& cs);
+    void updateAirZones(const ControlStatus& cs);
+    void updatePartZones(const ControlStatus& cs);
+    void updateAutotuneStatus(const ControlStatus& cs);
+    void updatePollState(const ControlStatus& cs);
+
+    // Run a StateMachine command on whichever thread owns it
+    void runCommand(std::function<void(StateMachine&)> cmd);
+    ControlStatus controlStatus() const;
 
     StateMachine* sm_ = nullptr;
     ThkaRs485Temp* thka_ = nullptr;
+    ControlExecutor* executor_ = nullptr;   // not owned
+    Diagnostics* diag_ = nullptr;           // not owned
 
     QString status_ = "Idle";
     QTimer  tick_;
+    std::chrono::steady_clock::time_point lastTick_{};
 
     QThread     thkaThread_;
     ThkaPoller* poller_ = nullptr;
-    
-    // Sensor adapters (not owned)
-    ThkaTempAdapter* airAdapter_ = nullptr;
-    ThkaTempAdapter* partAdapter_ = nullptr;
+    SampleBus*  bus_ = nullptr;         // not owned
+    std::vector<ChannelFilter> filters_;
+    std::vector<int> critical_;
+    PollPolicy pollPolicy_;
+    State polledState_ = State::Idle;          // last told to the poller
+    OperatingMode polledMode_ = OperatingMode::Manual;
+
+    // Trend history: 6 channels, kTrendHours at the 10 Hz poll rate
+    static constexpr int kTrendChannels = 6;
+    static constexpr int kTrendHours = 4;
+    TrendModel* trend_ = nullptr;
+    QTimer      trendTimer_;
 
     QVariantList thkaTemps_;
     double manualSetpoint_ = 25.0;
     QString manualSetpointStatus_ = "THKA controller not connected";
     int manualSetpointChannel_ = 1;
+    bool thkaLinkUp_ = false;
+    QString thkaLinkStatus_ = "Connecting…";
+    bool cureLogInMemory_ = false;
 
     // Auto mode state (mirrors StateMachine state)
     bool autoModeActive_ = false;
     double autoTargetTemp_ = 200.0;
     QString autoStatus_ = "Not Active";
     int autoCureTimeLeft_ = 0;
+    double autoCureProgress_ = 0.0;
     bool autoCureComplete_ = false;
+
+    std::vector<Recipe> recipes_;
+    QVariantList recipesModel_;
+
+    // Warm-up / pre-heat state (mirrors StateMachine)
+    int warmupEta_ = -1;
+    bool preheatPending_ = false;
+    QString preheatStatus_;
+    QString preheatBy_;   // "hh:mm" as entered
+
+    double airSpread_ = -1.0;
+    QString airZonesStatus_;
+    bool airDegraded_ = false;
+    QVariantList partZones_;
+
+    // Autotune state (mirrors StateMachine autotune)
+    bool autotuneActive_ = false;
+    int autotuneStart_ = 0;     // autotune_starts value of the last start
+    QString autotuneStatus_ = "Not run";
 };
\ No newline at end of file
@@ -1,68 +1,367 @@
 #include "ThkaPoller.h"
 #include "hw/impl/ThkaRs485Temp.h"
+#include "core/Diagnostics.h"
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
 #include <exception>
+#include <map>
 
-ThkaPoller::ThkaPoller(ThkaRs485Temp* thka, QObject* parent)
-    : QObject(parent), thka_(thka) {}
+ThkaPoller::ThkaPoller(ThkaRs485Temp* thka, SampleBus* bus, QObject* parent)
+    : QObject(parent), thka_(thka), bus_(bus) {}
 
 void ThkaPoller::start() {
     // This runs in the worker thread (because we connect QThread::started -> start()).
     // Create the timer here so it belongs to the worker thread.
     timer_ = new QTimer(this);
-    timer_->setInterval(100); // 10 Hz
     connect(timer_, &QTimer::timeout, this, &ThkaPoller::doPoll);
+    configureSpans();
     timer_->start();
+
+    // First cycle (and connect attempt) right away
+    QTimer::singleShot(0, this, &ThkaPoller::doPoll);
+}
+
+void ThkaPoller::configureSpans() {
+    if (!thka_) return;
+
+    // Critical channels get spans of their own, so the others are read as
+    // background traffic rather than riding on the critical reads, and so
+    // does each poll rate. One scheduled read per span; critical if it
+    // carries a critical channel.
+    spanGroups_ = spanGroups();
+    thka_->set_span_groups(spanGroups_);
+    std::vector<BusScheduler::Read> reads(thka_->span_count());
+    for (size_t s = 0; s < reads.size(); ++s) {
+        for (int ch : thka_->span_channels(s))
+            if (std::find(critical_.begin(), critical_.end(), ch) != critical_.end())
+                reads[s].cls = BusScheduler::Class::Critical;
+    }
+    sched_.configure(reads);
+    sched_.set_diagnostics(diag_);
+    applyPeriods();
+}
+
+std::vector<std::vector<int>> ThkaPoller::spanGroups() const {
+    // By criticality and the period the policy gives each channel now
+    std::map<std::pair<bool, double>, std::vector<int>> groups;
+    for (size_t s = 0; s < thka_->span_count(); ++s) {
+        for (int ch : thka_->span_channels(s)) {
+            const bool critical = std::find(critical_.begin(), critical_.end(), ch) != critical_.end();
+            groups[{critical, policy_.period_s(state_, mode_, ch)}].push_back(ch);
+        }
+    }
+    std::vector<std::vector<int>> out;
+    for (auto& [key, ids] : groups) {
+        std::sort(ids.begin(), ids.end());
+        out.push_back(std::move(ids));
+    }
+    return out;
+}
+
+bool ThkaPoller::ensureLink() {
+    if (thka_->connected()) return true;
+
+    const auto now = Clock::now();
+    if (linkUp_) {
+        // Lost since the last cycle: start over with a fresh context
+        setLink(false, QString::fromStdString(thka_->last_error()));
+        thka_->disconnect();
+        nextConnect_ = now + backoff_;
+        return false;
+    }
+    if (now < nextConnect_) return false;
+
+    if (thka_->connect()) {
+        backoff_ = kReconnectMin;
+        configureSpans();   // a first connect may have probed a new layout
+        setLink(true, QStringLiteral("Connected"));
+        return true;
+    }
+
+    nextConnect_ = now + backoff_;
+    setLink(false, QString("%1 - retrying in %2 s")
+                       .arg(QString::fromStdString(thka_->last_error()))
+                       .arg(std::chrono::duration<double>(backoff_).count(), 0, 'f', 1));
+    backoff_ = std::min(backoff_ * 2, kReconnectMax);
+    return false;
+}
+
+void ThkaPoller::setLink(bool up, const QString& detail) {
+    if (up == linkUp_ && detail == linkDetail_) return;
+    if (up != linkUp_)
+        qWarning() << "[ThkaPoller] link" << (up ? "up" : "down:") << detail;
+    linkUp_     = up;
+    linkDetail_ = detail;
+    emit linkChanged(up, detail);
+}
+
+void ThkaPoller::setControlState(int state, int mode) {
+    const auto s = static_cast<State>(state);
+    const auto m = static_cast<OperatingMode>(mode);
+    if (s == state_ && m == mode_) return;
+    state_ = s;
+    mode_  = m;
+    applyPolicy();
+}
+
+void ThkaPoller::applyPolicy() {
+    if (!thka_ || !timer_) return;
+
+    // E.g. the part sensor every cycle in Ready, apart from the air
+    if (spanGroups() != spanGroups_) configureSpans();
+    else applyPeriods();
+}
+
+void ThkaPoller::applyPeriods() {
+    if (!thka_ || !timer_) return;
+
+    // A span is read as often as its most demanding channel asks
+    std::vector<double> period(sched_.reads(), PollPolicy::kFullRate_s);
+    double fastest = kMaxIntervalMs / 1000.0;
+    for (size_t s = 0; s < period.size(); ++s) {
+        const auto ids = thka_->span_channels(s);
+        for (size_t k = 0; k < ids.size(); ++k) {
+            const double p = policy_.period_s(state_, mode_, ids[k]);
+            period[s] = k == 0 ? p : std::min(period[s], p);
+        }
+        fastest = std::min(fastest, period[s]);
+    }
+
+    spanIntervalMs_ = std::clamp(static_cast<int>(std::lround(fastest * 1000.0)),
+                                 kMinIntervalMs, kMaxIntervalMs);
+    const double cycle_s = spanIntervalMs_ / 1000.0;
+    for (size_t s = 0; s < period.size(); ++s)
+        sched_.set_period(s, period[s], kDeadlineCycles * std::max(period[s], cycle_s));
+    sched_.set_budget(kBudgetShare * cycle_s);
+    updateTimer();
+
+    qDebug() << "[ThkaPoller]" << stateName(state_) << "- polling every" << spanIntervalMs_ << "ms";
+}
+
+void ThkaPoller::updateTimer() {
+    if (!timer_) return;
+    bool writing = !pending_.empty();
+    if (!writing) {
+        QMutexLocker lock(&writeMutex_);
+        writing = !writeQueue_.empty();
+    }
+    const int interval = writing ? std::min(spanIntervalMs_, kWriteIntervalMs) : spanIntervalMs_;
+    if (timer_->interval() != interval)
+        timer_->setInterval(interval);   // restarts an active timer
 }
 
 void ThkaPoller::queueWrite(int channel, double value) {
     // Called from GUI thread - just queue the request
-    QMutexLocker lock(&writeMutex_);
-    writeQueue_.push({channel, value});
+    {
+        QMutexLocker lock(&writeMutex_);
+        writeQueue_.push({channel, value, std::chrono::steady_clock::now()});
+    }
+    if (diag_) ++diag_->writes_queued;
     qDebug() << "[ThkaPoller] Queued write: CH" << channel << "=" << value << "°C";
+
+    // A slow (idle) cycle speeds up until the write is through; the timer
+    // belongs to the worker thread
+    QMetaObject::invokeMethod(this, [this] { updateTimer(); }, Qt::QueuedConnection);
+}
+
+void ThkaPoller::saveSetpoints() {
+    if (!thka_) return;
+
+    // A value still on its way is what the channel is meant to hold
+    takeWrites();
+    savedSv_.clear();
+    for (size_t s = 0; s < thka_->span_count(); ++s)
+        for (int ch : thka_->span_channels(s))
+            savedSv_.push_back({ch, std::nan("")});
+    if (thka_->connected()) thka_->read_setpoints_celsius(savedSv_);
+    for (auto& e : savedSv_) {
+        auto it = std::find_if(pending_.begin(), pending_.end(),
+                               [&](const PendingWrite& w) { return w.channel == e.channel; });
+        if (it != pending_.end()) {
+            e.value_c   = it->value;
+            e.confirmed = true;
+        }
+    }
+
+    const auto known = std::remove_if(savedSv_.begin(), savedSv_.end(),
+                                      [](const ThkaSetpoint& e) { return !e.confirmed; });
+    if (known != savedSv_.end())
+        qWarning() << "[ThkaPoller]" << (savedSv_.end() - known)
+                   << "setpoints unknown, they will not be restored";
+    savedSv_.erase(known, savedSv_.end());
 }
 
-void ThkaPoller::processWrites() {
-    // Process all queued writes (runs in worker thread)
+void ThkaPoller::restoreSetpoints() {
+    for (const auto& e : savedSv_) queueWrite(e.channel, e.value_c);
+    savedSv_.clear();
+}
+
+void ThkaPoller::takeWrites() {
+    // Take everything queued; a newer value for a channel replaces the
+    // one still on its way
     QMutexLocker lock(&writeMutex_);
-    
     while (!writeQueue_.empty()) {
-        ThkaWriteRequest req = writeQueue_.front();
+        const ThkaWriteRequest req = writeQueue_.front();
         writeQueue_.pop();
-        
-        // Unlock while doing the actual write (don't block GUI thread from queuing more)
-        lock.unlock();
-        
-        qDebug() << "[ThkaPoller] Processing write: CH" << req.channel << "=" << req.value << "°C";
-        
-        bool success = false;
-        try {
-            success = thka_->write_setpoint_celsius(req.channel, req.value);
-        } catch (const std::exception& e) {
-            qWarning() << "[ThkaPoller] Write failed:" << e.what();
+
+        auto it = std::find_if(pending_.begin(), pending_.end(),
+                               [&](const PendingWrite& w) { return w.channel == req.channel; });
+        if (it != pending_.end()) {
+            if (diag_) ++diag_->writes_completed;
+            *it = {req.channel, req.value, req.queued};
+        } else {
+            pending_.push_back({req.channel, req.value, req.queued});
         }
-        
-        emit writeComplete(req.channel, success);
-        
-        // Re-lock for next iteration
-        lock.relock();
     }
 }
 
-void ThkaPoller::doPoll() {
-    if (!thka_) return;
-    
-    // First, process any pending writes
-    processWrites();
-    
-    // Then do the temperature read
-    QVariantList out;
+bool ThkaPoller::sendWrites() {
+    // One batch for everything not on the bus yet (runs in worker thread)
+    batch_.clear();
+    for (const auto& w : pending_)
+        if (!w.sent) batch_.push_back({w.channel, w.value});
+    if (batch_.empty()) return true;
+
+    bool ok = true;
     try {
-        const auto v = thka_->read_all_channels_celsius(); // blocking, worker thread
-        out.reserve(static_cast<int>(v.size()));
-        for (double d : v) out.push_back(d);
+        thka_->write_setpoints_celsius(batch_);
+        ok = thka_->connected();   // the port may have gone mid-batch
     } catch (const std::exception& e) {
-        qWarning() << "[THKA] poll failed:" << e.what();
+        qWarning() << "[ThkaPoller] Write failed:" << e.what();
+        ok = false;
+    }
+
+    size_t b = 0;
+    for (size_t i = 0; i < pending_.size();) {
+        PendingWrite& w = pending_[i];
+        if (w.sent) { ++i; continue; }
+        const ThkaSetpoint& e = batch_[b++];
+        if (e.confirmed) {              // the device holds it
+            finishWrite(i, true);
+            continue;
+        }
+        if (!e.sent) { ++i; continue; } // not on the bus; next time
+        w.sent = true;
+        w.sent_at = cycleStart_;
+        ++w.attempts;
+        ++i;
     }
-    emit polled(out);  // queued to GUI thread
-}
\ No newline at end of file
+    return ok;
+}
+
+bool ThkaPoller::verifyWrites() {
+    batch_.clear();
+    for (const auto& w : pending_)
+        if (settled(w)) batch_.push_back({w.channel, w.value});
+    if (batch_.empty()) return true;
+
+    bool ok = false;
+    try {
+        ok = thka_->verify_setpoints(batch_);
+    } catch (const std::exception& e) {
+        qWarning() << "[ThkaPoller] Setpoint read-back failed:" << e.what();
+    }
+
+    size_t b = 0;
+    for (size_t i = 0; i < pending_.size();) {
+        PendingWrite& w = pending_[i];
+        if (!settled(w)) { ++i; continue; }
+        if (batch_[b++].confirmed) {
+            finishWrite(i, true);
+        } else if (w.attempts >= kWriteAttempts) {
+            qWarning() << "[ThkaPoller] CH" << w.channel << "setpoint" << w.value
+                       << "°C did not read back after" << w.attempts << "writes";
+            finishWrite(i, false);
+        } else {
+            w.sent = false;   // goes out again with the next batch
+            ++i;
+        }
+    }
+    return ok;
+}
+
+void ThkaPoller::finishWrite(size_t i, bool success) {
+    const PendingWrite w = pending_[i];
+    pending_.erase(pending_.begin() + static_cast<std::ptrdiff_t>(i));
+
+    if (diag_) {
+        diag_->write_latency.record(std::chrono::steady_clock::now() - w.queued);
+        ++(success ? diag_->writes_completed : diag_->writes_failed);
+    }
+    emit writeComplete(w.channel, success);
+}
+
+void ThkaPoller::doPoll() {
+    if (!thka_ || !bus_) return;
+
+    const auto t0 = Clock::now();
+    cycleStart_ = t0;
+    takeWrites();   // kept while the link is down, sent once it is back
+
+    if (ensureLink()) {
+        runCycle(t0);
+        // Failed polls count too: a timeout is exactly what we want to see
+        if (diag_) diag_->poll_duration.record(Clock::now() - t0);
+    } else {
+        // No bus: every channel fails at once and holds its last value
+        for (size_t s = 0; s < thka_->span_count(); ++s)
+            thka_->read_span(s);
+    }
+    thka_->take_frame(frame_);
+
+    // Consumers only ever see filtered, calibrated values
+    filters_.process(frame_);
+    if (diag_) {
+        for (size_t i = 0; i < frame_.count; ++i)
+            if (frame_.quality[i] & kSampleRejected) ++diag_->samples_rejected;
+    }
+
+    ++frame_.seq;
+    bus_->store(frame_);
+    emit polled(frame_.seq);  // queued to GUI thread
+
+    updateTimer();
+}
+
+void ThkaPoller::runCycle(Clock::time_point t0) {
+    using Kind = BusScheduler::Action::Kind;
+
+    // Setpoints sent in an earlier cycle have had time to land and are read
+    // back; new or unconfirmed ones are sent. The scheduler fits both around
+    // the critical reads. Nothing goes to a device the breaker has given up
+    // on; writes wait, like reads, for it to answer a probe.
+    const bool responding = thka_->responding();
+    bool verify = false, send = false;
+    Clock::time_point oldest{};
+    for (const auto& w : pending_) {
+        if (!w.sent) send = true;
+        else if (settled(w)) verify = true;
+        if (oldest == Clock::time_point{} || w.queued < oldest) oldest = w.queued;
+    }
+    sched_.begin_cycle(t0, verify && responding, send && responding, oldest);
+
+    for (auto a = sched_.next(t0); a.kind != Kind::None; a = sched_.next(Clock::now())) {
+        const auto start = Clock::now();
+        bool ok = false;
+        try {
+            switch (a.kind) {
+            case Kind::Read:   ok = thka_->read_span(a.read); break; // blocking, worker thread
+            case Kind::Verify: ok = verifyWrites(); break;
+            case Kind::Send:   ok = sendWrites(); break;
+            case Kind::None:   break;
+            }
+        } catch (const std::exception& e) {
+            qWarning() << "[THKA] poll failed:" << e.what();
+        }
+        sched_.done(a, start, Clock::now(), ok);
+        if (!thka_->connected()) return;   // port gone; ensureLink() reopens it
+    }
+
+    // The port is fine but the device may not be answering
+    if (thka_->responding())
+        setLink(true, QStringLiteral("Connected"));
+    else
+        setLink(false, QString("THKA not answering - probing every %1 s")
+                           .arg(thka_->probe_interval_s(), 0, 'f', 0));
+}
@@ -3,38 +3,163 @@
 #include <QTimer>
 #include <QVariant>
 #include <QMutex>
+#include <QString>
+#include <chrono>
 #include <queue>
+#include <vector>
+#include "core/BusScheduler.h"
+#include "core/FilterBank.h"
+#include "core/PollPolicy.h"
+#include "core/SampleFrame.h"
+#include "hw/impl/ThkaRs485Temp.h"
 
-class ThkaRs485Temp;
+class Diagnostics;
 
 struct ThkaWriteRequest {
     int channel;
     double value;
+    std::chrono::steady_clock::time_point queued;
 };
 
+/**
+ * Worker-thread owner of the THKA bus: poll cycles whose transactions are
+ * picked by a BusScheduler.
+ *
+ * Register spans holding a critical channel (setCriticalChannels()) are
+ * read first whenever due, with a deadline; setpoint writes come next,
+ * then the other spans as bus time allows. Whatever was read goes out as
+ * one SampleFrame; channels skipped this cycle are flagged kSampleHeld.
+ *
+ * How often each span is due follows the PollPolicy for the controller's
+ * state and mode (setControlState()), and the cycle timer runs at the
+ * fastest span's rate, between 50 ms and 1 s; 100 ms or faster while
+ * setpoints are on their way. Channels the policy reads at different
+ * rates, or only one of them critical, are never in one span: a state
+ * change that regroups them rebuilds the spans.
+ *
+ * Writes queued since the last cycle go out together (the newest value per
+ * channel wins) through ThkaRs485Temp::write_setpoints_celsius(), and are
+ * read back in a later cycle, at least 80 ms on, instead of waiting a
+ * fixed time. A setpoint
+ * that does not read back is sent again, kWriteAttempts times in all;
+ * writeComplete() reports each request once it is confirmed or given up.
+ * A request overtaken by a newer value for its channel counts as completed.
+ *
+ * The transport is connected here, on the worker thread, not by its
+ * owner: start() returns at once whatever the bus is doing. A port that
+ * fails to open or disappears (USB reset) is reopened with a fresh
+ * context, backing off from 0.5 s to 30 s; a device that stops answering
+ * is left to the transport's circuit breaker. Meanwhile frames are still
+ * published (stale, then missing once the breaker opens) and queued
+ * setpoints wait. linkChanged() reports each change, the breaker's too.
+ */
 class ThkaPoller : public QObject {
     Q_OBJECT
 public:
-    explicit ThkaPoller(ThkaRs485Temp* thka, QObject* parent = nullptr);
+    // Each poll is published to `bus` as one SampleFrame (not owned)
+    ThkaPoller(ThkaRs485Temp* thka, SampleBus* bus, QObject* parent = nullptr);
+
+    // Poll duration and write counters go here (not owned). Call before start().
+    void setDiagnostics(Diagnostics* diag) { diag_ = diag; }
+
+    // Filter settings per configured THKA channel, in ThkaConfig order;
+    // without them frames are published raw. Call before start().
+    void setFilters(const std::vector<ChannelFilter>& channels) { filters_.configure(channels); }
+
+    // THKA channel ids control depends on (air zones, IR); their spans are
+    // read every cycle ahead of everything else. Call before start().
+    void setCriticalChannels(const std::vector<int>& channels) { critical_ = channels; }
+
+    // Read rates per channel by controller state; without one every
+    // channel is read at full rate. Call before start().
+    void setPollPolicy(const PollPolicy& policy) { policy_ = policy; }
 
 public slots:
     void start();  // will be called after moveToThread()
     void queueWrite(int channel, double value);  // NEW: Queue a write from GUI thread
+    // The controller's State and OperatingMode (as int, for queued calls):
+    // applies the poll policy from the next cycle on
+    void setControlState(int state, int mode);
+    // Remember every channel's setpoint (a queued value, else what the
+    // device holds), and queue the remembered ones back: around a test
+    // such as the autotune that writes its own
+    void saveSetpoints();
+    void restoreSetpoints();
 
 signals:
-    void polled(const QVariantList& temps);
+    void polled(quint64 seq);  // a new frame is on the SampleBus
     void writeComplete(int channel, bool success);  // NEW: Signal when write finishes
+    // The link came up or went down; detail says why (and when it retries)
+    void linkChanged(bool up, const QString& detail);
 
 private slots:
     void doPoll();
 
 private:
-    void processWrites();  // NEW: Process queued writes
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int kWriteAttempts = 3;
+    static constexpr int kMinIntervalMs = 50;     // fastest cycle ("every cycle")
+    static constexpr int kMaxIntervalMs = 1000;
+    static constexpr int kWriteIntervalMs = 100;  // cycle while writes are pending
+    static constexpr auto kWriteSettle = std::chrono::milliseconds(80);
+    static constexpr double kDeadlineCycles = 3;  // critical deadline, in periods
+    static constexpr double kBudgetShare = 0.8;   // of the cycle, for writes and background
+    static constexpr auto kReconnectMin = std::chrono::milliseconds(500);
+    static constexpr auto kReconnectMax = std::chrono::milliseconds(30000);
+
+    // A setpoint on its way: sent, then confirmed by read-back
+    struct PendingWrite {
+        int channel;
+        double value;
+        std::chrono::steady_clock::time_point queued;
+        int attempts{0};
+        bool sent{false};
+        std::chrono::steady_clock::time_point sent_at{};   // start of the cycle that sent it
+    };
+
+    bool settled(const PendingWrite& w) const { return w.sent && cycleStart_ - w.sent_at >= kWriteSettle; }
+    void configureSpans(); // scheduler reads from the transport's register spans
+    void applyPolicy();    // regroup the spans if state_/mode_ asks, then applyPeriods()
+    void applyPeriods();   // span periods, budget and timer for state_/mode_
+    std::vector<std::vector<int>> spanGroups() const;  // channels that may share a span
+    bool ensureLink();     // connect when due; true if the link is up
+    void setLink(bool up, const QString& detail);
+    void runCycle(Clock::time_point t0);   // one scheduled cycle on a live link
+    void updateTimer();    // the span rate, or the write rate while writes are pending
+
+    void takeWrites();     // move the queue into pending_, coalesced per channel
+    bool sendWrites();     // send what is pending and not on the bus
+    bool verifyWrites();   // read back what an earlier cycle sent and has settled
+    void finishWrite(size_t i, bool success);
 
     ThkaRs485Temp* thka_{nullptr};     // not owned
+    SampleBus* bus_{nullptr};          // not owned
+    Diagnostics* diag_{nullptr};       // not owned
+    SampleFrame frame_;                // reused every poll, no allocation
+    FilterBank filters_;               // applied to frame_ before it is published
+    BusScheduler sched_;               // set up from the register spans on start and connect
+    std::vector<int> critical_;
+    PollPolicy policy_;
+    std::vector<std::vector<int>> spanGroups_;   // as last given to the transport
+    State state_{State::Idle};
+    OperatingMode mode_{OperatingMode::Manual};
+    int spanIntervalMs_{kWriteIntervalMs};   // timer interval the span periods ask for
+    Clock::time_point cycleStart_{};
+
+    // Link state: reconnect attempts back off from kReconnectMin to kReconnectMax
+    bool linkUp_{false};
+    QString linkDetail_;
+    std::chrono::milliseconds backoff_{kReconnectMin};
+    Clock::time_point nextConnect_{};
     QTimer* timer_{nullptr};           // construct in start() (worker thread)
     
     // Thread-safe write queue
     QMutex writeMutex_;
     std::queue<ThkaWriteRequest> writeQueue_;
+
+    // Worker thread only
+    std::vector<PendingWrite> pending_;
+    std::vector<ThkaSetpoint> batch_;   // scratch, reused
+    std::vector<ThkaSetpoint> savedSv_; // saveSetpoints() until restoreSetpoints()
 };
\ No newline at end of file
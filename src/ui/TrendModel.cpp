@@ -0,0 +1,103 @@
+#include "TrendModel.h"
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+TrendModel::TrendModel(size_t channels, size_t capacity, QObject* parent)
+    : QAbstractListModel(parent), history_(channels, capacity) {}
+
+void TrendModel::append(const double* temps, size_t count) {
+    if (count < history_.channels()) return;
+
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    history_.append(now, temps);
+}
+
+int TrendModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return static_cast<int>(rows_.size());
+}
+
+QVariant TrendModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= static_cast<int>(rows_.size()))
+        return {};
+
+    const Row& r = rows_[index.row()];
+    switch (role) {
+        case TimeRole:
+            return r.t_s;
+        case MinRole:
+        case MaxRole: {
+            const auto& src = (role == MinRole) ? r.min : r.max;
+            QVariantList out;
+            out.reserve(static_cast<int>(src.size()));
+            for (float v : src) out.push_back(static_cast<double>(v));
+            return out;
+        }
+        default:
+            return {};
+    }
+}
+
+QHash<int, QByteArray> TrendModel::roleNames() const {
+    return {
+        {TimeRole, "time"},
+        {MinRole,  "minValues"},
+        {MaxRole,  "maxValues"},
+    };
+}
+
+QVariantList TrendModel::query(int channel, double windowSeconds, int pixelWidth) const {
+    QVariantList out;
+    if (channel < 0 || pixelWidth <= 0) return out;
+
+    history_.decimate(static_cast<size_t>(channel), windowSeconds,
+                      static_cast<size_t>(pixelWidth), scratch_);
+
+    out.reserve(static_cast<int>(scratch_.size() * 3));
+    for (const auto& b : scratch_) {
+        out.push_back(b.t_s);
+        out.push_back(static_cast<double>(b.min));
+        out.push_back(static_cast<double>(b.max));
+    }
+    return out;
+}
+
+void TrendModel::refresh() {
+    const size_t buckets  = static_cast<size_t>(std::max(pixelWidth_, 1));
+    const size_t channels = history_.channels();
+    const float  nan      = std::numeric_limits<float>::quiet_NaN();
+    const double width_s  = windowSeconds_ / buckets;
+
+    beginResetModel();
+    rows_.assign(buckets, Row{0.0, std::vector<float>(channels, nan),
+                              std::vector<float>(channels, nan)});
+    for (size_t b = 0; b < buckets; ++b)
+        rows_[b].t_s = -windowSeconds_ + (b + 0.5) * width_s;
+
+    for (size_t c = 0; c < channels; ++c) {
+        history_.decimate(c, windowSeconds_, buckets, scratch_);
+        for (const auto& b : scratch_) {
+            rows_[b.index].min[c] = b.min;
+            rows_[b.index].max[c] = b.max;
+        }
+    }
+    endResetModel();
+
+    emit updated();
+}
+
+void TrendModel::setWindowSeconds(double s) {
+    if (s <= 0 || qFuzzyCompare(windowSeconds_, s)) return;
+    windowSeconds_ = s;
+    emit windowChanged();
+    refresh();
+}
+
+void TrendModel::setPixelWidth(int px) {
+    if (px <= 0 || pixelWidth_ == px) return;
+    pixelWidth_ = px;
+    emit windowChanged();
+    refresh();
+}
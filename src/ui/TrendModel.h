@@ -0,0 +1,65 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QVariant>
+#include <vector>
+#include "data/TrendHistory.h"
+
+/**
+ * QML view of the THKA trend history.
+ *
+ * Rows are min/max buckets over the last windowSeconds, at most pixelWidth
+ * of them, so QML never sees raw 10 Hz history. refresh() recomputes the
+ * rows; OvenBackend calls it about once a second.
+ */
+class TrendModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(double windowSeconds READ windowSeconds WRITE setWindowSeconds NOTIFY windowChanged)
+    Q_PROPERTY(int pixelWidth READ pixelWidth WRITE setPixelWidth NOTIFY windowChanged)
+    Q_PROPERTY(int channelCount READ channelCount CONSTANT)
+
+public:
+    enum Roles {
+        TimeRole = Qt::UserRole + 1,  // seconds relative to now (<= 0)
+        MinRole,                      // QVariantList, one entry per channel (NaN = no data)
+        MaxRole,
+    };
+
+    TrendModel(size_t channels, size_t capacity, QObject* parent = nullptr);
+
+    // Record one poll (values in channel order). Called from the GUI thread.
+    void append(const double* temps, size_t count);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // Level-of-detail query for a chart: flat [t, min, max, t, min, max, ...]
+    // for one channel (0-based), windowSeconds back from now, pixelWidth buckets.
+    Q_INVOKABLE QVariantList query(int channel, double windowSeconds, int pixelWidth) const;
+    Q_INVOKABLE void refresh();
+
+    double windowSeconds() const { return windowSeconds_; }
+    int pixelWidth() const { return pixelWidth_; }
+    int channelCount() const { return static_cast<int>(history_.channels()); }
+
+    void setWindowSeconds(double s);
+    void setPixelWidth(int px);
+
+signals:
+    void windowChanged();
+    void updated();
+
+private:
+    struct Row {
+        double t_s;
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+
+    TrendHistory history_;
+    double windowSeconds_ = 600.0;
+    int pixelWidth_ = 600;
+
+    std::vector<Row> rows_;
+    mutable std::vector<TrendHistory::Bucket> scratch_;
+};
@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/select.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <modbus/modbus.h>
+#include "core/Diagnostics.h"
+#include "hw/impl/SimOven.h"
+#include "hw/impl/ThkaRs485Temp.h"
+
+// THKA emulator: a Modbus RTU slave on a pseudo-terminal, so ThkaRs485Temp,
+// ThkaPoller and the app run end to end without the controller.
+//
+// Two PTY pairs: libmodbus serves the THKA register map on one, the client
+// opens the other (symlinked to --link), and a bridge between the two
+// masters carries the bytes at serial speed: a burst is delivered when its
+// last byte would have arrived at --baud (8N1, 10 bits a character). Faults
+// go in on the bridge: every response waits --latency-ms plus up to
+// --jitter-ms, a --drop fraction of requests never reach the device (the
+// client times out), and a --crc fraction of responses arrive corrupted.
+//
+// Register map as on the real unit: CH1..CH6 measurements at 768..773
+// (0.1 °C, 0x04 and 0x03 unless --fn says otherwise), setpoints at 0..5.
+// Setpoint writes take effect but answer with an exception, which is the
+// quirk ThkaRs485Temp works around (--quirk none for a clean answer,
+// --quirk silent for no answer at all). Without --model every channel
+// reads --temp; with it SimOven supplies CH1..CH5 air and CH6 IR, heating
+// on its own on/off loop around the CH1 setpoint (contactor and fans on)
+// at --speed times real time, and --part-at puts a cold part in.
+//
+// With --bench N, a ThkaRs485Temp on the link polls N frames and writes
+// the six setpoints, then prints the Diagnostics round-trip histograms.
+// A seventh channel shares CH1's register and must read what CH1 reads.
+//
+//   thka_emu [--link PATH] [--baud B] [--slave N] [--latency-ms MS]
+//            [--jitter-ms MS] [--drop P] [--crc P] [--quirk exception|silent|none]
+//            [--fn both|input|holding] [--temp C] [--model] [--speed X]
+//            [--part-at S] [--part-kg KG] [--seed N] [--bench N]
+namespace {
+
+constexpr int kChannels   = 6;
+constexpr int kRegMeas    = 768;
+constexpr int kRegSv      = 0;
+constexpr double kScale   = 0.1;
+
+struct Options {
+  std::string link        = "/tmp/ttyTHKA";
+  int         baud        = 9600;
+  int         slave       = 1;
+  double      latency_ms  = 8.0;     // device turnaround
+  double      jitter_ms   = 4.0;
+  double      drop        = 0.0;     // fraction of requests lost
+  double      crc         = 0.0;     // fraction of responses corrupted
+  std::string quirk       = "exception";
+  std::string fn          = "both";
+  double      temp_c      = 25.0;
+  bool        model       = false;
+  double      speed       = 1.0;
+  double      part_at_s   = -1.0;    // model time; < 0 = never
+  double      part_kg     = 20.0;
+  unsigned    seed        = 1;
+  int         bench       = 0;       // frames polled by the built-in client
+};
+
+std::atomic<bool> g_stop{false};
+
+bool parse(int argc, char* argv[], Options& o) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has = i + 1 < argc;
+    if      (a == "--link"       && has) o.link       = argv[++i];
+    else if (a == "--baud"       && has) o.baud       = std::max(300, std::atoi(argv[++i]));
+    else if (a == "--slave"      && has) o.slave      = std::atoi(argv[++i]);
+    else if (a == "--latency-ms" && has) o.latency_ms = std::max(0.0, std::atof(argv[++i]));
+    else if (a == "--jitter-ms"  && has) o.jitter_ms  = std::max(0.0, std::atof(argv[++i]));
+    else if (a == "--drop"       && has) o.drop       = std::clamp(std::atof(argv[++i]), 0.0, 1.0);
+    else if (a == "--crc"        && has) o.crc        = std::clamp(std::atof(argv[++i]), 0.0, 1.0);
+    else if (a == "--quirk"      && has) o.quirk      = argv[++i];
+    else if (a == "--fn"         && has) o.fn         = argv[++i];
+    else if (a == "--temp"       && has) o.temp_c     = std::atof(argv[++i]);
+    else if (a == "--model")             o.model      = true;
+    else if (a == "--speed"      && has) o.speed      = std::max(0.01, std::atof(argv[++i]));
+    else if (a == "--part-at"    && has) o.part_at_s  = std::atof(argv[++i]);
+    else if (a == "--part-kg"    && has) o.part_kg    = std::atof(argv[++i]);
+    else if (a == "--seed"       && has) o.seed       = static_cast<unsigned>(std::atoi(argv[++i]));
+    else if (a == "--bench"      && has) o.bench      = std::max(0, std::atoi(argv[++i]));
+    else return false;
+  }
+  return (o.quirk == "exception" || o.quirk == "silent" || o.quirk == "none") &&
+         (o.fn == "both" || o.fn == "input" || o.fn == "holding");
+}
+
+// Master side of a new PTY pair in raw mode; slave = its /dev/pts path
+int open_pty(std::string& slave) {
+  const int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) return -1;
+  slave = ptsname(fd);
+  termios t{};
+  tcgetattr(fd, &t);
+  cfmakeraw(&t);
+  tcsetattr(fd, TCSANOW, &t);
+  return fd;
+}
+
+uint16_t to_raw(double c) {
+  return static_cast<uint16_t>(std::clamp(std::lround(c / kScale), 0L, 65535L));
+}
+
+// Counters shared by the bridge and the server, printed on exit
+struct Stats {
+  std::atomic<uint64_t> requests{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<uint64_t> corrupted{0};
+  std::atomic<uint64_t> reads{0};
+  std::atomic<uint64_t> writes{0};
+};
+
+// Bytes between the client's master (bus) and the device's (dev), at
+// serial speed and with the configured faults. A burst is what one read()
+// returns; libmodbus writes each frame in one go.
+void bridge(int bus, int dev, const Options& o, Stats& st) {
+  std::mt19937 rng(o.seed);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  const double char_s = 10.0 / o.baud;
+  uint8_t buf[512];
+
+  auto on_wire = [&](size_t n, double extra_s) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(extra_s + n * char_s));
+  };
+
+  pollfd fds[2] = {{bus, POLLIN, 0}, {dev, POLLIN, 0}};
+  while (!g_stop) {
+    if (poll(fds, 2, 100) <= 0) continue;
+
+    // Client -> device: a request, unless the line drops it
+    if (fds[0].revents & POLLIN) {
+      const ssize_t n = read(bus, buf, sizeof(buf));
+      if (n > 0) {
+        ++st.requests;
+        on_wire(static_cast<size_t>(n), 0.0);
+        if (u(rng) < o.drop) ++st.dropped;
+        else if (write(dev, buf, static_cast<size_t>(n)) < 0) break;
+      }
+    } else if (fds[0].revents & (POLLHUP | POLLERR)) {
+      // No client on the link right now (our own slave fd keeps this rare)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    // Device -> client: turnaround, then the frame, maybe with a bad CRC
+    if (fds[1].revents & POLLIN) {
+      const ssize_t n = read(dev, buf, sizeof(buf));
+      if (n > 0) {
+        on_wire(static_cast<size_t>(n), (o.latency_ms + o.jitter_ms * u(rng)) / 1000.0);
+        if (u(rng) < o.crc) {
+          buf[n - 1] ^= 0x5A;
+          ++st.corrupted;
+        }
+        if (write(bus, buf, static_cast<size_t>(n)) < 0) break;
+      }
+    }
+  }
+}
+
+// The THKA itself: register map, setpoint quirk and the optional model
+class Device {
+public:
+  Device(const Options& o, Stats& st) : o_(o), st_(st), oven_(ovenParams(), o.seed) {
+    oven_.contactor().set(true);
+    oven_.fan().set(true);
+    oven_.fan2().set(true);
+  }
+
+  ~Device() {
+    if (map_) modbus_mapping_free(map_);
+    if (ctx_) {
+      modbus_close(ctx_);
+      modbus_free(ctx_);
+    }
+  }
+
+  bool open(const std::string& pts) {
+    ctx_ = modbus_new_rtu(pts.c_str(), o_.baud, 'N', 8, 1);
+    if (!ctx_ || modbus_set_slave(ctx_, o_.slave) == -1 || modbus_connect(ctx_) == -1) {
+      std::cerr << "thka_emu: " << modbus_strerror(errno) << std::endl;
+      return false;
+    }
+    // Holding 0..773 (setpoints, then the measurements for 0x03), input
+    // 768..773 (measurements for 0x04)
+    map_ = modbus_mapping_new_start_address(0, 0, 0, 0, 0, kRegMeas + kChannels,
+                                            kRegMeas, kChannels);
+    if (!map_) return false;
+    for (int i = 0; i < kChannels; ++i) map_->tab_registers[kRegSv + i] = to_raw(o_.temp_c);
+    publish();
+    return true;
+  }
+
+  void run() {
+    uint8_t query[MODBUS_RTU_MAX_ADU_LENGTH];
+    const int fd = modbus_get_socket(ctx_);
+    const int hl = modbus_get_header_length(ctx_);
+    auto last = std::chrono::steady_clock::now();
+
+    while (!g_stop) {
+      // Wake at least every 50 ms so the model keeps time between requests
+      fd_set rd;
+      FD_ZERO(&rd);
+      FD_SET(fd, &rd);
+      timeval tv{0, 50000};
+      const bool ready = select(fd + 1, &rd, nullptr, nullptr, &tv) > 0;
+
+      const auto now = std::chrono::steady_clock::now();
+      advance(std::chrono::duration<double>(now - last).count() * o_.speed);
+      last = now;
+      if (!ready) continue;
+
+      const int n = modbus_receive(ctx_, query);
+      if (n <= 0) continue;   // bad CRC, another slave, or a timeout mid-frame
+      serve(query, n, hl);
+    }
+  }
+
+private:
+  // CH1..CH5 air, CH6 IR
+  static SimOven::Params ovenParams() {
+    SimOven::Params sp;
+    sp.ir_sensors = 1;
+    return sp;
+  }
+
+  void serve(const uint8_t* q, int n, int hl) {
+    const int fn   = q[hl];
+    const int addr = (q[hl + 1] << 8) | q[hl + 2];
+    const int cnt  = (fn == MODBUS_FC_WRITE_SINGLE_REGISTER) ? 1 : ((q[hl + 3] << 8) | q[hl + 4]);
+    const bool sv  = addr >= kRegSv && addr + cnt <= kRegSv + kChannels;
+
+    switch (fn) {
+      case MODBUS_FC_READ_INPUT_REGISTERS:
+        ++st_.reads;
+        if (o_.fn == "holding") {
+          modbus_reply_exception(ctx_, q, MODBUS_EXCEPTION_ILLEGAL_FUNCTION);
+          return;
+        }
+        break;
+      case MODBUS_FC_READ_HOLDING_REGISTERS:
+        ++st_.reads;
+        if (o_.fn == "input" && !sv) {
+          modbus_reply_exception(ctx_, q, MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS);
+          return;
+        }
+        break;
+      case MODBUS_FC_WRITE_SINGLE_REGISTER:
+      case MODBUS_FC_WRITE_MULTIPLE_REGISTERS:
+        ++st_.writes;
+        if (!sv) {
+          modbus_reply_exception(ctx_, q, MODBUS_EXCEPTION_ILLEGAL_DATA_ADDRESS);
+          return;
+        }
+        if (o_.quirk == "none") break;
+        // The write lands, the answer says it did not
+        if (fn == MODBUS_FC_WRITE_SINGLE_REGISTER) {
+          map_->tab_registers[addr] = static_cast<uint16_t>((q[hl + 3] << 8) | q[hl + 4]);
+        } else {
+          for (int i = 0; i < cnt && hl + 6 + 2 * i + 1 < n; ++i)
+            map_->tab_registers[addr + i] =
+              static_cast<uint16_t>((q[hl + 6 + 2 * i] << 8) | q[hl + 7 + 2 * i]);
+        }
+        apply_setpoint();
+        if (o_.quirk == "exception")
+          modbus_reply_exception(ctx_, q, MODBUS_EXCEPTION_SLAVE_OR_SERVER_FAILURE);
+        return;
+      default:
+        break;
+    }
+    modbus_reply(ctx_, q, n, map_);
+    if (fn == MODBUS_FC_WRITE_SINGLE_REGISTER || fn == MODBUS_FC_WRITE_MULTIPLE_REGISTERS)
+      apply_setpoint();
+  }
+
+  void apply_setpoint() {
+    oven_.set_controller_setpoint(map_->tab_registers[kRegSv] * kScale);
+  }
+
+  void advance(double dt) {
+    if (o_.model && dt > 0) {
+      oven_.advance(dt);
+      if (o_.part_at_s >= 0 && !part_in_ && oven_.time_s() >= o_.part_at_s) {
+        oven_.insert_part(o_.part_kg);
+        part_in_ = true;
+        std::cout << "t=" << oven_.time_s() << "s  " << o_.part_kg << " kg part loaded" << std::endl;
+      }
+    }
+    publish();
+  }
+
+  void publish() {
+    if (o_.model) oven_.fill_frame(frame_);
+    for (int i = 0; i < kChannels; ++i) {
+      const uint16_t raw = to_raw(o_.model ? frame_.value[i] : o_.temp_c);
+      map_->tab_registers[kRegMeas + i] = raw;
+      map_->tab_input_registers[i]      = raw;
+    }
+  }
+
+  const Options&     o_;
+  Stats&             st_;
+  modbus_t*          ctx_{nullptr};
+  modbus_mapping_t*  map_{nullptr};
+  SimOven            oven_;
+  SampleFrame        frame_{};
+  bool               part_in_{false};
+};
+
+// What ThkaPoller does, n times, then every setpoint once
+int bench(const Options& o) {
+  ThkaConfig cfg;
+  cfg.device   = o.link;
+  cfg.baud     = o.baud;
+  cfg.slave_id = o.slave;
+  for (int ch = 1; ch <= kChannels; ++ch)
+    cfg.channels.push_back({ch, static_cast<uint16_t>(kRegMeas + ch - 1),
+                            static_cast<uint16_t>(kRegSv + ch - 1), kScale});
+  cfg.channels.push_back({kChannels + 1, kRegMeas, kRegSv, kScale});   // alias of CH1
+
+  Diagnostics diag;
+  try {
+    ThkaRs485Temp thka(cfg);
+    thka.set_diagnostics(&diag);
+    if (!thka.connect()) {
+      std::cerr << "thka_emu: bench: " << thka.last_error() << std::endl;
+      return 1;
+    }
+
+    SampleFrame frame;
+    int missing = 0, alias_bad = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < o.bench && !g_stop; ++i) {
+      const auto p0 = std::chrono::steady_clock::now();
+      thka.read_frame(frame);
+      diag.poll_duration.record(std::chrono::steady_clock::now() - p0);
+      for (size_t k = 0; k < frame.count; ++k) missing += frame.quality[k] != kSampleOk;
+      alias_bad += frame.quality[kChannels] != frame.quality[0] ||
+                   (frame.quality[0] == kSampleOk && frame.value[kChannels] != frame.value[0]);
+    }
+    const double poll_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    int ok = 0;
+    for (int ch = 1; ch <= kChannels; ++ch) {
+      const auto w0 = std::chrono::steady_clock::now();
+      ok += thka.write_setpoint_celsius(ch, 180.0);
+      diag.write_latency.record(std::chrono::steady_clock::now() - w0);
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << o.bench << " polls in " << poll_s << " s (" << o.bench / poll_s << " Hz), "
+              << missing << " channel readings not fresh, " << ok << "/" << kChannels
+              << " setpoint writes reported ok\n";
+    diag.write(std::cout);
+    if (alias_bad) {
+      std::cerr << "thka_emu: bench: CH" << kChannels + 1 << " (CH1's register) disagreed with CH1 in "
+                << alias_bad << " frames" << std::endl;
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "thka_emu: bench: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options opt;
+  if (!parse(argc, argv, opt)) {
+    std::cerr << "usage: " << argv[0]
+              << " [--link PATH] [--baud B] [--slave N] [--latency-ms MS]"
+                 " [--jitter-ms MS] [--drop P] [--crc P] [--quirk exception|silent|none]"
+                 " [--fn both|input|holding] [--temp C] [--model] [--speed X]"
+                 " [--part-at S] [--part-kg KG] [--seed N] [--bench N]" << std::endl;
+    return 2;
+  }
+  std::signal(SIGINT,  [](int) { g_stop = true; });
+  std::signal(SIGTERM, [](int) { g_stop = true; });
+
+  std::string dev_pts, bus_pts;
+  const int dev = open_pty(dev_pts);
+  const int bus = open_pty(bus_pts);
+  if (dev < 0 || bus < 0) {
+    std::cerr << "thka_emu: no pseudo-terminal: " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+  // Hold the client side open so the bridge never sees a hang-up between
+  // clients
+  const int hold = ::open(bus_pts.c_str(), O_RDWR | O_NOCTTY);
+
+  unlink(opt.link.c_str());
+  if (symlink(bus_pts.c_str(), opt.link.c_str()) != 0) {
+    std::cerr << "thka_emu: cannot link " << opt.link << ": " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+
+  Stats stats;
+  Device device(opt, stats);
+  if (!device.open(dev_pts)) return 1;
+
+  std::cout << "THKA emulator: slave " << opt.slave << " on " << opt.link << " -> " << bus_pts
+            << ", " << opt.baud << " baud, turnaround " << opt.latency_ms << "+" << opt.jitter_ms
+            << " ms, drop " << opt.drop << ", CRC errors " << opt.crc << ", quirk "
+            << opt.quirk << (opt.model ? ", thermal model" : "") << std::endl;
+
+  std::thread link([&] { bridge(bus, dev, opt, stats); });
+  std::thread server([&] { device.run(); });
+
+  int rc = 0;
+  if (opt.bench > 0) {
+    rc = bench(opt);
+    g_stop = true;
+  }
+  link.join();
+  server.join();
+
+  std::cout << stats.requests.load() << " requests (" << stats.reads.load() << " reads, "
+            << stats.writes.load() << " writes), " << stats.dropped.load() << " dropped, "
+            << stats.corrupted.load() << " corrupted" << std::endl;
+  unlink(opt.link.c_str());
+  if (hold >= 0) ::close(hold);
+  ::close(bus);
+  ::close(dev);
+  return rc;
+}